@@ -19,7 +19,7 @@ void full_error_diagnostic(void) {
     
     // 2. Test GPS - SUPPRIMER la variable 'pos' inutilise
     set_gps_position(TEST_LATITUDE, TEST_LONGITUDE, TEST_ALTITUDE);
-    encode_gps_position_complete(current_latitude, current_longitude);
+    encode_gps_position_e7(TEST_LATITUDE_E7, TEST_LONGITUDE_E7);
     
     // 3. Vrification mmoire
     if(sizeof(beacon_frame) != MESSAGE_BITS) {
@@ -0,0 +1,259 @@
+// config_store.c - Persistent Beacon Configuration
+//
+// Two reserved flash pages hold append-only records. Each save writes the
+// next free slot of the active page; when it is full the other page is
+// erased and written from slot 0, so each page is erased once every
+// CONFIG_SLOTS_PER_PAGE saves. At boot both pages are scanned and the valid
+// record with the highest sequence number wins; a record torn by a reset
+// fails its CRC and is skipped (the previous one stays in force).
+
+#include "includes.h"
+#include "config_store.h"
+#include "system_definitions.h"
+#include "system_debug.h"
+#include "system_comms.h"
+#include "protocol_data.h"
+#include "rf_interface.h"
+#include "protocol_layout.h"
+#include "tx_scheduler.h"
+#include "drivers/flash_nvm.h"
+
+// Record layout (16-bit words):
+// [0] magic, [1] version, [2] sequence, [3..] beacon_config_t, then CRC-16,
+// padded to an even count for double-word programming
+#define CONFIG_HEADER_WORDS     3
+#define CONFIG_PAYLOAD_WORDS    ((sizeof(beacon_config_t) + 1) / 2)
+#define CONFIG_CRC_INDEX        (CONFIG_HEADER_WORDS + CONFIG_PAYLOAD_WORDS)
+#define CONFIG_RECORD_WORDS     ((CONFIG_CRC_INDEX + 2) & ~1U)
+#define CONFIG_SLOTS_PER_PAGE   (FLASH_NVM_PAGE_WORDS / CONFIG_RECORD_WORDS)
+#define CONFIG_PAGE_COUNT       2
+
+static const uint16_t __attribute__((space(prog), aligned(FLASH_NVM_PAGE_PC_UNITS), noload))
+    config_page_a[FLASH_NVM_PAGE_WORDS];
+static const uint16_t __attribute__((space(prog), aligned(FLASH_NVM_PAGE_PC_UNITS), noload))
+    config_page_b[FLASH_NVM_PAGE_WORDS];
+
+static beacon_config_t beacon_config;
+static uint8_t config_stored = 0;           // RAM copy came from flash
+static uint16_t config_sequence = 0;        // Sequence of the newest record
+static uint8_t config_active_page = 0;      // Page holding the newest record
+static uint16_t config_next_slot[CONFIG_PAGE_COUNT];   // First erased slot per page
+
+static uint32_t config_page_addr(uint8_t page) {
+    return page ? __builtin_tbladdress(config_page_b) : __builtin_tbladdress(config_page_a);
+}
+
+static uint32_t config_slot_addr(uint8_t page, uint16_t slot) {
+    return config_page_addr(page) + 2UL * CONFIG_RECORD_WORDS * slot;
+}
+
+static uint16_t config_record_crc(const uint16_t *words) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < CONFIG_CRC_INDEX; i++) {
+        crc = flash_nvm_crc16_update(crc, words[i]);
+    }
+    return crc;
+}
+
+// Shortest period the scheduler sends as configured: the T.001 minimum or
+// the duty-cycle pace of the protocol's burst (9920 ms long, 7490 ms short)
+static uint32_t config_min_interval_ms(uint8_t protocol_code) {
+    uint32_t pace_ms = TX_SCHED_MIN_PERIOD_FOR(FRAME_BURST_DURATION_MS(PROTOCOL_FRAME_BITS(protocol_code)));
+    return pace_ms > MIN_TX_INTERVAL_MS ? pace_ms : MIN_TX_INTERVAL_MS;
+}
+
+// Raise both intervals to that floor. Returns 1 if one was below it.
+uint8_t config_raise_intervals(beacon_config_t *cfg) {
+    uint32_t floor_ms = config_min_interval_ms(cfg->protocol_code);
+    uint8_t raised = 0;
+
+    if (cfg->test_interval_ms < floor_ms) {
+        cfg->test_interval_ms = floor_ms;
+        raised = 1;
+    }
+    if (cfg->exercise_interval_ms < floor_ms) {
+        cfg->exercise_interval_ms = floor_ms;
+        raised = 1;
+    }
+    return raised;
+}
+
+// Range checks shared by boot load and runtime edits
+static uint8_t config_is_sane(const beacon_config_t *cfg) {
+    if (cfg->beacon_id > 0xFFFFFFUL) return 0;
+    if (cfg->country_code > 0x3FF) return 0;
+    if (!protocol_layout_find(cfg->protocol_code)) return 0;
+    if (cfg->test_interval_ms < config_min_interval_ms(cfg->protocol_code)) return 0;
+    if (cfg->exercise_interval_ms < config_min_interval_ms(cfg->protocol_code)) return 0;
+    if (cfg->test_lat_udeg < -90000000L || cfg->test_lat_udeg > 90000000L) return 0;
+    if (cfg->test_lon_udeg < -180000000L || cfg->test_lon_udeg > 180000000L) return 0;
+    if (cfg->exercise_power != RF_POWER_LOW && cfg->exercise_power != RF_POWER_HIGH) return 0;
+    if (cfg->log_mode > LOG_MODE_ALL) return 0;
+    return 1;
+}
+
+// Read one slot. Returns 1 and fills cfg/seq if it holds a valid record.
+static uint8_t config_read_slot(uint8_t page, uint16_t slot, beacon_config_t *cfg, uint16_t *seq) {
+    uint32_t addr = config_slot_addr(page, slot);
+    uint16_t words[CONFIG_RECORD_WORDS];
+
+    for (uint8_t i = 0; i < CONFIG_RECORD_WORDS; i++) {
+        words[i] = flash_nvm_read_word(addr + 2UL * i);
+    }
+    if (words[0] != CONFIG_STORE_MAGIC || words[1] != CONFIG_STORE_VERSION) return 0;
+    if (words[CONFIG_CRC_INDEX] != config_record_crc(words)) return 0;
+
+    memcpy(cfg, &words[CONFIG_HEADER_WORDS], sizeof(*cfg));
+    config_raise_intervals(cfg);    // Records from before the duty-cycle floor
+    if (!config_is_sane(cfg)) return 0;
+    *seq = words[2];
+    return 1;
+}
+
+// Scan both pages: newest valid record and first erased slot of each page
+static uint8_t config_scan(void) {
+    beacon_config_t cfg;
+    uint16_t seq;
+    uint8_t found = 0;
+
+    for (uint8_t page = 0; page < CONFIG_PAGE_COUNT; page++) {
+        uint16_t slot;
+        for (slot = 0; slot < CONFIG_SLOTS_PER_PAGE; slot++) {
+            if (flash_nvm_read_word(config_slot_addr(page, slot)) == FLASH_NVM_ERASED_WORD) break;
+            if (!config_read_slot(page, slot, &cfg, &seq)) continue;
+            if (!found || (int16_t)(seq - config_sequence) > 0) {
+                beacon_config = cfg;
+                config_sequence = seq;
+                config_active_page = page;
+                found = 1;
+            }
+        }
+        config_next_slot[page] = slot;
+    }
+    return found;
+}
+
+void config_set_defaults(void) {
+    beacon_config.beacon_id = 0x123456UL;
+    beacon_config.test_interval_ms = 10000;     // Long bursts: not below 9920 ms
+    beacon_config.exercise_interval_ms = 15000;
+    beacon_config.test_lat_udeg = (int32_t)(TEST_LATITUDE * 1000000.0);
+    beacon_config.test_lon_udeg = (int32_t)(TEST_LONGITUDE * 1000000.0);
+    beacon_config.test_alt_m = TEST_ALTITUDE;
+    beacon_config.country_code = COUNTRY_CODE_FRANCE;
+    beacon_config.exercise_power = RF_POWER_HIGH;
+    beacon_config.log_mode = LOG_MODE_NONE;
+    beacon_config.protocol_code = PROTOCOL_ELT_DT;
+}
+
+void config_store_init(void) {
+    config_set_defaults();
+    config_sequence = 0;
+    config_active_page = 0;
+    config_stored = config_scan();
+
+    if (!config_stored) {
+        config_set_defaults();      // A partial scan must not leave mixed fields
+    }
+    debug_flags.log_mode = beacon_config.log_mode;
+
+    DEBUG_LOG_FLUSH(config_stored ? "Config loaded, seq " : "Config: none stored, using defaults\r\n");
+    if (config_stored) {
+        debug_print_uint16(config_sequence);
+        DEBUG_LOG_FLUSH("\r\n");
+    }
+}
+
+const beacon_config_t* config_get(void) {
+    return &beacon_config;
+}
+
+// Replace the RAM copy (not persisted until config_save)
+uint8_t config_set(const beacon_config_t *cfg) {
+    if (!cfg || !config_is_sane(cfg)) return 0;
+    beacon_config = *cfg;
+    return 1;
+}
+
+uint8_t config_is_stored(void) {
+    return config_stored;
+}
+
+// Append the RAM copy as a new record (switches page when the active one is full).
+// Between transmissions only: a page erase stalls the CPU, Timer1 included.
+uint8_t config_save(void) {
+    uint16_t words[CONFIG_RECORD_WORDS];
+    uint8_t page = config_active_page;
+    uint16_t slot = config_next_slot[page];
+    uint16_t seq = config_sequence + 1;
+
+    if (tx_phase != IDLE_STATE) return 0;
+
+    if (slot >= CONFIG_SLOTS_PER_PAGE) {
+        page ^= 1;
+        if (!flash_nvm_erase_page(config_page_addr(page))) return 0;
+        slot = 0;
+    }
+
+    for (uint8_t i = 0; i < CONFIG_RECORD_WORDS; i++) {
+        words[i] = FLASH_NVM_ERASED_WORD;
+    }
+    words[0] = CONFIG_STORE_MAGIC;
+    words[1] = CONFIG_STORE_VERSION;
+    words[2] = seq;
+    memcpy(&words[CONFIG_HEADER_WORDS], &beacon_config, sizeof(beacon_config));
+    words[CONFIG_CRC_INDEX] = config_record_crc(words);
+
+    uint32_t addr = config_slot_addr(page, slot);
+    uint8_t ok = 1;
+    for (uint8_t i = 0; i < CONFIG_RECORD_WORDS && ok; i += 2) {
+        ok = flash_nvm_write_double(addr + 2UL * i, words[i], words[i + 1]);
+    }
+    config_next_slot[page] = slot + 1;     // Slot is used even if the write failed
+
+    beacon_config_t check;
+    uint16_t check_seq;
+    if (!ok || !config_read_slot(page, slot, &check, &check_seq) || check_seq != seq) return 0;
+
+    config_sequence = seq;
+    config_active_page = page;
+    config_stored = 1;
+    return 1;
+}
+
+void config_print(void) {
+    DEBUG_LOG_FLUSH("Config (");
+    DEBUG_LOG_FLUSH(config_stored ? "flash" : "defaults");
+    DEBUG_LOG_FLUSH(", seq ");
+    debug_print_uint16(config_sequence);
+    DEBUG_LOG_FLUSH(", page ");
+    debug_print_uint16(config_active_page);
+    DEBUG_LOG_FLUSH(" slot ");
+    debug_print_uint16(config_next_slot[config_active_page]);
+    DEBUG_LOG_FLUSH("/");
+    debug_print_uint16(CONFIG_SLOTS_PER_PAGE);
+    DEBUG_LOG_FLUSH(")\r\n  ID 0x");
+    debug_print_hex24(beacon_config.beacon_id);
+    DEBUG_LOG_FLUSH(" country ");
+    debug_print_uint16(beacon_config.country_code);
+    DEBUG_LOG_FLUSH(" protocol ");
+    DEBUG_LOG_FLUSH(protocol_layout_find(beacon_config.protocol_code)->name);
+    if (PROTOCOL_IS_SHORT(beacon_config.protocol_code)) DEBUG_LOG_FLUSH(" short");
+    DEBUG_LOG_FLUSH(" 0x");
+    debug_print_hex(beacon_config.protocol_code);
+    DEBUG_LOG_FLUSH("\r\n  interval test ");
+    debug_print_uint32(beacon_config.test_interval_ms);
+    DEBUG_LOG_FLUSH(" ms, exercise ");
+    debug_print_uint32(beacon_config.exercise_interval_ms);
+    DEBUG_LOG_FLUSH(" ms, power ");
+    DEBUG_LOG_FLUSH(beacon_config.exercise_power == RF_POWER_HIGH ? "HIGH" : "LOW");
+    DEBUG_LOG_FLUSH("\r\n  test pos ");
+    debug_print_float(beacon_config.test_lat_udeg / 1000000.0, 6);
+    DEBUG_LOG_FLUSH(", ");
+    debug_print_float(beacon_config.test_lon_udeg / 1000000.0, 6);
+    DEBUG_LOG_FLUSH(", ");
+    debug_print_int32(beacon_config.test_alt_m);
+    DEBUG_LOG_FLUSH(" m, log mode ");
+    debug_print_uint16(beacon_config.log_mode);
+    DEBUG_LOG_FLUSH("\r\n");
+}
@@ -0,0 +1,35 @@
+// config_store.h - Persistent Beacon Configuration (flash, wear-levelled records)
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stdint.h>
+
+#define CONFIG_STORE_MAGIC      0xC0F5
+#define CONFIG_STORE_VERSION    2          // Bump when beacon_config_t changes
+
+// Loaded once at boot; consumers read the RAM copy only (no flash on hot paths)
+typedef struct {
+    uint32_t beacon_id;             // 24-bit beacon identification
+    uint32_t test_interval_ms;      // Repetition period, TEST frames
+    uint32_t exercise_interval_ms;  // Repetition period, EXERCISE frames
+    int32_t test_lat_udeg;          // TEST frame position (micro-degrees)
+    int32_t test_lon_udeg;
+    int16_t test_alt_m;             // TEST frame altitude (m)
+    uint16_t country_code;          // 10-bit MID
+    uint8_t exercise_power;         // RF_POWER_LOW / RF_POWER_HIGH for EXERCISE frames
+    uint8_t log_mode;               // log_mode_t applied at boot
+    uint8_t protocol_code;          // Location protocol (protocol_layout.h)
+} beacon_config_t;
+
+// Function prototypes
+void config_store_init(void);
+const beacon_config_t* config_get(void);
+uint8_t config_set(const beacon_config_t *cfg);
+uint8_t config_raise_intervals(beacon_config_t *cfg);
+void config_set_defaults(void);
+uint8_t config_save(void);
+uint8_t config_is_stored(void);
+void config_print(void);
+
+#endif /* CONFIG_STORE_H */
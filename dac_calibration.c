@@ -0,0 +1,232 @@
+// dac_calibration.c - Internal DAC Output Calibration
+//
+// The measured code -> mV curve is kept in a reserved flash page and only
+// used when the modulation tables are built (signal_processor_init), so the
+// Timer1 ISR keeps reading precomputed codes.
+
+#include "includes.h"
+#include "dac_calibration.h"
+#include "system_comms.h"
+#include "system_debug.h"
+#include "signal_processor.h"
+#include "drivers/flash_nvm.h"
+
+// Flash page layout (16-bit words):
+// [0] magic, [1] version, [2] point count, [3..] code/mV pairs, then CRC-16
+#define DAC_CAL_HEADER_WORDS    3
+#define DAC_CAL_RECORD_WORDS    (DAC_CAL_HEADER_WORDS + 2 * DAC_CAL_POINTS + 1)
+
+static const uint16_t __attribute__((space(prog), aligned(FLASH_NVM_PAGE_PC_UNITS), noload))
+    dac_cal_page[FLASH_NVM_PAGE_WORDS];
+
+static dac_cal_point_t dac_cal_table[DAC_CAL_POINTS];
+static uint8_t dac_cal_valid = 0;
+
+// Sweep state
+static dac_cal_point_t dac_cal_sweep[DAC_CAL_POINTS];
+static volatile uint8_t dac_cal_sweep_index = 0;
+static volatile uint8_t dac_cal_sweeping = 0;
+
+static uint32_t dac_cal_page_addr(void) {
+    return __builtin_tbladdress(dac_cal_page);
+}
+
+static uint16_t dac_cal_point_code(uint8_t index) {
+    uint32_t code = ((uint32_t)(DAC_RESOLUTION - 1) * index) / (DAC_CAL_POINTS - 1);
+    return (uint16_t)code;
+}
+
+// Codes must rise and stay within the DAC, measured mV must not fall and
+// stay within the reference. Flat runs (output clipping at the rails) are
+// accepted; a completely flat curve cannot be inverted.
+static uint8_t dac_cal_table_ok(const dac_cal_point_t *points) {
+    for (uint8_t i = 0; i < DAC_CAL_POINTS; i++) {
+        if (points[i].code >= DAC_RESOLUTION) return 0;
+        if (points[i].mv > (uint16_t)(VOLTAGE_REF_3V3 * 1000.0f)) return 0;
+        if (i == 0) continue;
+        if (points[i].code <= points[i - 1].code) return 0;
+        if (points[i].mv < points[i - 1].mv) return 0;
+    }
+    return points[DAC_CAL_POINTS - 1].mv > points[0].mv;
+}
+
+static uint8_t dac_cal_load(void) {
+    uint32_t addr = dac_cal_page_addr();
+    uint16_t words[DAC_CAL_RECORD_WORDS];
+    uint16_t crc = 0xFFFF;
+
+    for (uint8_t i = 0; i < DAC_CAL_RECORD_WORDS; i++) {
+        words[i] = flash_nvm_read_word(addr + 2UL * i);
+        if (i < DAC_CAL_RECORD_WORDS - 1) crc = flash_nvm_crc16_update(crc, words[i]);
+    }
+    if (words[0] != DAC_CAL_MAGIC || words[1] != DAC_CAL_VERSION ||
+        words[2] != DAC_CAL_POINTS || words[DAC_CAL_RECORD_WORDS - 1] != crc) {
+        return 0;
+    }
+
+    dac_cal_point_t points[DAC_CAL_POINTS];
+    for (uint8_t i = 0; i < DAC_CAL_POINTS; i++) {
+        points[i].code = words[DAC_CAL_HEADER_WORDS + 2 * i];
+        points[i].mv = words[DAC_CAL_HEADER_WORDS + 2 * i + 1];
+    }
+    if (!dac_cal_table_ok(points)) return 0;
+
+    memcpy(dac_cal_table, points, sizeof(dac_cal_table));
+    return 1;
+}
+
+static uint8_t dac_cal_save(const dac_cal_point_t *points) {
+    uint32_t addr = dac_cal_page_addr();
+    uint16_t words[DAC_CAL_RECORD_WORDS + 1];       // Padded to an even count
+    uint16_t crc = 0xFFFF;
+
+    words[0] = DAC_CAL_MAGIC;
+    words[1] = DAC_CAL_VERSION;
+    words[2] = DAC_CAL_POINTS;
+    for (uint8_t i = 0; i < DAC_CAL_POINTS; i++) {
+        words[DAC_CAL_HEADER_WORDS + 2 * i] = points[i].code;
+        words[DAC_CAL_HEADER_WORDS + 2 * i + 1] = points[i].mv;
+    }
+    for (uint8_t i = 0; i < DAC_CAL_RECORD_WORDS - 1; i++) {
+        crc = flash_nvm_crc16_update(crc, words[i]);
+    }
+    words[DAC_CAL_RECORD_WORDS - 1] = crc;
+    words[DAC_CAL_RECORD_WORDS] = FLASH_NVM_ERASED_WORD;
+
+    if (!flash_nvm_erase_page(addr)) return 0;
+    for (uint8_t i = 0; i < DAC_CAL_RECORD_WORDS; i += 2) {
+        if (!flash_nvm_write_double(addr + 2UL * i, words[i], words[i + 1])) return 0;
+    }
+    return 1;
+}
+
+void dac_cal_init(void) {
+    dac_cal_valid = dac_cal_load();
+    DEBUG_LOG_FLUSH(dac_cal_valid ? "DAC calibration loaded\r\n"
+                                  : "DAC calibration: none, using ideal mapping\r\n");
+}
+
+uint8_t dac_cal_is_valid(void) {
+    return dac_cal_valid;
+}
+
+// Code giving the requested output level (V): piecewise-linear inverse of
+// the measured curve, or the ideal VOLTAGE_REF_3V3 mapping when uncalibrated.
+// A level on a flat run maps to the highest code of the run. Called only
+// while building tables.
+uint16_t dac_cal_voltage_to_code(float voltage) {
+    if (!dac_cal_valid) {
+        if (voltage <= 0.0f) return 0;
+        float code = (voltage * DAC_RESOLUTION) / VOLTAGE_REF_3V3;
+        return (code >= DAC_RESOLUTION - 1) ? (DAC_RESOLUTION - 1) : (uint16_t)code;
+    }
+
+    float mv = voltage * 1000.0f;
+    for (uint8_t i = 0; i < DAC_CAL_POINTS; i++) {
+        if (mv > dac_cal_table[i].mv) continue;
+        if (i > 0 && mv < dac_cal_table[i].mv) {
+            // Strictly inside a rising segment: span_mv > 0
+            float span_mv = (float)(dac_cal_table[i].mv - dac_cal_table[i - 1].mv);
+            float span_code = (float)(dac_cal_table[i].code - dac_cal_table[i - 1].code);
+            float code = dac_cal_table[i - 1].code + (mv - dac_cal_table[i - 1].mv) * span_code / span_mv;
+            return (uint16_t)(code + 0.5f);
+        }
+        // On (or below) a measured point: upper end of its flat run
+        while (i + 1 < DAC_CAL_POINTS && dac_cal_table[i + 1].mv == dac_cal_table[i].mv) i++;
+        return dac_cal_table[i].code;
+    }
+    return dac_cal_table[DAC_CAL_POINTS - 1].code;
+}
+
+// =============================
+// Calibration Sweep
+// =============================
+// DAC1 holds each sweep code (the Timer1 idle path outputs it) until the
+// measured value is entered with dac_cal_sweep_record().
+
+static void dac_cal_sweep_prompt(void) {
+    DEBUG_LOG_FLUSH("CAL point ");
+    debug_print_uint16(dac_cal_sweep_index + 1);
+    DEBUG_LOG_FLUSH("/");
+    debug_print_uint16(DAC_CAL_POINTS);
+    DEBUG_LOG_FLUSH(": code ");
+    debug_print_uint16(dac_cal_sweep_code());
+    DEBUG_LOG_FLUSH(" - measure, then enter CAL <mV>\r\n");
+}
+
+uint8_t dac_cal_sweep_start(void) {
+    if (tx_phase != IDLE_STATE) return 0;
+    if (signal_processor_get_mode() != MOD_MODE_INTERNAL_DAC) return 0;
+
+    dac_cal_sweep_index = 0;
+    dac_cal_sweeping = 1;
+    dac_cal_sweep_prompt();
+    return 1;
+}
+
+uint8_t dac_cal_sweep_active(void) {
+    return dac_cal_sweeping;
+}
+
+uint16_t dac_cal_sweep_code(void) {
+    return dac_cal_point_code(dac_cal_sweep_index);
+}
+
+// Record the measured output for the current code. After the last point the
+// table is checked, written to flash and the modulation tables are rebuilt.
+uint8_t dac_cal_sweep_record(uint16_t mv) {
+    if (!dac_cal_sweeping) return 0;
+
+    dac_cal_sweep[dac_cal_sweep_index].code = dac_cal_sweep_code();
+    dac_cal_sweep[dac_cal_sweep_index].mv = mv;
+
+    if (++dac_cal_sweep_index < DAC_CAL_POINTS) {
+        dac_cal_sweep_prompt();
+        return 1;
+    }
+
+    dac_cal_sweeping = 0;
+    if (!dac_cal_table_ok(dac_cal_sweep)) {
+        DEBUG_LOG_FLUSH("CAL failed: output falling or out of range\r\n");
+        return 0;
+    }
+    if (!dac_cal_save(dac_cal_sweep)) {
+        DEBUG_LOG_FLUSH("CAL failed: flash write error\r\n");
+        return 0;
+    }
+
+    memcpy(dac_cal_table, dac_cal_sweep, sizeof(dac_cal_table));
+    dac_cal_valid = 1;
+    signal_processor_init();
+    DEBUG_LOG_FLUSH("CAL saved, modulation tables rebuilt\r\n");
+    return 1;
+}
+
+void dac_cal_sweep_abort(void) {
+    dac_cal_sweeping = 0;
+}
+
+// Back to the ideal mapping (erases the stored table)
+uint8_t dac_cal_clear(void) {
+    if (tx_phase != IDLE_STATE) return 0;
+
+    dac_cal_sweeping = 0;
+    dac_cal_valid = 0;
+    if (!flash_nvm_erase_page(dac_cal_page_addr())) return 0;
+    signal_processor_init();
+    return 1;
+}
+
+void dac_cal_print(void) {
+    DEBUG_LOG_FLUSH(dac_cal_valid ? "DAC calibration (code -> mV):\r\n"
+                                  : "DAC calibration: none (ideal mapping)\r\n");
+    if (!dac_cal_valid) return;
+
+    for (uint8_t i = 0; i < DAC_CAL_POINTS; i++) {
+        DEBUG_LOG_FLUSH("  ");
+        debug_print_uint16(dac_cal_table[i].code);
+        DEBUG_LOG_FLUSH(" -> ");
+        debug_print_uint16(dac_cal_table[i].mv);
+        DEBUG_LOG_FLUSH(" mV\r\n");
+    }
+}
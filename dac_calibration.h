@@ -0,0 +1,33 @@
+// dac_calibration.h - Internal DAC Output Calibration (code -> measured mV)
+
+#ifndef DAC_CALIBRATION_H
+#define DAC_CALIBRATION_H
+
+#include <stdint.h>
+
+// Sweep: DAC_CAL_POINTS codes from 0 to full scale, each measured by hand
+// at the Bessel filter output (DC, before the 47 uF coupling capacitor)
+#define DAC_CAL_POINTS          9
+#define DAC_CAL_MAGIC           0xCA1B
+#define DAC_CAL_VERSION         1
+
+typedef struct {
+    uint16_t code;              // DAC1 code
+    uint16_t mv;                // Measured output (mV)
+} dac_cal_point_t;
+
+// Function prototypes
+void dac_cal_init(void);
+uint8_t dac_cal_is_valid(void);
+uint16_t dac_cal_voltage_to_code(float voltage);
+
+// Calibration sweep (UART driven, only between transmissions)
+uint8_t dac_cal_sweep_start(void);
+uint8_t dac_cal_sweep_record(uint16_t mv);
+void dac_cal_sweep_abort(void);
+uint8_t dac_cal_sweep_active(void);
+uint16_t dac_cal_sweep_code(void);
+uint8_t dac_cal_clear(void);
+void dac_cal_print(void);
+
+#endif /* DAC_CALIBRATION_H */
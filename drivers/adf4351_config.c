@@ -0,0 +1,152 @@
+// adf4351_config.c - ADF4351 Register Computation Engine Implementation
+
+#include "../includes.h"
+#include "adf4351_config.h"
+#include "../system_debug.h"
+
+// Channel frequencies (Hz), indexed by adf4351_channel_t
+static const uint32_t adf4351_channel_freq_hz[ADF4351_CHANNEL_COUNT] = {
+    403040000UL,    // 403.040 MHz test channel
+    406025000UL,    // T.001 channel B
+    406028000UL,    // T.001 channel C
+    406031000UL,    // T.001 channel D
+    406037000UL,    // T.001 channel F
+    406040000UL     // T.001 channel G
+};
+
+// Per-channel cache, filled once by adf4351_config_init()
+static adf4351_config_t adf4351_channel_cache[ADF4351_CHANNEL_COUNT];
+
+static uint32_t adf4351_gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Build R0..R5 from the computed divider values
+static void adf4351_encode_registers(adf4351_config_t *cfg) {
+    uint32_t r2 = ((uint32_t)ADF4351_R2_MUXOUT_DLD << 26) |
+                  ((uint32_t)cfg->r_counter << 14) |
+                  ((uint32_t)ADF4351_R2_CP_CURRENT << 9) |
+                  ADF4351_R2_DOUBLE_BUF_BIT |
+                  (1UL << 6) |                          // PD polarity positive
+                  0x2;
+    if (cfg->frac == 0) {
+        r2 |= (1UL << 8);                               // LDF = INT-N lock detect
+    }
+
+    cfg->regs[ADF4351_IDX_R5] = ADF4351_R5_VALUE;
+    cfg->regs[ADF4351_IDX_R4] = (1UL << 23) |           // Feedback from VCO fundamental
+                                ((uint32_t)cfg->rf_div_sel << 20) |
+                                ((uint32_t)cfg->band_sel_div << 12) |
+                                (1UL << 5) |            // RF output enable
+                                ((uint32_t)ADF4351_R4_OUT_POWER << 3) |
+                                0x4;
+    cfg->regs[ADF4351_IDX_R3] = ((uint32_t)ADF4351_R3_CLK_DIV << 3) | 0x3;
+    cfg->regs[ADF4351_IDX_R2] = r2;
+    cfg->regs[ADF4351_IDX_R1] = ((uint32_t)cfg->prescaler_8_9 << 27) |
+                                ((uint32_t)ADF4351_R1_PHASE << 15) |
+                                ((uint32_t)cfg->mod << 3) |
+                                0x1;
+    cfg->regs[ADF4351_IDX_R0] = ((uint32_t)cfg->int_value << 15) |
+                                ((uint32_t)cfg->frac << 3);
+}
+
+// RFout = fPFD x (INT + FRAC/MOD) / RF divider, fPFD = REFin / R
+// Returns 1 on success, 0 if the target cannot be synthesized exactly
+uint8_t adf4351_compute_config(uint32_t ref_hz, uint32_t rf_out_hz,
+                               uint32_t resolution_hz, adf4351_config_t *cfg) {
+    if (!cfg) return 0;
+    memset(cfg, 0, sizeof(*cfg));
+    if (ref_hz == 0 || rf_out_hz == 0 || resolution_hz == 0) return 0;
+
+    // Output divider: smallest power of two that puts the VCO in range
+    uint8_t div_sel = 0;
+    uint64_t vco_hz = rf_out_hz;
+    while (vco_hz < ADF4351_VCO_MIN_HZ && div_sel < 6) {
+        div_sel++;
+        vco_hz <<= 1;
+    }
+    if (vco_hz < ADF4351_VCO_MIN_HZ || vco_hz > ADF4351_VCO_MAX_HZ) return 0;
+
+    // R counter: keep the PFD under the fractional-N limit
+    uint32_t r_counter = (ref_hz + ADF4351_PFD_MAX_FRAC_HZ - 1) / ADF4351_PFD_MAX_FRAC_HZ;
+    if (r_counter == 0) r_counter = 1;
+    if (r_counter > ADF4351_R_MAX) return 0;
+    uint32_t pfd_hz = ref_hz / r_counter;
+
+    // MOD from the resolution seen at the VCO, then reduce FRAC/MOD
+    uint32_t vco_step_hz = resolution_hz << div_sel;
+    if (pfd_hz % vco_step_hz) return 0;
+    uint32_t mod = pfd_hz / vco_step_hz;
+    uint32_t int_value = (uint32_t)(vco_hz / pfd_hz);
+    uint32_t frac = ((uint32_t)(vco_hz % pfd_hz) + vco_step_hz / 2) / vco_step_hz;
+    if (frac >= mod) {
+        frac -= mod;
+        int_value++;
+    }
+
+    if (frac == 0) {
+        mod = 2;
+    } else {
+        uint32_t g = adf4351_gcd(frac, mod);
+        frac /= g;
+        mod /= g;
+    }
+    if (mod < 2 || mod > ADF4351_MOD_MAX) return 0;
+
+    // Prescaler: 8/9 whenever INT allows it (required above 3.6 GHz)
+    uint8_t prescaler_8_9;
+    if (int_value >= ADF4351_INT_MIN_PRESC_8_9) {
+        prescaler_8_9 = 1;
+    } else if (int_value >= ADF4351_INT_MIN_PRESC_4_5 && vco_hz <= 3600000000ULL) {
+        prescaler_8_9 = 0;
+    } else {
+        return 0;
+    }
+    if (int_value > ADF4351_INT_MAX) return 0;
+
+    // Band select clock must not exceed 125 kHz
+    uint32_t band_sel_div = (pfd_hz + ADF4351_BAND_SEL_MAX_HZ - 1) / ADF4351_BAND_SEL_MAX_HZ;
+    if (band_sel_div < 1) band_sel_div = 1;
+    if (band_sel_div > 255) band_sel_div = 255;
+
+    cfg->rf_out_hz = rf_out_hz;
+    cfg->pfd_hz = pfd_hz;
+    cfg->int_value = (uint16_t)int_value;
+    cfg->frac = (uint16_t)frac;
+    cfg->mod = (uint16_t)mod;
+    cfg->r_counter = (uint16_t)r_counter;
+    cfg->band_sel_div = (uint8_t)band_sel_div;
+    cfg->rf_div_sel = div_sel;
+    cfg->prescaler_8_9 = prescaler_8_9;
+    cfg->valid = 1;
+    adf4351_encode_registers(cfg);
+
+    return 1;
+}
+
+void adf4351_config_init(uint32_t ref_hz) {
+    for (uint8_t ch = 0; ch < ADF4351_CHANNEL_COUNT; ch++) {
+        if (!adf4351_compute_config(ref_hz, adf4351_channel_freq_hz[ch],
+                                    ADF4351_CHANNEL_RES_HZ, &adf4351_channel_cache[ch])) {
+            DEBUG_LOG_FLUSH("ADF4351: channel config failed for ");
+            debug_print_uint32(adf4351_channel_freq_hz[ch]);
+            DEBUG_LOG_FLUSH(" Hz\r\n");
+        }
+    }
+}
+
+const adf4351_config_t* adf4351_get_channel_config(adf4351_channel_t channel) {
+    if (channel >= ADF4351_CHANNEL_COUNT) return 0;
+    if (!adf4351_channel_cache[channel].valid) return 0;
+    return &adf4351_channel_cache[channel];
+}
+
+uint32_t adf4351_get_channel_freq_hz(adf4351_channel_t channel) {
+    if (channel >= ADF4351_CHANNEL_COUNT) return 0;
+    return adf4351_channel_freq_hz[channel];
+}
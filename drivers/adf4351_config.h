@@ -0,0 +1,78 @@
+// adf4351_config.h - ADF4351 Register Computation Engine (INT/FRAC/MOD, R, dividers)
+
+#ifndef ADF4351_CONFIG_H
+#define ADF4351_CONFIG_H
+
+#include <stdint.h>
+
+// Reference and synthesizer limits (ADF4351 datasheet Rev. A)
+#define ADF4351_REF_FREQ_HZ         25000000UL  // 25 MHz TCXO on REFin
+#define ADF4351_CHANNEL_RES_HZ      1000UL      // 1 kHz resolution at RF output
+#define ADF4351_PFD_MAX_FRAC_HZ     32000000UL  // 32 MHz max PFD in fractional-N mode
+#define ADF4351_VCO_MIN_HZ          2200000000ULL
+#define ADF4351_VCO_MAX_HZ          4400000000ULL
+#define ADF4351_BAND_SEL_MAX_HZ     125000UL    // Band select logic clock limit
+#define ADF4351_MOD_MAX             4095
+#define ADF4351_R_MAX               1023
+#define ADF4351_INT_MIN_PRESC_4_5   23          // Minimum INT with 4/5 prescaler
+#define ADF4351_INT_MIN_PRESC_8_9   75          // Minimum INT with 8/9 prescaler
+#define ADF4351_INT_MAX             65535
+
+// Fixed register settings shared by every channel
+#define ADF4351_R1_PHASE            1           // Recommended phase value
+#define ADF4351_R2_MUXOUT_DLD       6           // MUXOUT = digital lock detect
+#define ADF4351_R2_CP_CURRENT       7           // 2.50 mA charge pump
+#define ADF4351_R3_CLK_DIV          150         // 12-bit clock divider value
+#define ADF4351_R4_OUT_POWER        3           // +5 dBm output power
+#define ADF4351_R5_VALUE            0x00580005  // Digital lock detect on LD pin
+
+// Register write order: R5 first, R0 last (R0 triggers VCO band selection)
+#define ADF4351_REG_COUNT           6
+#define ADF4351_IDX_R5              0
+#define ADF4351_IDX_R4              1
+#define ADF4351_IDX_R3              2
+#define ADF4351_IDX_R2              3
+#define ADF4351_IDX_R1              4
+#define ADF4351_IDX_R0              5
+#define ADF4351_REG_INDEX(n)        (ADF4351_IDX_R0 - (n))  // Rn -> write order index
+
+// Bits that can change without retuning (no R0 write / band selection needed)
+#define ADF4351_R2_PD_BIT           (1UL << 5)  // Power-down
+#define ADF4351_R2_DOUBLE_BUF_BIT   (1UL << 13) // Double buffer R4 DB22:20 until R0
+#define ADF4351_R2_RUNTIME_MASK     0x00000038UL // PD, CP three-state, counter reset
+#define ADF4351_R4_RUNTIME_MASK     0x000003F8UL // AUX/RF output enable and power
+
+// Channel table: 403 MHz test channel plus T.001 406 MHz channels
+typedef enum {
+    ADF4351_CH_403_040_TEST,
+    ADF4351_CH_406_025,
+    ADF4351_CH_406_028,
+    ADF4351_CH_406_031,
+    ADF4351_CH_406_037,
+    ADF4351_CH_406_040,
+    ADF4351_CHANNEL_COUNT
+} adf4351_channel_t;
+
+// Computed synthesizer settings and resulting register words
+typedef struct {
+    uint32_t rf_out_hz;         // Requested output frequency
+    uint32_t pfd_hz;            // Phase detector frequency
+    uint16_t int_value;         // 16-bit integer divide value
+    uint16_t frac;              // 12-bit fractional value
+    uint16_t mod;               // 12-bit modulus
+    uint16_t r_counter;         // 10-bit reference divider
+    uint8_t band_sel_div;       // 8-bit band select clock divider
+    uint8_t rf_div_sel;         // RF divider select (output divider = 1 << rf_div_sel)
+    uint8_t prescaler_8_9;      // 1 = 8/9 prescaler, 0 = 4/5
+    uint8_t valid;              // 1 if the entry holds a usable configuration
+    uint32_t regs[ADF4351_REG_COUNT]; // R5..R0 in write order
+} adf4351_config_t;
+
+// Function prototypes
+uint8_t adf4351_compute_config(uint32_t ref_hz, uint32_t rf_out_hz,
+                               uint32_t resolution_hz, adf4351_config_t *cfg);
+void adf4351_config_init(uint32_t ref_hz);
+const adf4351_config_t* adf4351_get_channel_config(adf4351_channel_t channel);
+uint32_t adf4351_get_channel_freq_hz(adf4351_channel_t channel);
+
+#endif /* ADF4351_CONFIG_H */
@@ -0,0 +1,161 @@
+// adf4351_spi.c - Interrupt-Driven SPI1 Transfer Queue Implementation
+//
+// SPI1 runs in 32-bit word mode, MSB first, so one ADF4351 register is a
+// single SPI word. LE (RC3) is mapped to SS1 with MSSEN: the module drives it
+// low for the duration of the word and releases it high afterwards, which
+// latches the register without any software delay. Completion is signalled
+// by the SPI1 RX interrupt (one word received = 32 clocks shifted out).
+
+#include "../includes.h"
+#include "adf4351_spi.h"
+
+// Baud Rate = FP / (2 * (SPIxBRG + 1)), FP = FCY; round up to stay <= 20 MHz
+#define ADF4351_SPI_BRG ((FCY + (2 * ADF4351_SPI_MAX_HZ) - 1) / (2 * ADF4351_SPI_MAX_HZ) - 1)
+
+#define ADF4351_SPI_QUEUE_MASK (ADF4351_SPI_QUEUE_SIZE - 1)
+
+typedef struct {
+    uint32_t reg_data;
+    adf4351_spi_callback_t callback;
+} adf4351_spi_job_t;
+
+static volatile adf4351_spi_job_t adf4351_spi_queue[ADF4351_SPI_QUEUE_SIZE];
+static volatile uint8_t adf4351_spi_head = 0;     // Next free slot
+static volatile uint8_t adf4351_spi_tail = 0;     // Job on the wire (if active)
+static volatile uint8_t adf4351_spi_active = 0;   // 1 while a word is shifting
+
+// Critical section that preserves the caller's interrupt state
+// (callers include the Timer1 ISR and sections already running with GIE = 0)
+static uint8_t adf4351_spi_lock(void) {
+    uint8_t gie = INTCON2bits.GIE;
+    __builtin_disable_interrupts();
+    return gie;
+}
+
+static void adf4351_spi_unlock(uint8_t gie) {
+    if (gie) {
+        __builtin_enable_interrupts();
+    }
+}
+
+// Load the job at tail into the 32-bit TX buffer (lock held)
+static void adf4351_spi_start_next(void) {
+    if (adf4351_spi_tail == adf4351_spi_head) {
+        adf4351_spi_active = 0;
+        return;
+    }
+    uint32_t reg_data = adf4351_spi_queue[adf4351_spi_tail].reg_data;
+    adf4351_spi_active = 1;
+    SPI1BUFL = (uint16_t)(reg_data & 0xFFFF);
+    SPI1BUFH = (uint16_t)(reg_data >> 16);   // Upper half completes the 32-bit word
+}
+
+// Retire the completed word and start the next one
+static void adf4351_spi_service(void) {
+    adf4351_spi_callback_t callback = 0;
+    uint32_t reg_data = 0;
+
+    uint8_t gie = adf4351_spi_lock();
+    if (adf4351_spi_active && !SPI1STATLbits.SPIRBE) {
+        (void)SPI1BUFL;                     // Drain RX word (ADF4351 has no readback)
+        (void)SPI1BUFH;
+        callback = adf4351_spi_queue[adf4351_spi_tail].callback;
+        reg_data = adf4351_spi_queue[adf4351_spi_tail].reg_data;
+        adf4351_spi_tail = (adf4351_spi_tail + 1) & ADF4351_SPI_QUEUE_MASK;
+        adf4351_spi_start_next();
+    }
+    IFS0bits.SPI1RXIF = 0;
+    adf4351_spi_unlock(gie);
+
+    if (callback) {
+        callback(reg_data);
+    }
+}
+
+void adf4351_spi_init(void) {
+    IEC0bits.SPI1RXIE = 0;
+    SPI1CON1Lbits.SPIEN = 0;
+
+    SPI1CON1L = 0x0000;
+    SPI1CON1Lbits.MSTEN = 1;    // Host mode
+    SPI1CON1Lbits.MODE32 = 1;   // 32-bit words: one word per ADF4351 register
+    SPI1CON1Lbits.CKE = 1;      // CPHA=0: data valid on rising edge
+    SPI1CON1Lbits.CKP = 0;      // CPOL=0
+    SPI1CON1Lbits.DISSDI = 1;   // No MISO (ADF4351 is write-only)
+    SPI1CON1H = 0x0000;
+    SPI1CON1Hbits.MSSEN = 1;    // SS1 = LE, driven automatically per word
+    SPI1CON1Hbits.FRMPOL = 0;   // Active-low select: rising edge latches
+    SPI1CON2L = 0x0000;         // Word length from MODE32
+    SPI1BRGL = ADF4351_SPI_BRG; // 12.5 MHz at FCY = 50 MHz
+    SPI1STATLbits.SPIROV = 0;
+
+    // Interrupt on RX buffer full = word complete
+    SPI1IMSKL = 0x0000;
+    SPI1IMSKLbits.SPIRBFEN = 1;
+    IPC2bits.SPI1RXIP = ADF4351_SPI_IRQ_PRIO;
+    IFS0bits.SPI1RXIF = 0;
+
+    adf4351_spi_head = 0;
+    adf4351_spi_tail = 0;
+    adf4351_spi_active = 0;
+
+    SPI1CON1Lbits.SPIEN = 1;
+    IEC0bits.SPI1RXIE = 1;
+}
+
+// Queue a 32-bit register write and return immediately.
+// Returns 1 if queued without waiting, 0 if the queue was full and had to drain first.
+uint8_t adf4351_spi_enqueue(uint32_t reg_data, adf4351_spi_callback_t callback) {
+    uint8_t waited = 0;
+
+    while (1) {
+        uint8_t gie = adf4351_spi_lock();
+        uint8_t next_head = (adf4351_spi_head + 1) & ADF4351_SPI_QUEUE_MASK;
+        if (next_head != adf4351_spi_tail) {
+            adf4351_spi_queue[adf4351_spi_head].reg_data = reg_data;
+            adf4351_spi_queue[adf4351_spi_head].callback = callback;
+            adf4351_spi_head = next_head;
+            if (!adf4351_spi_active) {
+                adf4351_spi_start_next();
+            }
+            adf4351_spi_unlock(gie);
+            return !waited;
+        }
+        adf4351_spi_unlock(gie);
+
+        // Queue full: retire words by polling (works even with interrupts masked)
+        waited = 1;
+        IEC0bits.SPI1RXIE = 0;
+        if (!SPI1STATLbits.SPIRBE) {
+            adf4351_spi_service();
+        }
+        IEC0bits.SPI1RXIE = 1;
+    }
+}
+
+// Block until every queued write has been latched.
+// Polls the hardware so it also works with interrupts disabled.
+void adf4351_spi_flush(void) {
+    while (adf4351_spi_busy()) {
+        IEC0bits.SPI1RXIE = 0;
+        if (!SPI1STATLbits.SPIRBE) {
+            adf4351_spi_service();
+        }
+        IEC0bits.SPI1RXIE = 1;
+    }
+}
+
+uint8_t adf4351_spi_busy(void) {
+    return adf4351_spi_active || (adf4351_spi_tail != adf4351_spi_head);
+}
+
+uint32_t adf4351_spi_get_clock_hz(void) {
+    return FCY / (2UL * (ADF4351_SPI_BRG + 1));
+}
+
+// =============================
+// SPI1 RX Interrupt Handler
+// =============================
+void __attribute__((interrupt, auto_psv)) _SPI1RXInterrupt(void) {
+    adf4351_spi_service();
+}
@@ -0,0 +1,23 @@
+// adf4351_spi.h - Interrupt-Driven SPI1 Transfer Queue for the ADF4351
+
+#ifndef ADF4351_SPI_H
+#define ADF4351_SPI_H
+
+#include <stdint.h>
+
+// SPI1 timing (ADF4351 datasheet: t1/t2 CLK high/low >= 25 ns -> 20 MHz max)
+#define ADF4351_SPI_MAX_HZ      20000000UL  // Maximum serial clock
+#define ADF4351_SPI_QUEUE_SIZE  8           // Pending register writes (power of two)
+#define ADF4351_SPI_IRQ_PRIO    5           // Below Timer1 (7), above GPS UART3 (4)
+
+// Completion callback, called from the SPI1 ISR (or from adf4351_spi_flush)
+typedef void (*adf4351_spi_callback_t)(uint32_t reg_data);
+
+// Function prototypes
+void adf4351_spi_init(void);
+uint8_t adf4351_spi_enqueue(uint32_t reg_data, adf4351_spi_callback_t callback);
+void adf4351_spi_flush(void);
+uint8_t adf4351_spi_busy(void);
+uint32_t adf4351_spi_get_clock_hz(void);
+
+#endif /* ADF4351_SPI_H */
@@ -0,0 +1,48 @@
+// crc_engine.c - Programmable CRC Module Driver Implementation
+//
+// Legacy (non-direct) mode: data bits enter the LFSR at the LSb end and the
+// remainder of the whole bit string is left in CRCWDAT once the last word
+// has been shifted. Blocking; one user at a time (main loop only).
+
+#include "../includes.h"
+#include "crc_engine.h"
+
+uint8_t crc_engine_remainder(uint32_t poly, uint8_t degree, const uint32_t *words,
+                             uint8_t count, uint32_t *remainder) {
+    uint32_t mask = (degree >= CRC_ENGINE_MAX_DEGREE) ? 0xFFFFFFFFUL : ((1UL << degree) - 1);
+    uint16_t timeout;
+    uint8_t ok = 1;
+
+    if (degree == 0 || degree > CRC_ENGINE_MAX_DEGREE || !(poly & 1)) return 0;
+
+    CRCCONL = 0;
+    CRCCONH = 0;
+    CRCCONLbits.CRCEN = 1;
+    CRCCONLbits.LENDIAN = 0;                    // MSb first
+    CRCCONLbits.MOD = 0;                        // Legacy: no implicit augmentation
+    CRCCONLbits.CRCISEL = 1;                    // CRCIF once the result is ready
+    CRCCONHbits.PLEN = degree - 1;
+    CRCCONHbits.DWIDTH = CRC_ENGINE_WORD_BITS - 1;
+    CRCXORL = (uint16_t)(poly & mask);          // X0 is implied
+    CRCXORH = (uint16_t)((poly & mask) >> 16);
+    CRCWDATL = 0;
+    CRCWDATH = 0;
+    _CRCIF = 0;
+    CRCCONLbits.CRCGO = 1;
+
+    for (uint8_t i = 0; i < count && ok; i++) {
+        for (timeout = CRC_ENGINE_TIMEOUT; CRCCONLbits.CRCFUL && timeout; timeout--);
+        if (!timeout) ok = 0;
+        CRCDATL = (uint16_t)words[i];
+        CRCDATH = (uint16_t)(words[i] >> 16);   // Word pushed on the high half
+    }
+
+    for (timeout = CRC_ENGINE_TIMEOUT; !(CRCCONLbits.CRCMPT && _CRCIF) && timeout; timeout--);
+    if (!timeout) ok = 0;
+
+    CRCCONLbits.CRCGO = 0;
+    *remainder = (((uint32_t)CRCWDATH << 16) | CRCWDATL) & mask;
+    _CRCIF = 0;
+    CRCCONLbits.CRCEN = 0;
+    return ok;
+}
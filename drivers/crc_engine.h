@@ -0,0 +1,20 @@
+// crc_engine.h - Programmable CRC Module Driver (polynomial remainders)
+
+#ifndef CRC_ENGINE_H
+#define CRC_ENGINE_H
+
+#include <stdint.h>
+
+#define CRC_ENGINE_MAX_DEGREE   32
+#define CRC_ENGINE_WORD_BITS    32      // Data words fed MSB first
+#define CRC_ENGINE_TIMEOUT      1000    // Status polls before giving up
+
+// Remainder of the bit string words[0..count-1] (MSB first) divided by
+// g(x) = x^degree + poly. Plain division: no seed, no reflection, no final
+// XOR, no augmentation (append degree zero bits to the data for a
+// systematic check field). poly must include the +1 term.
+// Returns 0 if the module did not complete.
+uint8_t crc_engine_remainder(uint32_t poly, uint8_t degree, const uint32_t *words,
+                             uint8_t count, uint32_t *remainder);
+
+#endif /* CRC_ENGINE_H */
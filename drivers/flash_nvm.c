@@ -0,0 +1,64 @@
+// flash_nvm.c - Program Flash Self-Write Driver Implementation
+//
+// The CPU stalls while a row/page operation is running (page erase is in
+// the tens of milliseconds), Timer1 included: only call these between
+// transmissions.
+
+#include "../includes.h"
+#include "flash_nvm.h"
+
+#define FLASH_NVM_OP_PAGE_ERASE     0x4003      // WREN | page erase
+#define FLASH_NVM_OP_DOUBLE_WORD    0x4001      // WREN | double-word program
+#define FLASH_NVM_LATCH_PAGE        0x00FA      // TBLPAG of the write latches
+
+static uint8_t flash_nvm_execute(uint16_t operation, uint32_t addr) {
+    NVMCON = operation;
+    NVMADR = (uint16_t)(addr & 0xFFFF);
+    NVMADRU = (uint16_t)(addr >> 16);
+
+    __builtin_disi(6);          // Unlock sequence must not be interrupted
+    __builtin_write_NVM();
+    while (NVMCONbits.WR);
+
+    NVMCONbits.WREN = 0;
+    return NVMCONbits.WRERR ? 0 : 1;
+}
+
+// Erase one page (page_addr aligned to FLASH_NVM_PAGE_PC_UNITS)
+uint8_t flash_nvm_erase_page(uint32_t page_addr) {
+    if (page_addr & (FLASH_NVM_PAGE_PC_UNITS - 1)) return 0;
+    return flash_nvm_execute(FLASH_NVM_OP_PAGE_ERASE, page_addr);
+}
+
+// Program two consecutive instruction words (addr aligned to 4 PC units).
+// Each word holds 16 data bits; the upper byte is programmed to 0.
+uint8_t flash_nvm_write_double(uint32_t addr, uint16_t word0, uint16_t word1) {
+    if (addr & 0x3) return 0;
+
+    uint16_t saved_tblpag = TBLPAG;
+    TBLPAG = FLASH_NVM_LATCH_PAGE;
+    __builtin_tblwtl(0, word0);
+    __builtin_tblwth(0, 0x00);
+    __builtin_tblwtl(2, word1);
+    __builtin_tblwth(2, 0x00);
+    TBLPAG = saved_tblpag;
+
+    return flash_nvm_execute(FLASH_NVM_OP_DOUBLE_WORD, addr);
+}
+
+uint16_t flash_nvm_read_word(uint32_t addr) {
+    uint16_t saved_tblpag = TBLPAG;
+    TBLPAG = (uint16_t)(addr >> 16);
+    uint16_t word = __builtin_tblrdl((uint16_t)(addr & 0xFFFF));
+    TBLPAG = saved_tblpag;
+    return word;
+}
+
+// CRC-16/CCITT (poly 0x1021), MSB first, one 16-bit word at a time
+uint16_t flash_nvm_crc16_update(uint16_t crc, uint16_t word) {
+    crc ^= word;
+    for (uint8_t i = 0; i < 16; i++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
@@ -0,0 +1,23 @@
+// flash_nvm.h - Program Flash Self-Write Driver (page erase, double-word program)
+
+#ifndef FLASH_NVM_H
+#define FLASH_NVM_H
+
+#include <stdint.h>
+
+// dsPIC33CK64MC105 program flash geometry
+#define FLASH_NVM_PAGE_WORDS        1024        // Instruction words per erase page
+#define FLASH_NVM_PAGE_PC_UNITS     0x800       // Erase page size in PC address units
+#define FLASH_NVM_ERASED_WORD       0xFFFF      // Lower 16 bits of an erased instruction word
+
+// Data is stored in the lower 16 bits of each instruction word, so a page
+// reserved with space(prog) holds FLASH_NVM_PAGE_WORDS uint16_t values and
+// word n of the page is at page address + 2 * n.
+
+// Function prototypes
+uint8_t flash_nvm_erase_page(uint32_t page_addr);
+uint8_t flash_nvm_write_double(uint32_t addr, uint16_t word0, uint16_t word1);
+uint16_t flash_nvm_read_word(uint32_t addr);
+uint16_t flash_nvm_crc16_update(uint16_t crc, uint16_t word);
+
+#endif /* FLASH_NVM_H */
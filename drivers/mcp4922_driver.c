@@ -6,6 +6,83 @@
 #include <math.h>
 #include <stdio.h>
 
+// Baud Rate = FP / (2 * (SPIxBRG + 1)), FP = FCY; round up to stay <= 20 MHz
+#define MCP4922_SPI_BRG ((FCY + (2 * MCP4922_SPI_MAX_HZ) - 1) / (2 * MCP4922_SPI_MAX_HZ) - 1)
+
+// =============================
+// Streaming State
+// =============================
+// Each sample is two 16-bit words (DAC A = I, DAC B = Q), each framed by SS2.
+// With LDAC held high the words only load the input latches; the next
+// sample tick pulses LDAC so both outputs change at the same instant.
+static volatile uint8_t mcp4922_pair_busy = 0;       // A/B pair still shifting
+static volatile uint8_t mcp4922_q_pending = 0;       // DAC B word waits for DAC A
+static volatile uint16_t mcp4922_q_word = 0;
+static volatile uint8_t mcp4922_pair_loaded = 0;     // Input latches hold an unlatched pair
+static volatile uint16_t mcp4922_overruns = 0;
+
+static const mcp4922_iq_sample_t *mcp4922_stream_buf = 0;
+static volatile uint16_t mcp4922_stream_len = 0;
+static volatile uint16_t mcp4922_stream_index = 0;
+static volatile uint8_t mcp4922_stream_loop = 0;
+static volatile uint8_t mcp4922_stream_active = 0;
+
+// DMA streaming state
+static volatile uint16_t *mcp4922_dma_buf = 0;
+static uint16_t mcp4922_dma_half = 0;               // Words per half buffer
+static mcp4922_dma_refill_t mcp4922_dma_refill = 0;
+static uint32_t mcp4922_dma_period_q16 = 0;         // FCY cycles per word (Q16)
+static int32_t mcp4922_dma_phase_q16 = 0;           // Cycles owed by past periods (Q16)
+static volatile uint8_t mcp4922_dma_active = 0;
+static uint8_t mcp4922_dma_resume = 0;              // Push stream to restore on stop
+static volatile uint16_t mcp4922_dma_late = 0;
+
+// Blocking single-word write, used outside streaming
+static void mcp4922_spi_write(uint16_t command) {
+    uint8_t rx_ie = _SPI2RXIE;
+    _SPI2RXIE = 0;
+    while(SPI2STATLbits.SPITBF);
+    SPI2BUFL = command;     // SS2 framed by hardware
+    while(!SPI2STATLbits.SPIRBF);
+    (void)SPI2BUFL;
+    _SPI2RXIF = 0;
+    _SPI2RXIE = rx_ie;
+}
+
+// Critical section that preserves the caller's interrupt state
+static uint8_t mcp4922_lock(void) {
+    uint8_t gie = INTCON2bits.GIE;
+    __builtin_disable_interrupts();
+    return gie;
+}
+
+static void mcp4922_unlock(uint8_t gie) {
+    if (gie) {
+        __builtin_enable_interrupts();
+    }
+}
+
+// Word complete: DAC B word follows DAC A, then the pair is done
+// (SPI2 RX ISR, or polled with the interrupt masked)
+static void mcp4922_stream_service(void) {
+    (void)SPI2BUFL;
+    _SPI2RXIF = 0;
+    if (mcp4922_q_pending) {
+        mcp4922_q_pending = 0;
+        SPI2BUFL = mcp4922_q_word;
+    } else {
+        mcp4922_pair_busy = 0;
+    }
+}
+
+// LDAC low pulse (tLD >= 100 ns): copy both input latches to the outputs
+static inline void mcp4922_ldac_pulse(void) {
+    MCP4922_LDAC_LAT = 0;
+    __builtin_nop(); __builtin_nop(); __builtin_nop();
+    __builtin_nop(); __builtin_nop(); __builtin_nop();
+    MCP4922_LDAC_LAT = 1;
+}
+
 void mcp4922_init(void) {
     // Configure SPI2 pins as digital (RB7-9 are digital by default)
     ANSELBbits.ANSELB7 = 0;  // RB7 digital (SCK2)
@@ -15,25 +92,34 @@ void mcp4922_init(void) {
     // Configure SPI2 pins as outputs
     TRISBbits.TRISB7 = 0;  // RB7 (SCK2) as output
     TRISBbits.TRISB8 = 0;  // RB8 (SDO2) as output
-    MCP4922_CS_TRIS = 0;   // RB9 (CS) as output
+    MCP4922_CS_TRIS = 0;   // RB9 (SS2) as output
     MCP4922_CS_LAT = 1;    // CS high (inactive)
-
-    // Configure PPS for SPI2
-    __builtin_write_RPCON(0x0000);
-    RPOR3bits.RP39R = 8;    // SCK2 on RB7 (RP39)
-    RPOR4bits.RP40R = 8;    // SDO2 on RB8 (RP40)
-    __builtin_write_RPCON(0x0800);
+    MCP4922_LDAC_TRIS = 0; // RB6 (LDAC) as output
+    MCP4922_LDAC_LAT = 0;  // Transparent: outputs follow each write
+    // Note: PPS configuration is done centrally in init_all_pps()
 
     // SPI2 Configuration
+    _SPI2RXIE = 0;
     SPI2CON1L = 0;          // Clear configuration
     SPI2CON1Lbits.MSTEN = 1;    // Master mode
     SPI2CON1Lbits.CKP = 0;      // Clock polarity: idle low
     SPI2CON1Lbits.CKE = 1;      // Clock edge: transmit on active to idle
+    SPI2CON1Lbits.DISSDI = 1;   // No MISO (MCP4922 is write-only)
+    SPI2CON1H = 0;
+    SPI2CON1Hbits.MSSEN = 1;    // SS2 = CS, driven automatically per word
+    SPI2CON1Hbits.FRMPOL = 0;   // Active-low chip select
     SPI2CON2Lbits.WLENGTH = 15; // 16-bit word length for MCP4922
-    SPI2BRGL = 6;               // 4MHz clock
+    SPI2BRGL = MCP4922_SPI_BRG; // 12.5 MHz at FCY = 50 MHz
+
+    // Interrupt on RX buffer full = word complete (streaming only)
+    SPI2IMSKL = 0;
+    SPI2IMSKLbits.SPIRBFEN = 1;
+    _SPI2RXIP = MCP4922_SPI_IRQ_PRIO;
+    _SPI2RXIF = 0;
+
     SPI2CON1Lbits.SPIEN = 1;    // Enable SPI2
 
-    DEBUG_LOG_FLUSH("MCP4922: SPI2 initialized (SCK2=RB7, SDO2=RB8, CS=RB9)\r\n");
+    DEBUG_LOG_FLUSH("MCP4922: SPI2 initialized (SCK2=RB7, SDO2=RB8, SS2=RB9, LDAC=RB6)\r\n");
 
     // Initialize DACs to mid-scale
     mcp4922_write_dac_a(MCP4922_OFFSET);
@@ -42,59 +128,269 @@ void mcp4922_init(void) {
 
 void mcp4922_write_dac_a(uint16_t value) {
     value &= 0x0FFF;
-    uint16_t command = MCP4922_DAC_A_CMD | value;
-    MCP4922_CS_LAT = 0;
-    while(SPI2STATLbits.SPITBF);
-    SPI2BUFL = command;  // Single 16-bit transaction
-    while(!SPI2STATLbits.SPIRBF);
-    (void)SPI2BUFL;
-    MCP4922_CS_LAT = 1;
+    mcp4922_spi_write(MCP4922_DAC_A_CMD | value);
 }
 
 void mcp4922_write_dac_b(uint16_t value) {
     value &= 0x0FFF;
-    uint16_t command = MCP4922_DAC_B_CMD | value;
-    MCP4922_CS_LAT = 0;
-    while(SPI2STATLbits.SPITBF);
-    SPI2BUFL = command;  // Single 16-bit transaction
-    while(!SPI2STATLbits.SPIRBF);
-    (void)SPI2BUFL;
-    MCP4922_CS_LAT = 1;
+    mcp4922_spi_write(MCP4922_DAC_B_CMD | value);
 }
 
+// Both channels change together: LDAC held high during the two writes
 void mcp4922_write_both(uint16_t i_value, uint16_t q_value) {
+    MCP4922_LDAC_LAT = 1;
     mcp4922_write_dac_a(i_value);
     mcp4922_write_dac_b(q_value);
+    mcp4922_ldac_pulse();
+    MCP4922_LDAC_LAT = 0;
 }
 
 void mcp4922_shutdown(void) {
-    MCP4922_CS_LAT = 0;
-    while(SPI2STATLbits.SPITBF);
-    SPI2BUFL = MCP4922_SHUTDOWN_A;  // Single 16-bit transaction
-    while(!SPI2STATLbits.SPIRBF);
-    (void)SPI2BUFL;
-    MCP4922_CS_LAT = 1;
-    __delay_us(1);
-    MCP4922_CS_LAT = 0;
-    while(SPI2STATLbits.SPITBF);
-    SPI2BUFL = MCP4922_SHUTDOWN_B;  // Single 16-bit transaction
-    while(!SPI2STATLbits.SPIRBF);
-    (void)SPI2BUFL;
-    MCP4922_CS_LAT = 1;
+    mcp4922_stream_stop();
+    mcp4922_spi_write(MCP4922_SHUTDOWN_A);
+    mcp4922_spi_write(MCP4922_SHUTDOWN_B);
+}
+
+// Q15 amplitude (-1.0 .. +1.0) to 12-bit code around mid-scale, integer only
+uint16_t mcp4922_q15_to_code(int16_t amplitude) {
+    return (uint16_t)(MCP4922_OFFSET + (int16_t)(((int32_t)amplitude * 2047 + 16384) >> 15));
+}
+
+void mcp4922_set_iq_q15(int16_t i_amplitude, int16_t q_amplitude) {
+    mcp4922_write_both(mcp4922_q15_to_code(i_amplitude), mcp4922_q15_to_code(q_amplitude));
 }
 
 void mcp4922_set_iq_outputs(float i_amplitude, float q_amplitude) {
-    uint16_t i_dac = (uint16_t)(MCP4922_OFFSET + i_amplitude * 2047);
-    uint16_t q_dac = (uint16_t)(MCP4922_OFFSET + q_amplitude * 2047);
-    if(i_dac > 4095) i_dac = 4095;
-    if(q_dac > 4095) q_dac = 4095;
-    mcp4922_write_both(i_dac, q_dac);
+    if(i_amplitude > 1.0f) i_amplitude = 1.0f;
+    if(i_amplitude < -1.0f) i_amplitude = -1.0f;
+    if(q_amplitude > 1.0f) q_amplitude = 1.0f;
+    if(q_amplitude < -1.0f) q_amplitude = -1.0f;
+    mcp4922_set_iq_q15((int16_t)(i_amplitude * MCP4922_Q15_FULL_SCALE),
+                       (int16_t)(q_amplitude * MCP4922_Q15_FULL_SCALE));
 }
 
 void mcp4922_output_oqpsk_symbol(uint8_t symbol_data) {
-    float i_val = ((symbol_data & 0x02) ? -1.0 : +1.0);
-    float q_val = ((symbol_data & 0x01) ? -1.0 : +1.0);
-    mcp4922_set_iq_outputs(i_val, q_val);
+    int16_t i_val = (symbol_data & 0x02) ? -MCP4922_Q15_FULL_SCALE : MCP4922_Q15_FULL_SCALE;
+    int16_t q_val = (symbol_data & 0x01) ? -MCP4922_Q15_FULL_SCALE : MCP4922_Q15_FULL_SCALE;
+    mcp4922_set_iq_q15(i_val, q_val);
+}
+
+// =============================
+// Sample-Rate Streaming
+// =============================
+
+// Start streaming a precomputed buffer, one sample per mcp4922_stream_tick().
+// A NULL buffer just switches to pipelined mode for mcp4922_stream_push().
+void mcp4922_stream_start(const mcp4922_iq_sample_t *buffer, uint16_t length, uint8_t loop) {
+    mcp4922_stream_stop();
+
+    uint8_t gie = mcp4922_lock();
+    mcp4922_stream_buf = buffer;
+    mcp4922_stream_len = buffer ? length : 0;
+    mcp4922_stream_index = 0;
+    mcp4922_stream_loop = loop;
+    mcp4922_overruns = 0;
+    mcp4922_pair_loaded = 0;
+    MCP4922_LDAC_LAT = 1;       // Hold outputs: only LDAC pulses update them
+    _SPI2RXIF = 0;
+    _SPI2RXIE = 1;
+    mcp4922_stream_active = 1;
+    mcp4922_unlock(gie);
+}
+
+// Finish the pair in flight, latch it and return to transparent writes.
+// The pair is drained by polling SPIRBF, so this also works at IPL >= 6
+// or with interrupts disabled (the SPI2 RX ISR could not run).
+void mcp4922_stream_stop(void) {
+    if (!mcp4922_stream_active) return;
+
+    _SPI2RXIE = 0;
+    while (mcp4922_pair_busy) {
+        if (SPI2STATLbits.SPIRBF) {
+            mcp4922_stream_service();
+        }
+    }
+    if (mcp4922_pair_loaded) {
+        mcp4922_ldac_pulse();
+        mcp4922_pair_loaded = 0;
+    }
+    MCP4922_LDAC_LAT = 0;
+    mcp4922_stream_active = 0;
+}
+
+// Call once per sample period (Timer1 ISR): outputs the previous sample and
+// starts shifting this one. If the previous pair has not finished shifting,
+// this sample is dropped and counted as an overrun.
+void mcp4922_stream_push(uint16_t i_code, uint16_t q_code) {
+    if (mcp4922_pair_busy) {
+        mcp4922_overruns++;
+        return;
+    }
+    if (mcp4922_pair_loaded) {
+        mcp4922_ldac_pulse();
+    }
+
+    mcp4922_q_word = MCP4922_DAC_B_CMD | (q_code & 0x0FFF);
+    mcp4922_q_pending = 1;
+    mcp4922_pair_busy = 1;
+    mcp4922_pair_loaded = 1;
+    SPI2BUFL = MCP4922_DAC_A_CMD | (i_code & 0x0FFF);
+}
+
+// Buffer mode: push the next precomputed sample
+void mcp4922_stream_tick(void) {
+    if (!mcp4922_stream_active || !mcp4922_stream_buf) return;
+
+    if (mcp4922_stream_index >= mcp4922_stream_len) {
+        if (!mcp4922_stream_loop) {
+            // End of buffer: latch the last pair and stop pushing
+            if (mcp4922_pair_loaded && !mcp4922_pair_busy) {
+                mcp4922_ldac_pulse();
+                mcp4922_pair_loaded = 0;
+            }
+            return;
+        }
+        mcp4922_stream_index = 0;
+    }
+
+    const mcp4922_iq_sample_t *sample = &mcp4922_stream_buf[mcp4922_stream_index];
+    mcp4922_stream_push(sample->i_code, sample->q_code);
+    mcp4922_stream_index++;
+}
+
+uint8_t mcp4922_stream_is_active(void) {
+    return mcp4922_stream_active;
+}
+
+uint16_t mcp4922_stream_get_overruns(void) {
+    return mcp4922_overruns;
+}
+
+// =============================
+// DMA Streaming
+// =============================
+// FCY / word rate is not an integer (50 MHz / 307200 = 162.76), so the SCCP1
+// period is chosen per half buffer to keep the accumulated timing error
+// below one period: the average word rate is exact, the jitter one cycle.
+static void mcp4922_dma_retune(void) {
+    int32_t target = (int32_t)mcp4922_dma_period_q16 + mcp4922_dma_phase_q16 / (int32_t)mcp4922_dma_half;
+    uint16_t period = (uint16_t)(target >> 16);
+
+    // Never move the period below the running count (the timer would wrap)
+    if ((uint16_t)(CCP1TMRL + 8) < period && (uint16_t)(CCP1TMRL + 8) < CCP1PRL) {
+        CCP1PRL = period - 1;
+    }
+    mcp4922_dma_phase_q16 += ((int32_t)mcp4922_dma_period_q16 - ((int32_t)(CCP1PRL + 1) << 16)) *
+                             (int32_t)mcp4922_dma_half;
+}
+
+// Start streaming 'count' words (even, two halves). Both halves are filled
+// before the first transfer.
+void mcp4922_dma_start(volatile uint16_t *buffer, uint16_t count, uint32_t word_rate_hz,
+                       mcp4922_dma_refill_t refill) {
+    mcp4922_dma_stop();
+    mcp4922_dma_resume = mcp4922_stream_active;
+    mcp4922_stream_stop();
+
+    mcp4922_dma_buf = buffer;
+    mcp4922_dma_half = count >> 1;
+    mcp4922_dma_refill = refill;
+    mcp4922_dma_period_q16 = (uint32_t)(((uint64_t)FCY << 16) / word_rate_hz);
+    mcp4922_dma_phase_q16 = 0;
+    mcp4922_dma_late = 0;
+    refill(buffer, mcp4922_dma_half);
+    refill(buffer + mcp4922_dma_half, mcp4922_dma_half);
+
+    MCP4922_LDAC_LAT = 0;           // Transparent: each word updates its DAC
+    SPI2CON1Hbits.IGNROV = 1;       // Nobody reads the RX side while streaming
+
+    // SCCP1: 16-bit timer on FCY, period match triggers one DMA transfer
+    CCP1CON1L = 0;
+    CCP1CON1H = 0;
+    CCP1CON1Lbits.CLKSEL = 0;       // FOSC/2 = FCY
+    CCP1CON1Lbits.TMRPS = 0;
+    CCP1TMRL = 0;
+    CCP1PRL = (uint16_t)(mcp4922_dma_period_q16 >> 16) - 1;
+
+    // DMA0: repeated one-shot, one word per trigger, source incremented
+    DMACONbits.DMAEN = 1;
+    DMACONbits.PRSSEL = 0;          // Fixed priority
+    DMAL = 0x1000;                  // Data RAM
+    DMAH = 0x2FFF;
+    DMACH0 = 0;
+    DMACH0bits.SIZE = 0;            // 16-bit
+    DMACH0bits.TRMODE = 1;          // Repeated one-shot
+    DMACH0bits.SAMODE = 1;          // Source incremented
+    DMACH0bits.DAMODE = 0;          // Destination fixed (SPI2BUFL)
+    DMACH0bits.RELOAD = 1;          // Reload source and count at the end
+    DMAINT0 = 0;
+    DMAINT0bits.CHSEL = MCP4922_DMA_TRIGGER;
+    DMAINT0bits.HALFEN = 1;         // Interrupt at half count and at the end
+    DMASRC0 = (uint16_t)buffer;
+    DMADST0 = (uint16_t)&SPI2BUFL;
+    DMACNT0 = count;
+
+    _DMA0IP = MCP4922_DMA_IRQ_PRIO;
+    _DMA0IF = 0;
+    _DMA0IE = 1;
+    mcp4922_dma_active = 1;
+    DMACH0bits.CHEN = 1;
+    CCP1CON1Lbits.CCPON = 1;
+}
+
+// Stop at once and drain SPI2; the DACs hold the last word written and the
+// per-sample push stream is restored if it was running before
+void mcp4922_dma_stop(void) {
+    if (!mcp4922_dma_active) return;
+
+    CCP1CON1Lbits.CCPON = 0;
+    DMACH0bits.CHEN = 0;
+    _DMA0IE = 0;
+    _DMA0IF = 0;
+    while (SPI2STATLbits.SPIBUSY);
+    while (SPI2STATLbits.SPIRBF) {
+        (void)SPI2BUFL;
+    }
+    SPI2STATLbits.SPIROV = 0;
+    SPI2CON1Hbits.IGNROV = 0;
+    if (mcp4922_dma_resume) {
+        mcp4922_stream_start(0, 0, 0);
+    }
+    mcp4922_dma_active = 0;
+}
+
+uint8_t mcp4922_dma_is_active(void) {
+    return mcp4922_dma_active;
+}
+
+uint16_t mcp4922_dma_get_late_refills(void) {
+    return mcp4922_dma_late;
+}
+
+// Half or end of the buffer reached: refill the half just sent
+void __attribute__((interrupt, auto_psv)) _DMA0Interrupt(void) {
+    uint8_t half = DMAINT0bits.HALFIF;
+    uint8_t done = DMAINT0bits.DONEIF;
+
+    DMAINT0bits.HALFIF = 0;
+    DMAINT0bits.DONEIF = 0;
+    _DMA0IF = 0;
+    if (half && done) mcp4922_dma_late++;       // Both halves gone: one refill was missed
+
+    volatile uint16_t *words = done ? mcp4922_dma_buf + mcp4922_dma_half : mcp4922_dma_buf;
+    if (!mcp4922_dma_refill(words, mcp4922_dma_half)) {
+        mcp4922_dma_stop();
+        return;
+    }
+    mcp4922_dma_retune();
+}
+
+// =============================
+// SPI2 RX Interrupt Handler
+// =============================
+// Word complete: send DAC B after DAC A, then release the pair
+void __attribute__((interrupt, auto_psv)) _SPI2RXInterrupt(void) {
+    mcp4922_stream_service();
 }
 
 void mcp4922_debug_spi2(void) {
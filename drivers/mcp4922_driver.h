@@ -16,8 +16,30 @@
 #define MCP4922_OFFSET          2048    // Mid-scale (1.65V with 3.3V ref)
 
 // Pin assignments for SPI2 (RB7, RB8, RB9)
-#define MCP4922_CS_TRIS         TRISBbits.TRISB9
+#define MCP4922_CS_TRIS         TRISBbits.TRISB9    // SS2, driven by the SPI module
 #define MCP4922_CS_LAT          LATBbits.LATB9
+#define MCP4922_LDAC_TRIS       TRISBbits.TRISB6    // LDAC: low pulse updates A and B together
+#define MCP4922_LDAC_LAT        LATBbits.LATB6
+
+// SPI2 timing and streaming
+#define MCP4922_SPI_MAX_HZ      20000000UL  // MCP4922 maximum SCK
+#define MCP4922_SPI_IRQ_PRIO    6           // Below Timer1 (7): second word of a pair
+#define MCP4922_Q15_FULL_SCALE  32767       // +1.0 in Q15
+
+// DMA streaming: one word per SCCP1 timer period, DAC A and B words interleaved,
+// LDAC transparent. Ping-pong halves refilled from the DMA0 interrupt.
+#define MCP4922_DMA_IRQ_PRIO    6           // Below Timer1 (7)
+#define MCP4922_DMA_TRIGGER     0x01        // DMAINTx CHSEL: SCCP1 interrupt
+
+// One I/Q output sample, already converted to 12-bit DAC codes
+typedef struct {
+    uint16_t i_code;
+    uint16_t q_code;
+} mcp4922_iq_sample_t;
+
+// Fills 'count' words (full SPI words, command bits included). Returns 0 when
+// the stream is over: the DMA stops once the refill returns.
+typedef uint8_t (*mcp4922_dma_refill_t)(volatile uint16_t *words, uint16_t count);
 
 // Function prototypes
 void mcp4922_init(void);
@@ -29,7 +51,24 @@ void mcp4922_debug_spi2(void);
 void mcp4922_test_pattern(void);
 
 // I/Q specific functions
+uint16_t mcp4922_q15_to_code(int16_t amplitude);
+void mcp4922_set_iq_q15(int16_t i_amplitude, int16_t q_amplitude);
 void mcp4922_set_iq_outputs(float i_amplitude, float q_amplitude);
 void mcp4922_output_oqpsk_symbol(uint8_t symbol_data);
 
+// Sample-rate streaming (LDAC-synchronized, one sample of pipeline latency)
+void mcp4922_stream_start(const mcp4922_iq_sample_t *buffer, uint16_t length, uint8_t loop);
+void mcp4922_stream_stop(void);
+void mcp4922_stream_push(uint16_t i_code, uint16_t q_code);
+void mcp4922_stream_tick(void);
+uint8_t mcp4922_stream_is_active(void);
+uint16_t mcp4922_stream_get_overruns(void);
+
+// DMA streaming (word rate set by SCCP1, long-term exact by period dithering)
+void mcp4922_dma_start(volatile uint16_t *buffer, uint16_t count, uint32_t word_rate_hz,
+                       mcp4922_dma_refill_t refill);
+void mcp4922_dma_stop(void);
+uint8_t mcp4922_dma_is_active(void);
+uint16_t mcp4922_dma_get_late_refills(void);
+
 #endif /* MCP4922_DRIVER_H */
\ No newline at end of file
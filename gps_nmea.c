@@ -2,6 +2,7 @@
 #include "gps_nmea.h"
 #include "system_debug.h"
 #include "protocol_data.h"
+#include "gps_ubx.h"
 #include <xc.h>
 #include <string.h>
 #include <stdlib.h>
@@ -13,19 +14,29 @@ const char gps_build_date[] = __DATE__;
 // =============================
 // Global Variables
 // =============================
-gps_data_t gps_data = {0};
-volatile uint8_t gps_rx_buffer[GPS_BUFFER_SIZE];
-volatile uint8_t gps_rx_head = 0;
-volatile uint8_t gps_rx_tail = 0;
+// Shared position record: TEST position until the first fix
+static volatile gps_position_t gps_position = {
+    0, TEST_LATITUDE_E7, TEST_LONGITUDE_E7, TEST_ALTITUDE_MM, 0, 0, 0, GPS_FIX_INVALID, 0, 0
+};
+// DMA1 writes, gps_update() reads: the write index is DMA1's destination
+static volatile uint8_t gps_rx_buffer[GPS_BUFFER_SIZE] __attribute__((aligned(2)));
+static uint16_t gps_rx_tail = 0;
 
 static char nmea_sentence[GPS_NMEA_MAX_LENGTH];
 static uint8_t nmea_index = 0;
 
+// Link statistics (1 s windows computed in gps_update)
+static gps_link_stats_t gps_link = { GPS_DEFAULT_BAUD, 0, 0, 0, 0 };
+static uint16_t gps_sentence_count = 0;
+static uint16_t gps_window_bytes = 0;
+static uint16_t gps_window_sentences = 0;
+static uint32_t gps_window_start_ms = 0;
+
 // GPS debug mode
 volatile uint8_t gps_debug_raw = 1;  // 0=off, 1=print raw NMEA sentences (AUTO ON)
 volatile uint16_t gps_rx_count = 0;  // Count of chars received from GPS
-volatile uint16_t gps_irq_count = 0;  // Count of interrupt calls
 volatile uint16_t gps_oerr_count = 0; // Count of overrun errors
+volatile uint16_t gps_ferr_count = 0; // Count of framing errors
 
 // =============================
 // UART3 Initialization (GPS)
@@ -47,18 +58,39 @@ void gps_init(void) {
     // Note: RC4 and RC5 are digital-only pins, no ANSEL configuration needed
     // Note: PPS configuration is done centrally in init_all_pps()
 
-    // Configure UART3: 9600 baud, 8N1
+    // Configure UART3: 9600 baud, 8N1 (gps_negotiate() may change it)
     // Baud rate calculation: BRG = (Fcy / (16 * BaudRate)) - 1
-    U3BRG = (FCY / (16UL * 9600)) - 1;  // Auto-calculated for current Fcy
+    gps_uart_set_baud(GPS_DEFAULT_BAUD);
 
     // UART Mode: 8-bit data, no parity, 1 stop bit
     U3MODEbits.MOD = 0;     // Asynchronous 8-bit UART
     U3MODEbits.BRGH = 0;    // Standard speed mode
 
-    // Configure RX interrupt mode
-    // URXISEL: 000=IRQ when 1 char, 001=2 chars, 010=3 chars, 011=4 chars
-    // Try different values - on dsPIC33CK URXISEL meanings may differ
-    U3STAHbits.URXISEL = 0b011; // Interrupt when RX buffer is 3/4 full (4 chars)
+    // RX event on every character: each one is a DMA1 trigger. The CPU RX
+    // interrupt stays off, only errors (overrun, framing) interrupt.
+    U3STAHbits.URXISEL = 0;
+    U3STAbits.OERIE = 1;
+    U3STAbits.FERIE = 1;
+
+    // DMA1: repeated one-shot, one byte per trigger, U3RXREG -> ring
+    gps_rx_tail = 0;
+    DMACONbits.DMAEN = 1;           // Same global setup as the MCP4922 DMA0
+    DMACONbits.PRSSEL = 0;          // Fixed priority (DMA0 first)
+    DMAL = 0x1000;                  // Data RAM
+    DMAH = 0x2FFF;
+    DMACH1 = 0;
+    DMACH1bits.SIZE = 1;            // 8-bit
+    DMACH1bits.TRMODE = 1;          // Repeated one-shot
+    DMACH1bits.SAMODE = 0;          // Source fixed (U3RXREG)
+    DMACH1bits.DAMODE = 1;          // Destination incremented
+    DMACH1bits.RELOAD = 1;          // Back to the start of the ring at the end
+    DMAINT1 = 0;
+    DMAINT1bits.CHSEL = GPS_DMA_TRIGGER;
+    DMASRC1 = (uint16_t)&U3RXREG;
+    DMADST1 = (uint16_t)gps_rx_buffer;
+    DMACNT1 = GPS_BUFFER_SIZE;
+    _DMA1IE = 0;                    // Polled by gps_update()
+    DMACH1bits.CHEN = 1;
 
     // Enable UART3
     U3MODEbits.UARTEN = 1;
@@ -66,22 +98,34 @@ void gps_init(void) {
     U3MODEbits.URXEN = 1;
 
     // Configure interruptions AFTER enabling UART
-    IFS3bits.U3RXIF = 0;
-    IEC3bits.U3RXIE = 1;
-    IPC14bits.U3RXIP = 4;  // Priority 5 (lower than Timer1 priority 7 for modulation)
+    IEC3bits.U3RXIE = 0;
+    _U3EIF = 0;
+    _U3EIP = GPS_ERR_IRQ_PRIO;      // Below Timer1 (7) and DMA0 (6)
+    _U3EIE = 1;
 
     // Double activation like U1
     U3MODEbits.UARTEN = 1;
     __builtin_nop();
     __builtin_nop();
 
-    // Initialize GPS data structure
-    gps_data.position_valid = 0;
-    gps_data.fix_quality = GPS_FIX_INVALID;
-    gps_data.satellites = 0;
-    gps_data.last_update_ms = 0;
-
-    DEBUG_LOG_FLUSH("GPS: UART3 initialized at 9600 baud [Build: ");
+    // Initialize GPS position record (position kept, fix cleared)
+    gps_position_t pos;
+    gps_position_read(&pos);
+    pos.position_valid = 0;
+    pos.fix_quality = GPS_FIX_INVALID;
+    pos.satellites = 0;
+    pos.last_update_ms = 0;
+    gps_position_publish(&pos);
+
+#if GPS_USE_UBX
+    gps_ubx_configure();            // Leaves UART3 at GPS_UBX_BAUD
+#elif GPS_NEGOTIATE
+    gps_negotiate();
+#endif
+
+    DEBUG_LOG_FLUSH("GPS: UART3 initialized at ");
+    debug_print_uint32(gps_link.baud);
+    DEBUG_LOG_FLUSH(" baud [Build: ");
     DEBUG_LOG_FLUSH(gps_build_time);
     DEBUG_LOG_FLUSH(" ");
     DEBUG_LOG_FLUSH(gps_build_date);
@@ -107,27 +151,87 @@ void gps_init(void) {
 }
 
 // =============================
-// UART3 RX Interrupt Handler
+// UART3 Error Interrupt Handler
 // =============================
-void __attribute__((interrupt, auto_psv)) _U3RXInterrupt(void) {
-    gps_irq_count++;
-
-    // Read ALL available characters from FIFO (up to 4 with URXISEL=0b011)
-    while (U3STAHbits.URXBE == 0) {  // While data available
-        uint8_t next_head = (gps_rx_head + 1) % GPS_BUFFER_SIZE;
-
-        if (next_head == gps_rx_tail) {
-            // Buffer full - discard
-            volatile uint8_t dummy = U3RXREG;
-            (void)dummy;
-        } else {
-            gps_rx_buffer[gps_rx_head] = U3RXREG;
-            gps_rx_head = next_head;
-            gps_rx_count++;
-        }
+// Received bytes never interrupt (DMA1); only overrun and framing errors do.
+// OERR must be cleared for the receiver to accept characters again.
+void __attribute__((interrupt, auto_psv)) _U3EInterrupt(void) {
+    if (U3STAbits.OERR) {
+        gps_oerr_count++;
+        U3STAbits.OERR = 0;
+    }
+    if (U3STAbits.FERIF) {
+        gps_ferr_count++;
+        U3STAbits.FERIF = 0;
+    }
+    _U3EIF = 0;
+}
+
+// =============================
+// UART3 Transmit (receiver configuration)
+// =============================
+void gps_uart_write(const uint8_t *data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        while (U3STAHbits.UTXBF);
+        U3TXREG = data[i];
     }
+    while (!U3STAbits.TRMT);        // Last stop bit out before any baud change
+}
+
+void gps_uart_set_baud(uint32_t baud) {
+    U3BRG = (uint16_t)((FCY / (16UL * baud)) - 1);
+    gps_link.baud = baud;
+}
+
+// DMA1 write index in the ring (DMADST1 is one 16-bit read, no tearing)
+static uint16_t gps_rx_head(void) {
+    uint16_t head = DMADST1 - (uint16_t)gps_rx_buffer;
+    return (head >= GPS_BUFFER_SIZE) ? 0 : head;
+}
+
+// =============================
+// Shared Position Record (seqlock)
+// =============================
+// dsPIC33 stores and loads are in program order; volatile keeps the
+// compiler from moving the field accesses across the seq updates.
+void gps_position_publish(const gps_position_t *pos) {
+    uint16_t seq = gps_position.seq | 1;
+
+    gps_position.seq = seq;                     // Odd: readers will retry
+    gps_position.lat_e7 = pos->lat_e7;
+    gps_position.lon_e7 = pos->lon_e7;
+    gps_position.alt_mm = pos->alt_mm;
+    gps_position.last_update_ms = pos->last_update_ms;
+    gps_position.utc_ms = pos->utc_ms;
+    gps_position.hdop_x10 = pos->hdop_x10;
+    gps_position.fix_quality = pos->fix_quality;
+    gps_position.satellites = pos->satellites;
+    gps_position.position_valid = pos->position_valid;
+    gps_position.seq = seq + 1;
+
+    gps_updated = 1;
+}
+
+uint8_t gps_position_try_read(gps_position_t *pos) {
+    uint16_t seq = gps_position.seq;
+    if (seq & 1) return 0;
+
+    pos->seq = seq;
+    pos->lat_e7 = gps_position.lat_e7;
+    pos->lon_e7 = gps_position.lon_e7;
+    pos->alt_mm = gps_position.alt_mm;
+    pos->last_update_ms = gps_position.last_update_ms;
+    pos->utc_ms = gps_position.utc_ms;
+    pos->hdop_x10 = gps_position.hdop_x10;
+    pos->fix_quality = gps_position.fix_quality;
+    pos->satellites = gps_position.satellites;
+    pos->position_valid = gps_position.position_valid;
+
+    return gps_position.seq == seq;
+}
 
-    IFS3bits.U3RXIF = 0;
+void gps_position_read(gps_position_t *pos) {
+    while (!gps_position_try_read(pos));
 }
 
 // =============================
@@ -179,6 +283,27 @@ static double parse_coordinate(const char *coord, const char *dir) {
     return decimal;
 }
 
+// =============================
+// Helper: Parse UTC time field (hhmmss.sss) to ms of day
+// =============================
+static uint32_t parse_utc_ms(const char *field) {
+    uint32_t seconds = 0;
+    uint16_t ms = 0, scale = 100;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        if (field[i] < '0' || field[i] > '9') return 0;
+    }
+    seconds = ((field[0] - '0') * 10 + (field[1] - '0')) * 3600UL +
+              ((field[2] - '0') * 10 + (field[3] - '0')) * 60U +
+              ((field[4] - '0') * 10 + (field[5] - '0'));
+    if (field[6] == '.') {
+        for (const char *p = field + 7; *p >= '0' && *p <= '9' && scale; p++, scale /= 10) {
+            ms += (*p - '0') * scale;
+        }
+    }
+    return seconds * 1000UL + ms;
+}
+
 // =============================
 // Parse NMEA GGA Sentence
 // =============================
@@ -216,33 +341,18 @@ void gps_parse_gga(const char *sentence) {
         uint8_t satellites = atoi(fields[7]);
         uint16_t hdop_x10 = (uint16_t)(atof(fields[8]) * 10.0);
 
-        // ATOMIC UPDATE: Write GPS data directly to shared variables
-        // This eliminates TOCTOU race conditions by writing immediately after parsing
-        // No flag needed - atomic section guarantees consistency
-        __builtin_disable_interrupts();
-
-        // Update local GPS data structure
-        gps_data.latitude = latitude;
-        gps_data.longitude = longitude;
-        gps_data.altitude = altitude;
-        gps_data.fix_quality = quality;
-        gps_data.satellites = satellites;
-        gps_data.hdop_x10 = hdop_x10;
-        gps_data.position_valid = 1;
-        gps_data.last_update_ms = millis_counter;
-
-        // Direct atomic write to shared variables (used by protocol_data.c)
-        extern volatile double current_latitude;
-        extern volatile double current_longitude;
-        extern volatile double current_altitude;
-        extern volatile uint8_t gps_updated;
-
-        current_latitude = latitude;
-        current_longitude = longitude;
-        current_altitude = altitude;
-        gps_updated = 1;
-
-        __builtin_enable_interrupts();
+        gps_position_t pos;
+        gps_position_read(&pos);
+        pos.lat_e7 = gps_deg_to_e7(latitude);
+        pos.lon_e7 = gps_deg_to_e7(longitude);
+        pos.alt_mm = (int32_t)lround(altitude * 1000.0);
+        pos.fix_quality = quality;
+        pos.satellites = satellites;
+        pos.hdop_x10 = hdop_x10;
+        pos.utc_ms = parse_utc_ms(fields[1]);
+        pos.position_valid = 1;
+        pos.last_update_ms = now_ms();
+        gps_position_publish(&pos);
     }
 }
 
@@ -280,132 +390,304 @@ void gps_parse_rmc(const char *sentence) {
         double latitude = parse_coordinate(fields[3], fields[4]);
         double longitude = parse_coordinate(fields[5], fields[6]);
 
-        // ATOMIC UPDATE: Write GPS data directly to shared variables
-        __builtin_disable_interrupts();
-
-        // Update local GPS data structure
-        gps_data.latitude = latitude;
-        gps_data.longitude = longitude;
-        gps_data.position_valid = 1;
-        gps_data.last_update_ms = millis_counter;
-
-        // Direct atomic write to shared variables (RMC doesn't provide altitude)
-        extern volatile double current_latitude;
-        extern volatile double current_longitude;
-        extern volatile double current_altitude;
-        extern volatile uint8_t gps_updated;
-
-        current_latitude = latitude;
-        current_longitude = longitude;
-        // Keep existing altitude (RMC sentence doesn't include it)
-        gps_updated = 1;
-
-        __builtin_enable_interrupts();
+        // RMC has no altitude: keep the stored one
+        gps_position_t pos;
+        gps_position_read(&pos);
+        pos.lat_e7 = gps_deg_to_e7(latitude);
+        pos.lon_e7 = gps_deg_to_e7(longitude);
+        pos.utc_ms = parse_utc_ms(fields[1]);
+        pos.position_valid = 1;
+        pos.last_update_ms = now_ms();
+        gps_position_publish(&pos);
     }
 }
 
 // =============================
 // Process GPS Data (Main Loop)
 // =============================
+// Add one character to the sentence being assembled. Returns the sentence
+// length once '\n' closes it (nmea_sentence NUL-terminated), 0 otherwise.
+static uint8_t gps_nmea_collect(char c) {
+    if (c == '$') {
+        nmea_index = 0;
+        nmea_sentence[nmea_index++] = c;
+    } else if (nmea_index > 0 && nmea_index < GPS_NMEA_MAX_LENGTH - 1) {
+        nmea_sentence[nmea_index++] = c;
+
+        // End of sentence
+        if (c == '\n') {
+            uint8_t length = nmea_index;
+            nmea_sentence[length] = '\0';
+            nmea_index = 0;
+            return length;
+        }
+    } else {
+        nmea_index = 0;  // Reset on overflow
+    }
+    return 0;
+}
+
+// Sentence type from the "$ttSSS," header: talker GP or GN, then GGA / RMC
+static uint8_t gps_sentence_type(const char *sentence, uint8_t length) {
+    if (length < 7 || sentence[1] != 'G' || (sentence[2] != 'P' && sentence[2] != 'N') ||
+        sentence[6] != ',') {
+        return GPS_SENTENCE_OTHER;
+    }
+    if (sentence[3] == 'G' && sentence[4] == 'G' && sentence[5] == 'A') return GPS_SENTENCE_GGA;
+    if (sentence[3] == 'R' && sentence[4] == 'M' && sentence[5] == 'C') return GPS_SENTENCE_RMC;
+    return GPS_SENTENCE_OTHER;
+}
+
 uint8_t gps_update(void) {
     uint8_t new_data = 0;
+    uint16_t head = gps_rx_head();
 
-    // Process all available data in RX buffer
-    while (gps_rx_tail != gps_rx_head) {
+    // Walk the ring up to the DMA write index; '\n' closes a sentence
+    while (gps_rx_tail != head) {
         char c = gps_rx_buffer[gps_rx_tail];
-        gps_rx_tail = (gps_rx_tail + 1) % GPS_BUFFER_SIZE;
+        if (++gps_rx_tail >= GPS_BUFFER_SIZE) gps_rx_tail = 0;
+        gps_rx_count++;
+
+#if GPS_USE_UBX
+        new_data |= gps_ubx_input((uint8_t)c);
+        continue;
+#endif
+
+        uint8_t length = gps_nmea_collect(c);
+        if (length) {
+            uint8_t type = gps_sentence_type(nmea_sentence, length);
+            gps_sentence_count++;
+
+            // Debug: print raw NMEA sentence (filter: only GPGGA/GNGGA)
+            if (gps_debug_raw && type == GPS_SENTENCE_GGA) {
+                DEBUG_LOG_FLUSH("NMEA: ");
+                DEBUG_LOG_FLUSH(nmea_sentence);
+                DEBUG_LOG_FLUSH("\r\n");
+            }
 
-        // Build NMEA sentence
-        if (c == '$') {
-            nmea_index = 0;
-            nmea_sentence[nmea_index++] = c;
-        } else if (nmea_index > 0 && nmea_index < GPS_NMEA_MAX_LENGTH - 1) {
-            nmea_sentence[nmea_index++] = c;
-
-            // End of sentence
-            if (c == '\n') {
-                nmea_sentence[nmea_index] = '\0';
-
-                // Debug: print raw NMEA sentence (filter: only GPGGA/GNGGA)
-                if (gps_debug_raw) {
-                    if (strstr(nmea_sentence, "$GPGGA") || strstr(nmea_sentence, "$GNGGA")) {
-                        DEBUG_LOG_FLUSH("NMEA: ");
-                        DEBUG_LOG_FLUSH(nmea_sentence);
-                        DEBUG_LOG_FLUSH("\r\n");
-                    }
-                }
-
-                // Parse sentence
-                if (strstr(nmea_sentence, "$GPGGA") || strstr(nmea_sentence, "$GNGGA")) {
-                    gps_parse_gga(nmea_sentence);
-                    new_data = 1;
-                } else if (strstr(nmea_sentence, "$GPRMC") || strstr(nmea_sentence, "$GNRMC")) {
-                    gps_parse_rmc(nmea_sentence);
-                    new_data = 1;
-                }
-
-                nmea_index = 0;
+            // Parse sentence
+            if (type == GPS_SENTENCE_GGA) {
+                gps_parse_gga(nmea_sentence);
+                new_data = 1;
+            } else if (type == GPS_SENTENCE_RMC) {
+                gps_parse_rmc(nmea_sentence);
+                new_data = 1;
             }
-        } else {
-            nmea_index = 0;  // Reset on overflow
         }
     }
 
+    // Link statistics over 1 s windows
+    uint32_t elapsed = now_ms() - gps_window_start_ms;
+    if (elapsed >= 1000) {
+        gps_link.bytes_per_s = (uint16_t)((uint32_t)(uint16_t)(gps_rx_count - gps_window_bytes) * 1000UL / elapsed);
+        gps_link.sentences_per_s = (uint16_t)((uint32_t)(uint16_t)(gps_sentence_count - gps_window_sentences) * 1000UL / elapsed);
+        gps_window_bytes = gps_rx_count;
+        gps_window_sentences = gps_sentence_count;
+        gps_window_start_ms += elapsed;
+    }
+
     return new_data;
 }
 
 // =============================
-// GPS Status Functions
+// Startup Negotiation (NMEA mode)
 // =============================
-const gps_data_t* gps_get_data(void) {
-    return &gps_data;
+#define GPS_STR(x)  #x
+#define GPS_XSTR(x) GPS_STR(x)
+
+// Vendor commands without '$' and checksum (added by gps_send_nmea)
+static const char * const gps_prune_cmds[] = {
+    "PUBX,40,GGA,0,1,0,0,0,0",
+    "PUBX,40,RMC,0," GPS_XSTR(GPS_RMC_DIVIDER) ",0,0,0,0",
+    "PUBX,40,GLL,0,0,0,0,0,0",
+    "PUBX,40,GSA,0,0,0,0,0,0",
+    "PUBX,40,GSV,0,0,0,0,0,0",
+    "PUBX,40,VTG,0,0,0,0,0,0",
+    "PUBX,40,ZDA,0,0,0,0,0,0",
+    "PMTK314,0," GPS_XSTR(GPS_RMC_DIVIDER) ",0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0"
+};
+
+static const char * const gps_baud_cmds[] = {
+    "PUBX,41,1,0007,0002," GPS_XSTR(GPS_NMEA_BAUD) ",0",
+    "PMTK251," GPS_XSTR(GPS_NMEA_BAUD)
+};
+
+static void gps_send_nmea(const char *body) {
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t checksum = 0;
+    uint8_t tail[5];
+
+    for (const char *p = body; *p; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+    tail[0] = '*';
+    tail[1] = hex[checksum >> 4];
+    tail[2] = hex[checksum & 0x0F];
+    tail[3] = '\r';
+    tail[4] = '\n';
+    gps_uart_write((const uint8_t *)"$", 1);
+    gps_uart_write((const uint8_t *)body, strlen(body));
+    gps_uart_write(tail, sizeof(tail));
+}
+
+// Wait up to GPS_PROBE_MS for one sentence with a valid checksum at the
+// current baud rate (SCCP3 timebase, runs with interrupts still disabled).
+// Returns 1 when found, 0 on timeout.
+static uint8_t gps_probe(void) {
+    uint32_t start = now_ms();
+
+    gps_rx_tail = gps_rx_head();        // Drop what came at the previous rate
+    nmea_index = 0;
+
+    while ((now_ms() - start) < GPS_PROBE_MS) {
+        uint16_t head = gps_rx_head();
+        while (gps_rx_tail != head) {
+            char c = gps_rx_buffer[gps_rx_tail];
+            if (++gps_rx_tail >= GPS_BUFFER_SIZE) gps_rx_tail = 0;
+            if (gps_nmea_collect(c) && gps_validate_checksum(nmea_sentence)) {
+                return 1;
+            }
+        }
+        // Wrong rate: overruns until the error interrupt is enabled
+        if (U3STAbits.OERR) {
+            gps_oerr_count++;
+            U3STAbits.OERR = 0;
+        }
+    }
+    return 0;
+}
+
+void gps_negotiate(void) {
+    static const uint32_t bauds[] = GPS_PROBE_BAUDS;
+    uint32_t start = now_ms();
+    uint8_t found = 0;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+        gps_uart_set_baud(bauds[i]);
+        found = gps_probe();
+        if (found) break;
+    }
+
+    if (!found) {
+        gps_uart_set_baud(GPS_DEFAULT_BAUD);
+        gps_link.first_sentence_ms = 0;
+        DEBUG_LOG_FLUSH("GPS: no NMEA receiver found, staying at 9600 baud\r\n");
+        return;
+    }
+    gps_link.first_sentence_ms = (uint16_t)(now_ms() - start);
+
+    // Keep GGA + RMC only
+    for (i = 0; i < sizeof(gps_prune_cmds) / sizeof(gps_prune_cmds[0]); i++) {
+        gps_send_nmea(gps_prune_cmds[i]);
+    }
+    gps_link.pruned = 1;
+
+    // Optional rate change, kept only if the receiver answers at the new rate
+    uint32_t detected = gps_link.baud;
+    if (detected != (uint32_t)GPS_NMEA_BAUD) {
+        for (i = 0; i < sizeof(gps_baud_cmds) / sizeof(gps_baud_cmds[0]); i++) {
+            gps_send_nmea(gps_baud_cmds[i]);
+        }
+        gps_uart_set_baud(GPS_NMEA_BAUD);
+        if (!gps_probe()) {
+            gps_uart_set_baud(detected);
+            DEBUG_LOG_FLUSH("GPS: baud change refused, ");
+        }
+    }
+
+    DEBUG_LOG_FLUSH("GPS: receiver at ");
+    debug_print_uint32(detected);
+    DEBUG_LOG_FLUSH(" baud, first sentence after ");
+    debug_print_uint16(gps_link.first_sentence_ms);
+    DEBUG_LOG_FLUSH(" ms, output pruned to GGA/RMC\r\n");
 }
 
+const gps_link_stats_t* gps_get_link_stats(void) {
+    return &gps_link;
+}
+
+// =============================
+// GPS Status Functions
+// =============================
 uint8_t gps_has_fix(void) {
-    return (gps_data.position_valid && gps_data.fix_quality > 0);
+    gps_position_t pos;
+    gps_position_read(&pos);
+    return (pos.position_valid && pos.fix_quality > 0);
 }
 
 void gps_print_status(void) {
+    gps_position_t pos;
+    gps_position_read(&pos);
+
     DEBUG_LOG_FLUSH("\r\n=== GPS Status ===\r\n");
 
     DEBUG_LOG_FLUSH("Fix: ");
-    if (gps_data.position_valid) {
+    if (pos.position_valid) {
         DEBUG_LOG_FLUSH("VALID (quality: ");
-        debug_print_uint16(gps_data.fix_quality);
+        debug_print_uint16(pos.fix_quality);
         DEBUG_LOG_FLUSH(")\r\n");
     } else {
         DEBUG_LOG_FLUSH("INVALID\r\n");
     }
 
     DEBUG_LOG_FLUSH("Satellites: ");
-    debug_print_uint16(gps_data.satellites);
+    debug_print_uint16(pos.satellites);
     DEBUG_LOG_FLUSH("\r\n");
 
     DEBUG_LOG_FLUSH("Position: ");
-    debug_print_float(gps_data.latitude, 6);
+    debug_print_float(pos.lat_e7 / (double)GPS_E7_PER_DEG, 6);
     DEBUG_LOG_FLUSH(", ");
-    debug_print_float(gps_data.longitude, 6);
+    debug_print_float(pos.lon_e7 / (double)GPS_E7_PER_DEG, 6);
     DEBUG_LOG_FLUSH("\r\n");
 
     DEBUG_LOG_FLUSH("Altitude: ");
-    debug_print_float(gps_data.altitude, 1);
+    debug_print_float(pos.alt_mm / 1000.0, 1);
     DEBUG_LOG_FLUSH(" m\r\n");
 
     DEBUG_LOG_FLUSH("HDOP: ");
-    debug_print_uint16(gps_data.hdop_x10 / 10);
+    debug_print_uint16(pos.hdop_x10 / 10);
     DEBUG_LOG_FLUSH(".");
-    debug_print_uint16(gps_data.hdop_x10 % 10);
+    debug_print_uint16(pos.hdop_x10 % 10);
     DEBUG_LOG_FLUSH("\r\n");
 
-    uint32_t current_time;
-    __builtin_disable_interrupts();
-    current_time = millis_counter;
-    __builtin_enable_interrupts();
-
-    uint32_t age_ms = current_time - gps_data.last_update_ms;
+    uint32_t age_ms = now_ms() - pos.last_update_ms;
     DEBUG_LOG_FLUSH("Last update: ");
     debug_print_uint32(age_ms);
     DEBUG_LOG_FLUSH(" ms ago\r\n");
 
+    DEBUG_LOG_FLUSH("UTC: ");
+    debug_print_uint32(pos.utc_ms / 1000UL);
+    DEBUG_LOG_FLUSH(" s of day\r\n");
+
+#if GPS_USE_UBX
+    const gps_ubx_stats_t *ubx = gps_ubx_get_stats();
+    DEBUG_LOG_FLUSH("UBX: NAV-PVT ");
+    debug_print_uint16(ubx->frames);
+    DEBUG_LOG_FLUSH(", checksum errors ");
+    debug_print_uint16(ubx->ck_errors);
+    DEBUG_LOG_FLUSH(", skipped ");
+    debug_print_uint16(ubx->skipped);
+    DEBUG_LOG_FLUSH("\r\n");
+#endif
+
+    DEBUG_LOG_FLUSH("Link: ");
+    debug_print_uint32(gps_link.baud);
+    DEBUG_LOG_FLUSH(" baud, ");
+    debug_print_uint16(gps_link.bytes_per_s);
+    DEBUG_LOG_FLUSH(" B/s, ");
+    debug_print_uint16(gps_link.sentences_per_s);
+    DEBUG_LOG_FLUSH(" sentences/s, first sentence ");
+    debug_print_uint16(gps_link.first_sentence_ms);
+    DEBUG_LOG_FLUSH(gps_link.pruned ? " ms, pruned\r\n" : " ms\r\n");
+
+    DEBUG_LOG_FLUSH("UART3: rx ");
+    debug_print_uint16(gps_rx_count);
+    DEBUG_LOG_FLUSH(", overrun ");
+    debug_print_uint16(gps_oerr_count);
+    DEBUG_LOG_FLUSH(", framing ");
+    debug_print_uint16(gps_ferr_count);
+    DEBUG_LOG_FLUSH("\r\n");
+
     DEBUG_LOG_FLUSH("==================\r\n\r\n");
 }
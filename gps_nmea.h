@@ -10,8 +10,45 @@
 // Hardware: UART3 on RC4 (U3TX/RP52) and RC5 (U3RX/RP53)
 // Baud rate: 9600 baud (standard NMEA)
 #define GPS_NMEA_MAX_LENGTH     82      // Maximum NMEA sentence length
-#define GPS_BUFFER_SIZE         96      // RX buffer size
+#define GPS_BUFFER_SIZE         256     // DMA RX ring (266 ms of data at 9600 baud)
+#define GPS_ERR_IRQ_PRIO        4       // UART3 error interrupt (below Timer1 and DMA0)
+
+// UART3 RX is moved to memory by DMA1 (DMA0 = MCP4922 stream), one byte per
+// receive event, destination incremented and reloaded at the end of the ring.
+// CHSEL value from the device DMA trigger source table
+#ifndef GPS_DMA_TRIGGER
+#define GPS_DMA_TRIGGER         0x0F    // DMAINTx CHSEL: UART3 receiver
+#endif
 #define GPS_FIX_TIMEOUT_MS      2000    // GPS update timeout
+#define GPS_DAY_MS              86400000L
+
+// Startup negotiation (NMEA mode): find the receiver baud rate, keep only
+// GGA (every fix) and RMC (every GPS_RMC_DIVIDER fixes), optionally move
+// to GPS_NMEA_BAUD. Commands are sent for u-blox (PUBX) and MediaTek (PMTK);
+// a receiver ignores the other vendor's sentences.
+#ifndef GPS_NEGOTIATE
+#define GPS_NEGOTIATE           1
+#endif
+#ifndef GPS_NMEA_BAUD
+#define GPS_NMEA_BAUD           9600    // 9600 = stay, 38400 / 115200 = switch
+#endif
+#define GPS_DEFAULT_BAUD        9600UL
+#define GPS_RMC_DIVIDER         5       // RMC once every 5 fixes (PMTK314 max 5)
+#define GPS_PROBE_MS            1100    // Per baud rate: receivers talk at >= 1 Hz
+#define GPS_PROBE_BAUDS         { 9600UL, 38400UL, 115200UL, 4800UL, 57600UL, 19200UL }
+
+typedef struct {
+    uint32_t baud;              // Current UART3 baud rate
+    uint16_t first_sentence_ms; // gps_init() to first valid sentence, 0 = none
+    uint16_t bytes_per_s;       // Received bytes, last 1 s window
+    uint16_t sentences_per_s;   // Complete sentences, last 1 s window
+    uint8_t pruned;             // Pruning commands sent to the receiver
+} gps_link_stats_t;
+
+// Sentence types handled by gps_update()
+#define GPS_SENTENCE_OTHER      0
+#define GPS_SENTENCE_GGA        1
+#define GPS_SENTENCE_RMC        2
 
 // GPS Fix Quality
 #define GPS_FIX_INVALID         0
@@ -19,25 +56,25 @@
 #define GPS_FIX_DGPS            2
 
 // =============================
-// GPS Data Structure
+// Shared GPS Position Record (seqlock)
 // =============================
+// One record written by the parser and read by frame builders, status
+// and debug output. seq is odd while a write is in progress; a reader
+// copies the record and retries until it saw the same even seq before and
+// after the copy. Nobody masks interrupts. Readers that can preempt the
+// writer (ISR) must use gps_position_try_read() and not spin.
 typedef struct {
-    // Position
-    double latitude;            // Decimal degrees (-90 to +90)
-    double longitude;           // Decimal degrees (-180 to +180)
-    double altitude;            // Meters above sea level
-
-    // Fix quality
+    uint16_t seq;               // Write sequence (odd = write in progress)
+    int32_t lat_e7;             // Latitude, 1e-7 degree (-90 to +90)
+    int32_t lon_e7;             // Longitude, 1e-7 degree (-180 to +180)
+    int32_t alt_mm;             // Altitude above mean sea level, mm
+    uint32_t last_update_ms;    // now_ms() of the last update
+    uint32_t utc_ms;            // UTC time of day of the last solution, ms
+    uint16_t hdop_x10;          // HDOP * 10 (ex: 12 = 1.2)
     uint8_t fix_quality;        // 0=invalid, 1=GPS, 2=DGPS
     uint8_t satellites;         // Number of satellites in use
-
-    // Status
-    uint8_t position_valid;     // 1 if position is valid
-    uint32_t last_update_ms;    // Timestamp of last GPS update
-
-    // HDOP
-    uint16_t hdop_x10;          // HDOP * 10 (ex: 12 = 1.2)
-} gps_data_t;
+    uint8_t position_valid;     // 1 once a receiver fix has been stored
+} gps_position_t;
 
 // =============================
 // Function Prototypes
@@ -55,9 +92,32 @@ void gps_init(void);
 uint8_t gps_update(void);
 
 /**
- * Get current GPS data
+ * UART3 transmit (blocking, waits for the last stop bit) and baud rate
+ */
+void gps_uart_write(const uint8_t *data, uint16_t length);
+void gps_uart_set_baud(uint32_t baud);
+
+/**
+ * Startup negotiation (baud detection, output pruning), called by gps_init()
+ */
+void gps_negotiate(void);
+const gps_link_stats_t* gps_get_link_stats(void);
+
+/**
+ * Store a new position record (single writer: main loop)
+ */
+void gps_position_publish(const gps_position_t *pos);
+
+/**
+ * Consistent snapshot of the position record, one attempt.
+ * Returns 0 if a write was in progress (snapshot unusable)
+ */
+uint8_t gps_position_try_read(gps_position_t *pos);
+
+/**
+ * Consistent snapshot of the position record, retries until it gets one
  */
-const gps_data_t* gps_get_data(void);
+void gps_position_read(gps_position_t *pos);
 
 /**
  * Check if GPS has valid fix
@@ -87,10 +147,9 @@ uint8_t gps_validate_checksum(const char *sentence);
 // =============================
 // Global Variables
 // =============================
-extern gps_data_t gps_data;
-extern volatile uint8_t gps_rx_buffer[GPS_BUFFER_SIZE];
-extern volatile uint8_t gps_rx_head;
-extern volatile uint8_t gps_rx_tail;
 extern volatile uint8_t gps_debug_raw;  // 0=off, 1=print raw NMEA sentences
+extern volatile uint16_t gps_rx_count;  // Bytes taken from the DMA ring
+extern volatile uint16_t gps_oerr_count; // UART3 receive overruns
+extern volatile uint16_t gps_ferr_count; // UART3 framing errors
 
 #endif // GPS_NMEA_H
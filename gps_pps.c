@@ -0,0 +1,175 @@
+// gps_pps.c - GPS PPS Disciplined Timebase (SCCP2 input capture)
+//
+// The CPU runs from the FRC (FNOSC = FRC), whose frequency error is far
+// above the T.001 timing tolerances. The GPS PPS edge is captured by SCCP2
+// against FCY; the cycle count between two edges is the true FCY. Once it is
+// consistent for GPS_PPS_LOCK_COUNT seconds the SCCP3 timebase (now_us) and
+// optionally the Timer1 period (400 bps bit rate) are corrected through
+// timebase_set_fcy() and timer1_set_fcy(). The last correction is kept when PPS
+// disappears (holdover).
+
+#include "includes.h"
+#include "gps_pps.h"
+#include "system_comms.h"
+#include "system_debug.h"
+
+// ISR -> main loop
+static volatile uint32_t pps_capture_last;
+static volatile uint32_t pps_delta;             // Cycles between the last two edges
+static volatile uint32_t pps_edge_ms;           // now_ms() at the last edge
+static volatile uint8_t pps_have_last = 0;
+static volatile uint8_t pps_new = 0;
+
+// Main loop state
+static uint8_t pps_state = GPS_PPS_NONE;
+static uint8_t pps_consistent = 0;
+static int32_t pps_err_q8 = 0;                  // Filtered (delta - FCY), 1/256 cycle
+static uint32_t pps_fcy = FCY;                  // FCY given to the timebase
+static uint8_t pps_trim = 0;
+static uint16_t pps_edges = 0;
+static uint16_t pps_rejected = 0;
+
+void gps_pps_init(void) {
+    TRISBbits.TRISB5 = 1;           // PPS input (ICM2R mapped in init_all_pps)
+
+    // SCCP2: input capture, every rising edge, 32-bit time base on FCY
+    CCP2CON1L = 0;
+    CCP2CON1H = 0;
+    CCP2CON2L = 0;
+    CCP2CON2H = 0;
+    CCP2CON1Lbits.CLKSEL = 0;       // FOSC/2 = FCY
+    CCP2CON1Lbits.TMRPS = 0;
+    CCP2CON1Lbits.T32 = 1;
+    CCP2CON1Lbits.CCSEL = 1;        // Input capture
+    CCP2CON1Lbits.MOD = 0b0001;     // Every rising edge
+    CCP2CON2Hbits.ICS = 0;          // ICM2 pin
+
+    _CCP2IP = GPS_PPS_IRQ_PRIO;
+    _CCP2IF = 0;
+    _CCP2IE = 1;
+    CCP2CON1Lbits.CCPON = 1;
+}
+
+// =============================
+// SCCP2 Capture Interrupt (PPS edge)
+// =============================
+void __attribute__((interrupt, auto_psv)) _CCP2Interrupt(void) {
+    while (CCP2STATLbits.ICBNE) {
+        uint16_t lo = CCP2BUFL;
+        uint32_t capture = ((uint32_t)CCP2BUFH << 16) | lo;     // BUFH read pops the FIFO
+
+        if (pps_have_last) {
+            pps_delta = capture - pps_capture_last;
+            pps_new = 1;
+        }
+        pps_capture_last = capture;
+        pps_have_last = 1;
+    }
+
+    pps_edge_ms = now_ms();
+
+    CCP2STATLbits.ICOV = 0;
+    _CCP2IF = 0;
+}
+
+// =============================
+// Discipline (main loop)
+// =============================
+static void pps_apply(void) {
+    pps_fcy = (uint32_t)((int32_t)FCY + ((pps_err_q8 + 128) >> 8));
+    timebase_set_fcy(pps_fcy);
+    timer1_set_fcy(pps_fcy, pps_trim);
+}
+
+// One PPS interval: filter, lock detection, timebase correction
+void gps_pps_poll(void) {
+    uint32_t delta, edge_ms, now;
+
+    __builtin_disable_interrupts();
+    uint8_t fresh = pps_new;
+    pps_new = 0;
+    delta = pps_delta;
+    edge_ms = pps_edge_ms;
+    __builtin_enable_interrupts();
+    now = now_ms();
+
+    if (!fresh) {
+        // Lost PPS: keep the last correction, restart acquisition on return
+        if ((pps_state == GPS_PPS_LOCKED || pps_state == GPS_PPS_ACQUIRING) &&
+            (now - edge_ms) > GPS_PPS_TIMEOUT_MS) {
+            pps_state = (pps_fcy != FCY) ? GPS_PPS_HOLDOVER : GPS_PPS_NONE;
+            if (pps_state == GPS_PPS_NONE) pps_err_q8 = 0;
+            pps_consistent = 0;
+            pps_have_last = 0;
+        }
+        return;
+    }
+
+    int32_t err = (int32_t)(delta - FCY);
+    if (err > (int32_t)GPS_PPS_MAX_ERR_CYCLES || err < -(int32_t)GPS_PPS_MAX_ERR_CYCLES) {
+        pps_rejected++;             // Missed or spurious edge
+        pps_consistent = 0;
+        return;
+    }
+    pps_edges++;
+
+    if (pps_state == GPS_PPS_NONE) {
+        pps_err_q8 = err << 8;      // First interval seeds the filter
+        pps_state = GPS_PPS_ACQUIRING;
+        return;
+    }
+
+    int32_t diff = (err << 8) - pps_err_q8;
+    if (diff > ((int32_t)GPS_PPS_LOCK_TOL_CYCLES << 8) || diff < -((int32_t)GPS_PPS_LOCK_TOL_CYCLES << 8)) {
+        // Step (PLL retune, first edge after holdover): restart from this second
+        pps_err_q8 = err << 8;
+        pps_consistent = 0;
+        if (pps_state == GPS_PPS_LOCKED) pps_state = GPS_PPS_ACQUIRING;
+        return;
+    }
+    pps_err_q8 += diff >> GPS_PPS_FILTER_LOG2;
+
+    if (pps_state != GPS_PPS_LOCKED) {
+        if (++pps_consistent < GPS_PPS_LOCK_COUNT) return;
+        pps_state = GPS_PPS_LOCKED;
+        DEBUG_LOG_FLUSH("PPS: locked\r\n");
+    }
+    pps_apply();
+}
+
+uint8_t gps_pps_get_state(void) {
+    return pps_state;
+}
+
+// FCY used by the timebase (nominal until the first lock, then last measured)
+uint32_t gps_pps_fcy_hz(void) {
+    return pps_fcy;
+}
+
+// Clock error, parts per billion (positive = CPU clock fast)
+int32_t gps_pps_error_ppb(void) {
+    return (int32_t)((int64_t)pps_err_q8 * 1000000000LL / ((int64_t)FCY << 8));
+}
+
+// Trim on: Timer1 period follows the measured FCY (fractional PR1), so the
+// sample and bit rates are exact too, not only now_us()
+void gps_pps_set_trim(uint8_t enable) {
+    pps_trim = enable ? 1 : 0;
+    timer1_set_fcy(pps_fcy, pps_trim);
+}
+
+void gps_pps_print_status(void) {
+    static const char * const names[] = { "NONE", "ACQUIRING", "LOCKED", "HOLDOVER" };
+
+    DEBUG_LOG_FLUSH("PPS: ");
+    DEBUG_LOG_FLUSH(names[pps_state]);
+    DEBUG_LOG_FLUSH(", FCY ");
+    debug_print_uint32(gps_pps_fcy_hz());
+    DEBUG_LOG_FLUSH(" Hz, error ");
+    debug_print_int32(gps_pps_error_ppb());
+    DEBUG_LOG_FLUSH(" ppb, edges ");
+    debug_print_uint16(pps_edges);
+    DEBUG_LOG_FLUSH(", rejected ");
+    debug_print_uint16(pps_rejected);
+    DEBUG_LOG_FLUSH(pps_trim ? ", Timer1 trim ON\r\n" : ", Timer1 trim OFF\r\n");
+}
@@ -0,0 +1,35 @@
+// gps_pps.h - GPS PPS Disciplined Timebase (SCCP2 input capture)
+
+#ifndef GPS_PPS_H
+#define GPS_PPS_H
+
+#include <stdint.h>
+
+// Hardware: GPS PPS on RB5 (RP37), SCCP2 input capture, 32-bit timer on FCY.
+// Each rising edge captures the cycle count; two edges one second apart give
+// the true FCY of the FRC/PLL clock.
+#define GPS_PPS_RP              37          // ICM2R input (RB5)
+#define GPS_PPS_IRQ_PRIO        5           // Below Timer1 (7) and DMA0 (6)
+#define GPS_PPS_MAX_ERR_CYCLES  (FCY / 50)  // Reject edges more than 2 % off
+#define GPS_PPS_FILTER_LOG2     3           // Error filter: 1/8 per second
+#define GPS_PPS_LOCK_COUNT      4           // Consecutive consistent seconds to lock
+#define GPS_PPS_LOCK_TOL_CYCLES 100         // 2 ppm: a second this far from the filter breaks lock
+#define GPS_PPS_TIMEOUT_MS      2500        // No edge: holdover
+
+typedef enum {
+    GPS_PPS_NONE = 0,           // No PPS seen, nominal FCY
+    GPS_PPS_ACQUIRING,          // Edges seen, not yet consistent
+    GPS_PPS_LOCKED,             // Timebase disciplined by PPS
+    GPS_PPS_HOLDOVER            // PPS lost, last correction kept
+} gps_pps_state_t;
+
+// Function prototypes
+void gps_pps_init(void);
+void gps_pps_poll(void);
+uint8_t gps_pps_get_state(void);
+int32_t gps_pps_error_ppb(void);
+uint32_t gps_pps_fcy_hz(void);
+void gps_pps_set_trim(uint8_t enable);
+void gps_pps_print_status(void);
+
+#endif /* GPS_PPS_H */
@@ -0,0 +1,216 @@
+// gps_ubx.c - u-blox UBX Binary Protocol (NAV-PVT fast path)
+//
+// In UBX mode the receiver sends only NAV-PVT (92-byte payload, one per
+// navigation epoch) at GPS_UBX_BAUD. The decoder is a byte state machine fed
+// from the DMA ring by gps_update(); a frame with a good Fletcher checksum
+// goes straight into the position record, no text, no float.
+
+#include "includes.h"
+#include "gps_ubx.h"
+#include "gps_nmea.h"
+#include "system_debug.h"
+
+typedef enum {
+    UBX_STATE_SYNC1 = 0,
+    UBX_STATE_SYNC2,
+    UBX_STATE_HEADER,           // class, id, length
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CK_A,
+    UBX_STATE_CK_B
+} ubx_state_t;
+
+static uint8_t ubx_state = UBX_STATE_SYNC1;
+static uint8_t ubx_header[4];
+static uint8_t ubx_payload[UBX_MAX_PAYLOAD];
+static uint16_t ubx_length;
+static uint16_t ubx_index;
+static uint8_t ubx_ck_a, ubx_ck_b;
+static gps_ubx_stats_t ubx_stats;
+
+// =============================
+// Configuration (u-blox M8 legacy CFG messages)
+// =============================
+// CFG-PRT UART1: 8N1, in UBX+NMEA, out UBX only, GPS_UBX_BAUD
+static const uint8_t ubx_cfg_prt[20] = {
+    0x01, 0x00, 0x00, 0x00,                         // portID 1, reserved, txReady off
+    0xC0, 0x08, 0x00, 0x00,                         // mode: 8 bits, no parity, 1 stop
+    (uint8_t)GPS_UBX_BAUD, (uint8_t)(GPS_UBX_BAUD >> 8),
+    (uint8_t)(GPS_UBX_BAUD >> 16), (uint8_t)(GPS_UBX_BAUD >> 24),
+    0x03, 0x00,                                     // inProtoMask: UBX + NMEA
+    0x01, 0x00,                                     // outProtoMask: UBX
+    0x00, 0x00, 0x00, 0x00                          // flags, reserved
+};
+
+// CFG-RATE: measurement period, 1 cycle per solution, GPS time
+static const uint8_t ubx_cfg_rate[6] = {
+    (uint8_t)GPS_UBX_RATE_MS, (uint8_t)(GPS_UBX_RATE_MS >> 8), 0x01, 0x00, 0x01, 0x00
+};
+
+// CFG-MSG: NAV-PVT once per solution on the current port
+static const uint8_t ubx_cfg_msg_pvt[3] = { UBX_CLASS_NAV, UBX_ID_NAV_PVT, 0x01 };
+
+void gps_ubx_checksum(const uint8_t *data, uint16_t length, uint8_t *ck_a, uint8_t *ck_b) {
+    uint8_t a = 0, b = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        a += data[i];
+        b += a;
+    }
+    *ck_a = a;
+    *ck_b = b;
+}
+
+static void ubx_send(uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t length) {
+    uint8_t frame[UBX_HEADER_BYTES + 20 + 2];
+    uint8_t ck_a, ck_b;
+
+    frame[0] = UBX_SYNC1;
+    frame[1] = UBX_SYNC2;
+    frame[2] = cls;
+    frame[3] = id;
+    frame[4] = (uint8_t)length;
+    frame[5] = (uint8_t)(length >> 8);
+    memcpy(&frame[UBX_HEADER_BYTES], payload, length);
+    gps_ubx_checksum(&frame[2], length + 4, &ck_a, &ck_b);
+    frame[UBX_HEADER_BYTES + length] = ck_a;
+    frame[UBX_HEADER_BYTES + length + 1] = ck_b;
+    gps_uart_write(frame, UBX_HEADER_BYTES + length + 2);
+}
+
+// NMEA factory default at 9600 baud: enable NAV-PVT, set the rate, then
+// switch the port to UBX output at GPS_UBX_BAUD (CFG-PRT last, it changes the
+// baud rate). Sent again at GPS_UBX_BAUD for a receiver already configured
+// (MCU reset without GPS power cycle). Not saved to receiver flash.
+void gps_ubx_configure(void) {
+    static const uint32_t bauds[2] = { 9600UL, GPS_UBX_BAUD };
+
+    for (uint8_t i = 0; i < 2; i++) {
+        gps_uart_set_baud(bauds[i]);
+        ubx_send(UBX_CLASS_CFG, UBX_ID_CFG_MSG, ubx_cfg_msg_pvt, sizeof(ubx_cfg_msg_pvt));
+        ubx_send(UBX_CLASS_CFG, UBX_ID_CFG_RATE, ubx_cfg_rate, sizeof(ubx_cfg_rate));
+        ubx_send(UBX_CLASS_CFG, UBX_ID_CFG_PRT, ubx_cfg_prt, sizeof(ubx_cfg_prt));
+    }
+    gps_ubx_reset();
+
+    DEBUG_LOG_FLUSH("GPS: UBX NAV-PVT mode at ");
+    debug_print_uint32(GPS_UBX_BAUD);
+    DEBUG_LOG_FLUSH(" baud\r\n");
+}
+
+void gps_ubx_reset(void) {
+    ubx_state = UBX_STATE_SYNC1;
+    memset(&ubx_stats, 0, sizeof(ubx_stats));
+}
+
+const gps_ubx_stats_t* gps_ubx_get_stats(void) {
+    return &ubx_stats;
+}
+
+// =============================
+// NAV-PVT Decoder
+// =============================
+static uint16_t ubx_u16(const uint8_t *p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static int32_t ubx_i32(const uint8_t *p) {
+    return (int32_t)((uint32_t)ubx_u16(p) | ((uint32_t)ubx_u16(p + 2) << 16));
+}
+
+static void ubx_store_pvt(const uint8_t *pvt) {
+    gps_position_t pos;
+    uint8_t fix_type = pvt[UBX_PVT_FIX_TYPE];
+    uint8_t flags = pvt[UBX_PVT_FLAGS];
+
+    gps_position_read(&pos);
+    pos.satellites = pvt[UBX_PVT_NUM_SV];
+    pos.hdop_x10 = ubx_u16(&pvt[UBX_PVT_PDOP]) / 10;   // PDOP: NAV-PVT has no HDOP
+
+    if (pvt[UBX_PVT_VALID] & 0x02) {
+        // nano is signed: hh:mm:ss is rounded, the exact epoch can be just before
+        int32_t ms = (int32_t)((uint32_t)pvt[UBX_PVT_HOUR] * 3600UL + (uint16_t)pvt[UBX_PVT_MIN] * 60U +
+                               pvt[UBX_PVT_SEC]) * 1000L + ubx_i32(&pvt[UBX_PVT_NANO]) / 1000000L;
+        if (ms < 0) ms += GPS_DAY_MS;
+        pos.utc_ms = (uint32_t)ms;
+    }
+
+    // 2D/3D/GNSS+DR with gnssFixOK; anything else keeps the last position
+    if ((flags & 0x01) && fix_type >= 2 && fix_type <= 4) {
+        pos.lat_e7 = ubx_i32(&pvt[UBX_PVT_LAT]);
+        pos.lon_e7 = ubx_i32(&pvt[UBX_PVT_LON]);
+        pos.alt_mm = ubx_i32(&pvt[UBX_PVT_HMSL]);
+        pos.fix_quality = (flags & 0x02) ? GPS_FIX_DGPS : GPS_FIX_GPS;
+        pos.position_valid = 1;
+        pos.last_update_ms = now_ms();
+    } else {
+        pos.fix_quality = GPS_FIX_INVALID;
+    }
+    gps_position_publish(&pos);
+}
+
+// One received byte. Returns 1 when a NAV-PVT frame was stored.
+uint8_t gps_ubx_input(uint8_t byte) {
+    switch (ubx_state) {
+        case UBX_STATE_SYNC1:
+            if (byte == UBX_SYNC1) ubx_state = UBX_STATE_SYNC2;
+            break;
+
+        case UBX_STATE_SYNC2:
+            if (byte == UBX_SYNC2) {
+                ubx_ck_a = ubx_ck_b = 0;
+                ubx_index = 0;
+                ubx_state = UBX_STATE_HEADER;
+            } else {
+                ubx_state = (byte == UBX_SYNC1) ? UBX_STATE_SYNC2 : UBX_STATE_SYNC1;
+            }
+            break;
+
+        case UBX_STATE_HEADER:
+            ubx_ck_a += byte;
+            ubx_ck_b += ubx_ck_a;
+            ubx_header[ubx_index++] = byte;
+            if (ubx_index == 4) {
+                ubx_length = ubx_u16(&ubx_header[2]);
+                ubx_index = 0;
+                ubx_state = ubx_length ? UBX_STATE_PAYLOAD : UBX_STATE_CK_A;
+                if (ubx_length > UBX_MAX_PAYLOAD) {
+                    // Only NAV-PVT is enabled: a longer length is noise, resync now
+                    ubx_stats.skipped++;
+                    ubx_state = UBX_STATE_SYNC1;
+                }
+            }
+            break;
+
+        case UBX_STATE_PAYLOAD:
+            ubx_ck_a += byte;
+            ubx_ck_b += ubx_ck_a;
+            ubx_payload[ubx_index] = byte;
+            if (++ubx_index == ubx_length) ubx_state = UBX_STATE_CK_A;
+            break;
+
+        case UBX_STATE_CK_A:
+            if (byte == ubx_ck_a) {
+                ubx_state = UBX_STATE_CK_B;
+            } else {
+                ubx_stats.ck_errors++;
+                ubx_state = (byte == UBX_SYNC1) ? UBX_STATE_SYNC2 : UBX_STATE_SYNC1;
+            }
+            break;
+
+        case UBX_STATE_CK_B:
+            ubx_state = UBX_STATE_SYNC1;
+            if (byte != ubx_ck_b) {
+                ubx_stats.ck_errors++;
+                if (byte == UBX_SYNC1) ubx_state = UBX_STATE_SYNC2;
+                break;
+            }
+            if (ubx_header[0] == UBX_CLASS_NAV && ubx_header[1] == UBX_ID_NAV_PVT &&
+                ubx_length == UBX_NAV_PVT_LEN) {
+                ubx_store_pvt(ubx_payload);
+                ubx_stats.frames++;
+                return 1;
+            }
+            ubx_stats.skipped++;        // ACK/NAK of the CFG messages, others
+            break;
+    }
+    return 0;
+}
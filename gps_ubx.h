@@ -0,0 +1,58 @@
+// gps_ubx.h - u-blox UBX Binary Protocol (NAV-PVT fast path)
+
+#ifndef GPS_UBX_H
+#define GPS_UBX_H
+
+#include <stdint.h>
+
+// Build option: 1 = receiver switched to UBX NAV-PVT at gps_init() (u-blox
+// M8 legacy CFG messages), 0 = NMEA GGA/RMC at 9600 baud
+#ifndef GPS_USE_UBX
+#define GPS_USE_UBX             0
+#endif
+
+#define GPS_UBX_BAUD            38400UL     // UART3 baud rate in UBX mode
+#define GPS_UBX_RATE_MS         1000        // Navigation (NAV-PVT) period
+
+// Frame: B5 62 class id len(LE16) payload ck_a ck_b, Fletcher-8 over class..payload
+#define UBX_SYNC1               0xB5
+#define UBX_SYNC2               0x62
+#define UBX_HEADER_BYTES        6
+#define UBX_CLASS_NAV           0x01
+#define UBX_CLASS_ACK           0x05
+#define UBX_CLASS_CFG           0x06
+#define UBX_ID_NAV_PVT          0x07
+#define UBX_ID_CFG_PRT          0x00
+#define UBX_ID_CFG_MSG          0x01
+#define UBX_ID_CFG_RATE         0x08
+#define UBX_NAV_PVT_LEN         92
+#define UBX_MAX_PAYLOAD         UBX_NAV_PVT_LEN     // Longer lengths: resync
+
+// NAV-PVT payload offsets (little endian)
+#define UBX_PVT_HOUR            8
+#define UBX_PVT_MIN             9
+#define UBX_PVT_SEC             10
+#define UBX_PVT_VALID           11          // bit 1: validTime
+#define UBX_PVT_NANO            16          // i4, -1e9..1e9
+#define UBX_PVT_FIX_TYPE        20          // 0 none, 2 2D, 3 3D, 4 GNSS+DR
+#define UBX_PVT_FLAGS           21          // bit 0: gnssFixOK, bit 1: diffSoln
+#define UBX_PVT_NUM_SV          23
+#define UBX_PVT_LON             24          // i4, 1e-7 degree
+#define UBX_PVT_LAT             28          // i4, 1e-7 degree
+#define UBX_PVT_HMSL            36          // i4, mm above mean sea level
+#define UBX_PVT_PDOP            76          // u2, 0.01
+
+typedef struct {
+    uint16_t frames;            // NAV-PVT frames stored
+    uint16_t ck_errors;         // Fletcher checksum mismatches
+    uint16_t skipped;           // Other or oversized messages
+} gps_ubx_stats_t;
+
+// Function prototypes
+void gps_ubx_configure(void);
+void gps_ubx_reset(void);
+uint8_t gps_ubx_input(uint8_t byte);
+const gps_ubx_stats_t* gps_ubx_get_stats(void);
+void gps_ubx_checksum(const uint8_t *data, uint16_t length, uint8_t *ck_a, uint8_t *ck_b);
+
+#endif /* GPS_UBX_H */
@@ -7,20 +7,18 @@
 #include "spi2_test.h"      // Test de compatibilité SPI2
 #include "drivers/mcp4922_driver.h"  // Driver MCP4922
 #include "gps_nmea.h"       // GPS NMEA support
+#include "gps_pps.h"        // GPS PPS timebase
+#include "tx_scheduler.h"   // Randomized repetition slots
+#include "vbeacon.h"        // Virtual beacons (load testing)
 
 // Declarations externes
-extern volatile uint32_t millis_counter;
 extern volatile tx_phase_t tx_phase;
 extern volatile uint8_t beacon_frame[];
 
-// Declaration de la fonction start_beacon_frame
-void start_beacon_frame(beacon_frame_type_t frame_type);
-
 // Declarations for new RF control functions
 extern void rf_start_transmission(void);
 extern void rf_stop_transmission(void);
 extern void rf_adf4351_enable_chip(uint8_t state);
-extern const uint32_t adf4351_regs_403mhz[];
 
 // Lecture du switch de sélection mode
 beacon_frame_type_t get_frame_type_from_switch(void) {
@@ -32,25 +30,16 @@ beacon_frame_type_t get_frame_type_from_switch(void) {
     //return BEACON_EXERCISE_FRAME;
 }
 
-uint8_t should_transmit_beacon(void) {
-    uint8_t phase;
-    uint32_t current_millis, last_tx;
-    
-    // Lecture atomique des variables partag�es
-    __builtin_disable_interrupts();
-    phase = tx_phase;
-    current_millis = millis_counter;
-    last_tx = last_tx_time;
-    __builtin_enable_interrupts();
-
-    return (phase == IDLE_STATE) && 
-           ((current_millis - last_tx) >= tx_interval_ms);
+// Lecture du switch de sélection fréquence
+adf4351_channel_t get_channel_from_switch(void) {
+    // RB1 = 0 (pull-down) → 403.040 MHz test channel
+    // RB1 = 1 (switch pressed) → 406.040 MHz T.001 channel
+    return RF_FREQ_SELECT_PIN ? ADF4351_CH_406_040 : ADF4351_CH_403_040_TEST;
 }
 
 int main(void) {
 	__builtin_disable_interrupts();
     system_init();
-    //set_tx_interval(5000);  // Initial interval (will be adjusted by frame type)
     __builtin_enable_interrupts();
 
     __delay_ms(4000);
@@ -71,6 +60,7 @@ int main(void) {
 
     // Initialize RF modules
     rf_initialize_all_modules();
+    rf_adf4351_set_channel(get_channel_from_switch());
     DEBUG_LOG_FLUSH("RF modules init completed\r\n");
 
     // Test de compatibilité SPI2 (logiciel uniquement)
@@ -92,24 +82,19 @@ int main(void) {
     DEBUG_LOG_FLUSH("MCP4922 pattern test completed\r\n");
 
     rf_set_power_level(RF_POWER_LOW);
-    
-    beacon_frame_type_t frame_type = get_frame_type_from_switch();
-    DEBUG_LOG_FLUSH("Starting transmission - Mode: ");
-    DEBUG_LOG_FLUSH(frame_type == BEACON_TEST_FRAME ? "TEST\r\n" : "EXERCISE\r\n");
-    start_beacon_frame(frame_type);  // Generate according to switch
+    // First burst: the boot slot is past, the scheduler prepares one now
 
     while(1) {
 		process_uart_commands();  // Handle commands
 
-        uint32_t current_time;
-        __builtin_disable_interrupts();
-        current_time = millis_counter;
-        __builtin_enable_interrupts();
+        uint32_t current_time = now_ms();
 
         // Process GPS data
         if (gps_update()) {
             // New GPS data received - frame will be rebuilt at next transmission
+            vbeacon_gps_updated();
         }
+        gps_pps_poll();
 
         // Transfert des logs UART
         while (isr_log_tail != isr_log_head) {
@@ -118,21 +103,37 @@ int main(void) {
             isr_log_tail = (isr_log_tail + 1) % ISR_LOG_BUF_SIZE;
         }
 
-        // Periodic transmission trigger (read switch each time)
-        if (should_transmit_beacon()) {
-            beacon_frame_type_t current_frame_type = get_frame_type_from_switch();
+        // Virtual beacon scheduler replaces the periodic trigger while running
+        if (vbeacon_is_running()) {
+            vbeacon_poll();
+        }
+        // Periodic transmission: channel and frame ahead of the slot (read
+        // switches each time), burst started on it
+        else {
+            switch (tx_sched_poll(current_time)) {
+                case TX_SCHED_PREPARE: {
+                    beacon_frame_type_t current_frame_type = get_frame_type_from_switch();
+                    rf_adf4351_set_channel(get_channel_from_switch());
+
+                    // Print GPS status if available (simplified to avoid timing issues)
+                    if (gps_has_fix()) {
+                        gps_position_t gps;
+                        gps_position_read(&gps);
+                        DEBUG_LOG_FLUSH("GPS Fix: ");
+                        debug_print_uint16(gps.satellites);
+                        DEBUG_LOG_FLUSH(" sats\r\n");
+                    }
 
-            // Print GPS status if available (simplified to avoid timing issues)
-            if (gps_has_fix()) {
-                const gps_data_t *gps = gps_get_data();
-                DEBUG_LOG_FLUSH("GPS Fix: ");
-                debug_print_uint16(gps->satellites);
-                DEBUG_LOG_FLUSH(" sats\r\n");
-            }
+                    DEBUG_LOG_FLUSH("Preparing periodic transmission - Mode: ");
+                    DEBUG_LOG_FLUSH(current_frame_type == BEACON_TEST_FRAME ? "TEST\r\n" : "EXERCISE\r\n");
+                    prepare_beacon_frame(current_frame_type);
+                    break;
+                }
 
-            DEBUG_LOG_FLUSH("Starting periodic transmission - Mode: ");
-            DEBUG_LOG_FLUSH(current_frame_type == BEACON_TEST_FRAME ? "TEST\r\n" : "EXERCISE\r\n");
-            start_beacon_frame(current_frame_type);
+                case TX_SCHED_FIRE:
+                    transmit_beacon_frame(tx_sched_slot_ms());
+                    break;
+            }
         }
         
         // Periodic status report
@@ -142,14 +143,11 @@ int main(void) {
             DEBUG_LOG_FLUSH("Status: phase=");
             debug_print_uint16(tx_phase);
             DEBUG_LOG_FLUSH(" gps_rx=");
-            extern volatile uint16_t gps_rx_count;
             debug_print_uint16(gps_rx_count);
-            DEBUG_LOG_FLUSH(" gps_irq=");
-            extern volatile uint16_t gps_irq_count;
-            debug_print_uint16(gps_irq_count);
             DEBUG_LOG_FLUSH(" gps_oerr=");
-            extern volatile uint16_t gps_oerr_count;
             debug_print_uint16(gps_oerr_count);
+            DEBUG_LOG_FLUSH(" gps_ferr=");
+            debug_print_uint16(gps_ferr_count);
             DEBUG_LOG_FLUSH("\r\n");
         }
         
@@ -176,10 +174,7 @@ int main(void) {
                     __delay_ms(10);              // Power-up delay
 
                     // Reprogram all registers
-                    for(int i = 0; i < 6; i++) {
-                        adf4351_write_register(adf4351_regs_403mhz[i]);
-                        __delay_ms(2);
-                    }
+                    rf_adf4351_program_registers();
                     __delay_ms(50);  // Extra settling time
                     
                     // Check if recovery successful
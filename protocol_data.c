@@ -4,6 +4,11 @@
 #include "system_debug.h"
 #include "protocol_data.h"
 #include "rf_interface.h"
+#include "config_store.h"
+#include "protocol_layout.h"
+#include "drivers/crc_engine.h"
+#include "gps_nmea.h"
+#include "tx_scheduler.h"
 
 // Declarations for RF control functions
 extern void rf_start_transmission(void);
@@ -18,9 +23,6 @@ extern void rf_stop_transmission(void);
 // =============================
 uint8_t frame[MESSAGE_BITS];
 volatile uint8_t gps_updated = 0;
-volatile double current_latitude = TEST_LATITUDE;
-volatile double current_longitude = TEST_LONGITUDE;
-volatile double current_altitude = TEST_ALTITUDE;
 uint8_t beacon_mode = BEACON_MODE_EXERCISE;
 
 // =============================
@@ -49,13 +51,37 @@ uint32_t compute_bch(uint64_t data, int num_bits, uint32_t poly, int poly_degree
     return reg;
 }
 
+// Same remainder on the CRC module: data.x^degree (the padding zeros of
+// compute_bch()) right-aligned in 32-bit words, MSB first; leading zero
+// words are skipped. Returns 0 if the module did not complete.
+uint8_t compute_bch_crc(uint64_t data, int num_bits, uint32_t poly, int poly_degree, uint32_t *bch) {
+    uint32_t words[3];
+    uint8_t count = (uint8_t)((num_bits + poly_degree + 31) / 32);
+
+    if (num_bits > 64 || poly_degree < 1 || count > 3) return 0;
+    data &= (num_bits < 64) ? ((1ULL << num_bits) - 1) : ~0ULL;
+    words[0] = (uint32_t)(data >> (64 - poly_degree));         // bits 95..64
+    words[1] = (uint32_t)((data << poly_degree) >> 32);         // bits 63..32
+    words[2] = (uint32_t)(data << poly_degree);                 // bits 31..0
+
+    return crc_engine_remainder(poly, (uint8_t)poly_degree, &words[3 - count], count, bch);
+}
+
 // BCH-61 (PDF1)
 uint32_t compute_bch1(uint64_t data) {
+#if BCH_USE_CRC
+    uint32_t bch;
+    if (compute_bch_crc(data, BCH1_DATA_BITS, BCH1_POLY, BCH1_DEGREE, &bch)) return bch;
+#endif
     return compute_bch(data, BCH1_DATA_BITS, BCH1_POLY, BCH1_DEGREE, BCH1_POLY_MASK);
 }
 
 // BCH-26 (PDF2)
 uint16_t compute_bch2(uint32_t data) {
+#if BCH_USE_CRC
+    uint32_t bch;
+    if (compute_bch_crc((uint64_t)data, BCH2_DATA_BITS, BCH2_POLY, BCH2_DEGREE, &bch)) return (uint16_t)bch;
+#endif
     return (uint16_t)compute_bch((uint64_t)data, BCH2_DATA_BITS, BCH2_POLY, BCH2_DEGREE, BCH2_POLY_MASK);
 }
 
@@ -90,12 +116,22 @@ uint64_t get_bit_field_volatile(volatile const uint8_t *frame, uint16_t cs_start
 // =============================
 
 void set_gps_position(double lat, double lon, double alt) {
-    // Direct write - used only for TEST mode with fixed coordinates
-    // GPS parsing writes directly with atomic protection in gps_nmea.c
-    current_latitude = lat;
-    current_longitude = lon;
-    current_altitude = alt;
-    gps_updated = 1;
+    // Fixed coordinates (TEST mode, legacy parser): fix status is kept
+    gps_position_t pos;
+    gps_position_read(&pos);
+    pos.lat_e7 = gps_deg_to_e7(lat);
+    pos.lon_e7 = gps_deg_to_e7(lon);
+    pos.alt_mm = (int32_t)lround(alt * 1000.0);
+    gps_position_publish(&pos);
+}
+
+// Position fields of a frame from one consistent snapshot of the GPS record
+void frame_params_from_gps(beacon_frame_params_t *params) {
+    gps_position_t pos;
+    gps_position_read(&pos);
+    params->lat_e7 = pos.lat_e7;
+    params->lon_e7 = pos.lon_e7;
+    params->alt_m = pos.alt_mm / 1000;
 }
 
 // Fonction personnalisee de conversion chaa®ne -> float optimisee
@@ -293,34 +329,9 @@ uint32_t compute_30min_position(double lat, double lon) {
     return position;
 }
 
+// Double front end: one conversion to 1e-7 degree, integer encoder after that
 cs_gps_position_t encode_gps_position_complete(double lat, double lon) {
-    cs_gps_position_t result = {0};
-    
-    if(__builtin_fabs(lat) > 90.0 || __builtin_fabs(lon) > 180.0) {
-        return result;
-    }
-
-    uint32_t lat_units = (uint32_t)__builtin_round(__builtin_fabs(lat) * 900.0);
-    uint32_t lon_units = (uint32_t)__builtin_round(__builtin_fabs(lon) * 900.0);
-    lat_units &= 0x7FFFF;
-    lon_units &= 0x7FFFF;
-
-    uint64_t lat_encoded = ((uint64_t)lat_units << 1) | (lat < 0.0 ? 1ULL : 0ULL);
-    uint64_t lon_encoded = ((uint64_t)lon_units << 1) | (lon < 0.0 ? 1ULL : 0ULL);
-    result.full_position_40bit = (lat_encoded << 20) | lon_encoded;
-    result.coarse_position_21bit = (uint32_t)(result.full_position_40bit >> 19);
-    result.fine_position_19bit = compute_30min_position(lat, lon);
-    result.offset_position_18bit = compute_4sec_offset(lat, lon, result.fine_position_19bit);
-
-    if (!debug_flags.gps_encoding_printed) {
-        DEBUG_LOG_FLUSH("GPS FINE POS: 0x");
-         
-        debug_print_hex24(result.fine_position_19bit);
-        DEBUG_LOG_FLUSH("\r\n");
-        debug_flags.gps_encoding_printed = 1;
-    }
-    
-    return result;
+    return encode_gps_position_e7(gps_deg_to_e7(lat), gps_deg_to_e7(lon));
 }
 
 uint32_t compute_4sec_offset(double lat, double lon, uint32_t position_30min) {
@@ -392,8 +403,95 @@ uint32_t compute_4sec_offset(double lat, double lon, uint32_t position_30min) {
     return offset_18bits & 0x3FFFF;  // Masque 18 bits
 }
 
+// =============================
+// Integer GPS position encoder (1e-7 degree)
+// =============================
+// Same codes as compute_30min_position() / compute_4sec_offset() (kept as
+// the reference) without soft-float: every divide is a 32/16 hardware
+// DIV.UD with a quotient below 65536. Offsets are worked in 1/9 of 1e-7
+// degree, where a 4-second step is 100000 and a minute 1500000.
+#define GPS_E7_HALF_DEG     5000000UL
+#define GPS_N9_PER_MIN      1500000UL
+
+int32_t gps_deg_to_e7(double deg) {
+    if (!(deg > -GPS_E7_DEG_LIMIT && deg < GPS_E7_DEG_LIMIT)) return GPS_E7_INVALID;    // NaN too
+    return (int32_t)lround(deg * GPS_E7_PER_DEG);
+}
+
+static uint32_t gps_e7_abs(int32_t x_e7) {
+    return (x_e7 < 0) ? -(uint32_t)x_e7 : (uint32_t)x_e7;
+}
+
+// round(x / 0.5 deg), halves away from zero
+static int16_t gps_half_deg_steps(int32_t x_e7) {
+    uint32_t a = gps_e7_abs(x_e7) + GPS_E7_HALF_DEG / 2;
+    int16_t steps = (int16_t)(__builtin_divud(a, 50000U) / 100U);
+    return (x_e7 < 0) ? -steps : steps;
+}
+
+// round(|x| * 900): |x| = q.100000 + r -> 9q + round(9r / 100000)
+static uint32_t gps_4sec_units(int32_t x_e7) {
+    uint32_t a = gps_e7_abs(x_e7);
+    uint16_t q = __builtin_divud(a, 50000U) >> 1;
+    uint32_t r = a - (uint32_t)q * 100000UL;
+    return (uint32_t)q * 9 + (__builtin_divud(r * 9 + 50000UL, 50000U) >> 1);
+}
+
+// Sign (1 = at or above the reference) | minutes (4 bits) | 4-second steps (4 bits)
+static uint16_t gps_offset_axis(int32_t x_e7, int16_t ref_steps) {
+    int32_t delta = x_e7 - (int32_t)ref_steps * (int32_t)GPS_E7_HALF_DEG;
+    uint32_t n9 = gps_e7_abs(delta) * 9;
+    uint16_t minutes = __builtin_divud(n9, 50000U) / 30;
+    uint32_t rem = n9 - (uint32_t)minutes * GPS_N9_PER_MIN;
+    uint16_t steps = __builtin_divud(rem + 50000UL, 50000U) >> 1;
+
+    if (minutes > 15) minutes = 15;
+    if (steps > 15) steps = 15;
+    return ((delta >= 0) ? 0x100 : 0) | (minutes << 4) | steps;
+}
+
+uint32_t compute_30min_position_e7(int32_t lat_e7, int32_t lon_e7) {
+    int16_t lat_steps = gps_half_deg_steps(lat_e7);
+    int16_t lon_steps = gps_half_deg_steps(lon_e7);
+
+    lat_steps = (lat_steps < -128) ? -128 : (lat_steps > 127) ? 127 : lat_steps;
+    lon_steps = (lon_steps < -512) ? -512 : (lon_steps > 511) ? 511 : lon_steps;
+    return ((uint32_t)(lat_steps & 0x1FF) << 10) | (uint32_t)(lon_steps & 0x3FF);
+}
+
+uint32_t compute_4sec_offset_e7(int32_t lat_e7, int32_t lon_e7, uint32_t position_30min) {
+    // Reference point from the 9/10-bit two's complement codes
+    int16_t lat_ref = (int16_t)(((position_30min >> 10) & 0x1FF) << 7) >> 7;
+    int16_t lon_ref = (int16_t)((position_30min & 0x3FF) << 6) >> 6;
+
+    return ((uint32_t)gps_offset_axis(lat_e7, lat_ref) << 9) | gps_offset_axis(lon_e7, lon_ref);
+}
+
+cs_gps_position_t encode_gps_position_e7(int32_t lat_e7, int32_t lon_e7) {
+    cs_gps_position_t result = {0};
+
+    if (gps_e7_abs(lat_e7) > 90 * GPS_E7_PER_DEG || gps_e7_abs(lon_e7) > 180 * GPS_E7_PER_DEG) {
+        return result;
+    }
+
+    uint64_t lat_encoded = ((uint64_t)(gps_4sec_units(lat_e7) & 0x7FFFF) << 1) | (lat_e7 < 0 ? 1ULL : 0ULL);
+    uint64_t lon_encoded = ((uint64_t)(gps_4sec_units(lon_e7) & 0x7FFFF) << 1) | (lon_e7 < 0 ? 1ULL : 0ULL);
+    result.full_position_40bit = (lat_encoded << 20) | lon_encoded;
+    result.fine_position_19bit = compute_30min_position_e7(lat_e7, lon_e7);
+    result.offset_position_18bit = compute_4sec_offset_e7(lat_e7, lon_e7, result.fine_position_19bit);
+
+    if (!debug_flags.gps_encoding_printed) {
+        DEBUG_LOG_FLUSH("GPS FINE POS: 0x");
+        debug_print_hex24(result.fine_position_19bit);
+        DEBUG_LOG_FLUSH("\r\n");
+        debug_flags.gps_encoding_printed = 1;
+    }
+
+    return result;
+}
+
 // Conversion altitude -> code 4 bits (Â§A3.3.2.4)
-uint8_t altitude_to_code(double altitude) {
+uint8_t altitude_to_code(int32_t altitude) {
     if (altitude < 400)   return 0x0;
     if (altitude < 800)   return 0x1;
     if (altitude < 1200)  return 0x2;
@@ -416,23 +514,32 @@ uint8_t altitude_to_code(double altitude) {
 // Frame Construction with Compliant Bit Indexing
 // =============================
 
+// Build a complete frame for one identity/position into a caller buffer
+// (no shared state touched: used for the live frame and the virtual beacon cache).
+// The field layout comes from the protocol descriptor tables (protocol_layout.c).
+uint8_t build_frame_from_params(const beacon_frame_params_t *params, uint8_t *frame) {
+    if (!protocol_layout_build(params, frame)) {
+        DEBUG_LOG_FLUSH("ERROR: unknown protocol code\r\n");
+        return 0;
+    }
+    return 1;
+}
+
 void build_compliant_frame(void) {
     // Local frame buffer - dsPIC33CK stack optimization
     uint8_t frame[MESSAGE_BITS];
+    beacon_frame_params_t params;
 
-    // Fast zero initialization
-    memset(frame, 0, MESSAGE_BITS);
-
-    // ATOMIC GPS SNAPSHOT: Read all 3 GPS values atomically to ensure consistency
-    // Even with gps_data_locked flag, doing an atomic read guarantees the 3 values
-    // are from the same GPS update (not latitude from update N, longitude from N+1)
-    double lat_snapshot, lon_snapshot, alt_snapshot;
-    __builtin_disable_interrupts();
-    lat_snapshot = current_latitude;
-    lon_snapshot = current_longitude;
-    alt_snapshot = current_altitude;
-    __builtin_enable_interrupts();
+    // GPS SNAPSHOT: seqlock read, lat/lon/alt all from the same GPS update
+    // (no interrupt masking, a concurrent update only causes a retry)
+    frame_params_from_gps(&params);
 
+    // Identity from the persistent config (CFG ID / CFG COUNTRY)
+    const beacon_config_t *cfg = config_get();
+    params.beacon_id = cfg->beacon_id;
+    params.country_code = cfg->country_code;
+    params.protocol_code = cfg->protocol_code;
+    params.mode = beacon_mode;
 
     // Message de construction unique
     if (!debug_flags.build_msg_printed) {
@@ -441,55 +548,7 @@ void build_compliant_frame(void) {
 
     }
 
-    // CS-T001 frame construction - bit-exact
-    set_bit_field(frame, FRAME_PREAMBLE_START, FRAME_PREAMBLE_LENGTH, 0x7FFFUL);
-
-    // Sync pattern selection
-    uint16_t sync_pattern = (beacon_mode == BEACON_MODE_TEST) ? SYNC_SELF_TEST : SYNC_NORMAL_LONG;
-    set_bit_field(frame, FRAME_SYNC_START, FRAME_SYNC_LENGTH, sync_pattern);
-
-    // Format and protocol flags
-    set_bit_field(frame, FRAME_FORMAT_FLAG_BIT, 1, 1UL);
-    set_bit_field(frame, FRAME_PROTOCOL_FLAG_BIT, 1, 0UL);
-
-    // Country and protocol codes
-    set_bit_field(frame, FRAME_COUNTRY_START, FRAME_COUNTRY_LENGTH, COUNTRY_CODE_FRANCE);
-    set_bit_field(frame, FRAME_PROTOCOL_START, FRAME_PROTOCOL_LENGTH, PROTOCOL_ELT_DT);
-
-    // Beacon ID (example - replace with actual ID)
-    set_bit_field(frame, FRAME_BEACON_ID_START, FRAME_BEACON_ID_LENGTH, 0x123456UL);
-
-    // GPS position encoding - use atomic snapshots
-    cs_gps_position_t gps_pos = encode_gps_position_complete(lat_snapshot, lon_snapshot);
-    set_bit_field(frame, FRAME_POSITION_START, FRAME_POSITION_LENGTH, gps_pos.fine_position_19bit);
-    // DEBUG CRITIQUE
-    if(!debug_flags.gps_encoding_printed) {
-        DEBUG_LOG_FLUSH("GPS FINE POS: 0x");
-
-        debug_print_hex24(gps_pos.fine_position_19bit);
-        DEBUG_LOG_FLUSH("\r\n");
-        debug_flags.gps_encoding_printed = 1;
-    }
-
-    // BCH1 calculation - CS-T001 compliant
-    uint64_t pdf1_data = get_bit_field(frame, 25, 61);
-    uint32_t bch1 = compute_bch1(pdf1_data);
-    set_bit_field(frame, FRAME_BCH1_START, FRAME_BCH1_LENGTH, bch1);
-
-
-    // PDF-2 additional data
-    set_bit_field(frame, FRAME_ACTIVATION_START, FRAME_ACTIVATION_LENGTH, 0x0UL);
-
-    uint8_t alt_code = altitude_to_code(alt_snapshot);
-    set_bit_field(frame, FRAME_ALTITUDE_START, FRAME_ALTITUDE_LENGTH, alt_code);
-
-    set_bit_field(frame, FRAME_FRESHNESS_START, FRAME_FRESHNESS_LENGTH, 0x2UL);
-    set_bit_field(frame, FRAME_OFFSET_START, FRAME_OFFSET_LENGTH, gps_pos.offset_position_18bit);
-    
-    // BCH2 calculation - CS-T001 compliant
-    uint32_t pdf2_data = get_bit_field(frame, 107, 26);
-    uint16_t bch2 = compute_bch2(pdf2_data);
-    set_bit_field(frame, FRAME_BCH2_START, FRAME_BCH2_LENGTH, bch2);
+    if (!build_frame_from_params(&params, frame)) return;
 
        
     // Critical validation - dsPIC33CK optimized
@@ -497,9 +556,12 @@ void build_compliant_frame(void) {
     uint32_t bch1_check = (uint32_t)get_bit_field(frame, 86, 21);
     uint32_t bch1_calc = compute_bch1(pdf1_check);
 
-    uint32_t pdf2_check = (uint32_t)get_bit_field(frame, 107, 26);
-    uint16_t bch2_check = (uint16_t)get_bit_field(frame, 133, 12);
-    uint16_t bch2_calc = compute_bch2(pdf2_check);
+    uint16_t bch2_check = 0, bch2_calc = 0;
+    if (FRAME_BITS(frame) == LONG_MESSAGE_BITS) {
+        uint32_t pdf2_check = (uint32_t)get_bit_field(frame, 107, 26);
+        bch2_check = (uint16_t)get_bit_field(frame, 133, 12);
+        bch2_calc = compute_bch2(pdf2_check);
+    }
 
     // Single validation message
     if (!debug_flags.validation_printed) {
@@ -523,8 +585,9 @@ void build_compliant_frame(void) {
 }
 
 void build_test_frame(void) {
-    // Set test coordinates
-    set_gps_position(TEST_LATITUDE, TEST_LONGITUDE, TEST_ALTITUDE);
+    // Set test coordinates (persistent config, CFG POS)
+    const beacon_config_t *cfg = config_get();
+    set_gps_position(cfg->test_lat_udeg / 1000000.0, cfg->test_lon_udeg / 1000000.0, cfg->test_alt_m);
     beacon_mode = BEACON_MODE_TEST;
     
     // Build compliant frame
@@ -546,63 +609,48 @@ void build_exercise_frame(void) {
     // Build frame (GPS ISR protection moved to start_beacon_frame)
     build_compliant_frame();
 
-    rf_set_power_level(RF_POWER_HIGH);
+    rf_set_power_level(config_get()->exercise_power);
 }
 
-void start_beacon_frame(beacon_frame_type_t frame_type) {
-    // CRITICAL SECTION: Disable GPS ISR for EXERCISE mode during entire TX sequence
-    // Prevents GPS data changes between frame construction, validation, and transmission
-    //
-    // Problem discovered: GPS ISR was re-enabled after build_exercise_frame(),
-    // but BEFORE validate_frame_hardware(), causing BCH mismatch when GPS updates
-    // arrived between construction and validation.
-    //
-    // Solution: Keep GPS ISR disabled from construction through validation until
-    // after start_transmission() updates last_tx_time.
-    //
-    // GPS FIFO = 4 chars, total time ~2ms, GPS rate = 1 char/ms → No loss
-
-    uint8_t gps_was_disabled = 0;
-
-    if (frame_type == BEACON_EXERCISE_FRAME) {
-        IEC3bits.U3RXIE = 0;  // Disable GPS UART3 RX interrupt
-        gps_was_disabled = 1;
-    }
-
+// Frame, power and repetition period for the next burst; the scheduler calls
+// it TX_SCHED_PREPARE_MS ahead of the slot, transmit_beacon_frame(slot) on it
+void prepare_beacon_frame(beacon_frame_type_t frame_type) {
+    // No GPS masking needed: the frame is built from one seqlock snapshot and
+    // the record is only published from the main loop (gps_update), so it
+    // cannot change between construction, validation and transmission.
+    // The UART3 ISR keeps filling the ring buffer during the whole sequence.
     switch(frame_type) {
         case BEACON_TEST_FRAME:
             build_test_frame();       // TEST mode with fixed coordinates and low power
-            set_tx_interval(5000);    // 5s interval for testing
+            tx_sched_set_interval(config_get()->test_interval_ms);
             break;
 
         case BEACON_EXERCISE_FRAME:
             build_exercise_frame();   // EXERCISE mode with high power
-            set_tx_interval(15000);    // 15s interval for testing
+            tx_sched_set_interval(config_get()->exercise_interval_ms);
             break;
     }
 
     // Validation protocolaire
     //cs_t001_full_compliance_check();
+}
 
-    // Transmission physique
-    transmit_beacon_frame();
+void start_beacon_frame(beacon_frame_type_t frame_type) {
+    prepare_beacon_frame(frame_type);
 
-    // Re-enable GPS ISR after transmission started (last_tx_time updated)
-    if (gps_was_disabled) {
-        IEC3bits.U3RXIE = 1;  // Re-enable GPS interrupt
-    }
+    // Transmission physique
+    transmit_beacon_frame(TX_START_ASAP);
 }
 
-void transmit_beacon_frame(void) {
+void transmit_beacon_frame(uint32_t start_ms) {
     if (!validate_frame_hardware()) {
         DEBUG_LOG_FLUSH("ERROR: Invalid frame - transmission aborted\r\n");
         return;
     }
 
-    // Copie atomique vers le buffer RF et démarrage transmission
-    __builtin_disable_interrupts();
-    start_transmission(beacon_frame); // Défini dans system_comms.c
-    __builtin_enable_interrupts();
+    // Copie atomique vers le buffer RF et démarrage armé (system_comms.c):
+    // interruptions actives, le Timer1 démarre la porteuse sur start_ms
+    start_transmission(beacon_frame, start_ms);
 
     // 2. Log de confirmation
     if (!debug_flags.transmission_printed) {
@@ -633,6 +681,8 @@ static const cs_test_vector_t cs_test_vectors[] = {
     {"BCH2 Zeros",  0x00000000ULL, 0, 0x0000, 26},
 };
 
+#define BCH_XCHECK_COUNT 32     // Pseudo-random PDF pairs for the backend cross-check
+
 void validate_cs_t001_comprehensive(void) {
     // BCH test counters
     uint8_t bch1_passed = 0, bch1_total = 0;
@@ -681,7 +731,30 @@ void validate_cs_t001_comprehensive(void) {
         }
     }
     
+    // Backend cross-check against the software reference on pseudo-random
+    // PDF-1/PDF-2 words: active backend, and the CRC module on its own
+    // (fails here without failing compliance while the software one is active)
+    uint8_t xcheck_passed = 0, crc_passed = 0;
+    uint64_t prng = 0x9E3779B97F4A7C15ULL;
+
+    for (uint8_t i = 0; i < BCH_XCHECK_COUNT; i++) {
+        prng ^= prng << 13;
+        prng ^= prng >> 7;
+        prng ^= prng << 17;
+        uint64_t pdf1 = prng & ((1ULL << BCH1_DATA_BITS) - 1);
+        uint32_t pdf2 = (uint32_t)(prng >> 38) & ((1UL << BCH2_DATA_BITS) - 1);
+        uint32_t ref1 = compute_bch(pdf1, BCH1_DATA_BITS, BCH1_POLY, BCH1_DEGREE, BCH1_POLY_MASK);
+        uint32_t ref2 = compute_bch((uint64_t)pdf2, BCH2_DATA_BITS, BCH2_POLY, BCH2_DEGREE, BCH2_POLY_MASK);
+        uint32_t crc1 = 0, crc2 = 0;
+
+        if (compute_bch1(pdf1) == ref1 && compute_bch2(pdf2) == ref2) xcheck_passed++;
+        if (compute_bch_crc(pdf1, BCH1_DATA_BITS, BCH1_POLY, BCH1_DEGREE, &crc1) &&
+            compute_bch_crc((uint64_t)pdf2, BCH2_DATA_BITS, BCH2_POLY, BCH2_DEGREE, &crc2) &&
+            crc1 == ref1 && crc2 == ref2) crc_passed++;
+    }
+
     DEBUG_LOG_FLUSH("=== Test Results ===\r\n");
+    DEBUG_LOG_FLUSH(BCH_USE_CRC ? "Backend: CRC module\r\n" : "Backend: software\r\n");
     DEBUG_LOG_FLUSH("BCH1: ");
     debug_print_int32(bch1_passed);
     DEBUG_LOG_FLUSH("/");
@@ -694,8 +767,19 @@ void validate_cs_t001_comprehensive(void) {
     DEBUG_LOG_FLUSH("/");
     debug_print_int32(bch2_total);
     DEBUG_LOG_FLUSH(" passed\r\n");
+
+    DEBUG_LOG_FLUSH("Backend vs software: ");
+    debug_print_int32(xcheck_passed);
+    DEBUG_LOG_FLUSH("/");
+    debug_print_int32(BCH_XCHECK_COUNT);
+    DEBUG_LOG_FLUSH(", CRC module vs software: ");
+    debug_print_int32(crc_passed);
+    DEBUG_LOG_FLUSH("/");
+    debug_print_int32(BCH_XCHECK_COUNT);
+    DEBUG_LOG_FLUSH("\r\n");
     
-    if (bch1_passed == bch1_total && bch2_passed == bch2_total) {
+    if (bch1_passed == bch1_total && bch2_passed == bch2_total && xcheck_passed == BCH_XCHECK_COUNT &&
+        (!BCH_USE_CRC || crc_passed == BCH_XCHECK_COUNT)) {
         DEBUG_LOG_FLUSH("*** CS-T001 COMPLIANCE: VERIFIED ***\r\n");
     } else {
         DEBUG_LOG_FLUSH("*** CS-T001 COMPLIANCE: FAILED ***\r\n");
@@ -704,6 +788,9 @@ void validate_cs_t001_comprehensive(void) {
 }
 
 // Position encoding validation
+#define GPS_XCHECK_COUNT 256     // Pseudo-random positions for the integer encoder cross-check
+#define GPS_BENCH_RUNS   500     // Encodes per path for the timing
+
 void validate_position_encoding(void) {
     DEBUG_LOG_FLUSH("=== Position Encoding Validation ===\r\n");
      
@@ -735,14 +822,65 @@ void validate_position_encoding(void) {
         debug_print_hex64(pos.full_position_40bit);
         DEBUG_LOG_FLUSH("\r\n");
         
-        DEBUG_LOG_FLUSH("  21-bit: 0x");
-        debug_print_hex24(pos.coarse_position_21bit);
-        DEBUG_LOG_FLUSH("\r\n");
-        
         DEBUG_LOG_FLUSH("  19-bit: 0x");
         debug_print_hex24(pos.fine_position_19bit);
         DEBUG_LOG_FLUSH("\r\n");
     }
+
+    // Integer encoder against the double reference on pseudo-random points
+    // (|lat| <= 63.75 deg: beyond that the 9-bit 30-min latitude saturates)
+    uint16_t matched = 0;
+    uint32_t prng = 0x2545F491UL;
+
+    for (uint16_t i = 0; i < GPS_XCHECK_COUNT; i++) {
+        prng ^= prng << 13;
+        prng ^= prng >> 17;
+        prng ^= prng << 5;
+        int32_t lat_e7 = (int32_t)(prng % 1275000001UL) - 637500000L;
+        prng ^= prng << 13;
+        prng ^= prng >> 17;
+        prng ^= prng << 5;
+        int32_t lon_e7 = (int32_t)(prng % 1800000001UL);
+        if (prng & 0x80000000UL) lon_e7 = -lon_e7;
+        double lat = lat_e7 / (double)GPS_E7_PER_DEG;
+        double lon = lon_e7 / (double)GPS_E7_PER_DEG;
+
+        uint32_t pos30 = compute_30min_position(lat, lon);
+        if (compute_30min_position_e7(lat_e7, lon_e7) == pos30 &&
+            compute_4sec_offset_e7(lat_e7, lon_e7, pos30) == compute_4sec_offset(lat, lon, pos30)) {
+            matched++;
+        }
+    }
+    DEBUG_LOG_FLUSH("Integer vs double encoder: ");
+    debug_print_uint16(matched);
+    DEBUG_LOG_FLUSH("/");
+    debug_print_uint16(GPS_XCHECK_COUNT);
+    DEBUG_LOG_FLUSH(matched == GPS_XCHECK_COUNT ? " PASS\r\n" : " FAIL\r\n");
+
+    // Timing of the 30-min + 4-second codes of the TEST position, per path
+    volatile uint32_t sink = 0;
+    uint64_t t_start;
+    uint32_t t_double, t_integer;
+    int32_t lat_e7 = gps_deg_to_e7(TEST_LATITUDE), lon_e7 = gps_deg_to_e7(TEST_LONGITUDE);
+
+    t_start = now_us();
+    for (uint16_t i = 0; i < GPS_BENCH_RUNS; i++) {
+        uint32_t pos30 = compute_30min_position(TEST_LATITUDE, TEST_LONGITUDE);
+        sink += compute_4sec_offset(TEST_LATITUDE, TEST_LONGITUDE, pos30);
+    }
+    t_double = (uint32_t)(now_us() - t_start);
+    t_start = now_us();
+    for (uint16_t i = 0; i < GPS_BENCH_RUNS; i++) {
+        uint32_t pos30 = compute_30min_position_e7(lat_e7, lon_e7);
+        sink += compute_4sec_offset_e7(lat_e7, lon_e7, pos30);
+    }
+    t_integer = (uint32_t)(now_us() - t_start);
+
+    DEBUG_LOG_FLUSH("Encoder time per position (us): double ");
+    debug_print_uint32(t_double / GPS_BENCH_RUNS);
+    DEBUG_LOG_FLUSH(", integer ");
+    debug_print_uint32(t_integer / GPS_BENCH_RUNS);
+    DEBUG_LOG_FLUSH("\r\n");
 }
 
 // Legacy test functions for backward compatibility
@@ -897,9 +1035,10 @@ void cs_t001_full_compliance_check(void) {
     uint32_t bch1_check = (uint32_t)get_bit_field_volatile(beacon_frame, 86, 21);
     uint32_t bch1_calc = compute_bch1(pdf1_check);
     
+    uint8_t long_frame = (FRAME_BITS(beacon_frame) == LONG_MESSAGE_BITS);
     uint32_t pdf2_check = (uint32_t)get_bit_field_volatile(beacon_frame, 107, 26);
-    uint16_t bch2_check = (uint16_t)get_bit_field_volatile(beacon_frame, 133, 12);
-    uint16_t bch2_calc = compute_bch2(pdf2_check);
+    uint16_t bch2_check = long_frame ? (uint16_t)get_bit_field_volatile(beacon_frame, 133, 12) : 0;
+    uint16_t bch2_calc = long_frame ? compute_bch2(pdf2_check) : 0;
     
     DEBUG_LOG_FLUSH("BCH1 Frame Check: ");
     DEBUG_LOG_FLUSH((bch1_calc == bch1_check) ? "PASS" : "FAIL");
@@ -910,7 +1049,7 @@ void cs_t001_full_compliance_check(void) {
     DEBUG_LOG_FLUSH(")\r\n");
     
     DEBUG_LOG_FLUSH("BCH2 Frame Check: ");
-    DEBUG_LOG_FLUSH((bch2_calc == bch2_check) ? "PASS" : "FAIL");
+    DEBUG_LOG_FLUSH(!long_frame ? "N/A (short message)" : (bch2_calc == bch2_check) ? "PASS" : "FAIL");
     DEBUG_LOG_FLUSH(" (0x");
     debug_print_hex16(bch2_calc);
     DEBUG_LOG_FLUSH(" vs 0x");
@@ -947,11 +1086,14 @@ void debug_print_complete_frame_info(uint8_t include_hex) {
     if(debug_flags.frame_info_printed) return;
     debug_flags.frame_info_printed = 1;
     
+    gps_position_t pos;
+    gps_position_read(&pos);
+
     DEBUG_LOG_FLUSH("=== GPS DATA ===\r\n");
     DEBUG_LOG_FLUSH("Input: (");
-    debug_print_float(current_latitude, 6);
+    debug_print_float(pos.lat_e7 / (double)GPS_E7_PER_DEG, 6);
     DEBUG_LOG_FLUSH(", ");
-    debug_print_float(current_longitude, 6);
+    debug_print_float(pos.lon_e7 / (double)GPS_E7_PER_DEG, 6);
     DEBUG_LOG_FLUSH(")\r\n");
 
     // Extraction directe depuis la trame beacon_frame
@@ -970,6 +1112,7 @@ void debug_print_complete_frame_info(uint8_t include_hex) {
     uint32_t bch1_calc = compute_bch1(pdf1_data);
     uint32_t bch1_recv = (uint32_t)get_bit_field_volatile(beacon_frame, 86, 21);
     
+    uint8_t frame_bits = FRAME_BITS(beacon_frame);
     uint32_t pdf2_data = (uint32_t)get_bit_field_volatile(beacon_frame, 107, 26);
     uint16_t bch2_calc = compute_bch2(pdf2_data);
     uint16_t bch2_recv = (uint16_t)get_bit_field_volatile(beacon_frame, 133, 12);
@@ -983,13 +1126,17 @@ void debug_print_complete_frame_info(uint8_t include_hex) {
     DEBUG_LOG_FLUSH("\r\nBCH1 Recv: 0x");
     debug_print_hex24(bch1_recv);
     DEBUG_LOG_FLUSH((bch1_calc == bch1_recv) ? " (VALID)" : " (INVALID)");
-    DEBUG_LOG_FLUSH("\r\nPDF2:      0x");
-    debug_print_hex32(pdf2_data);
-    DEBUG_LOG_FLUSH("\r\nBCH2 Calc: 0x");
-    debug_print_hex16(bch2_calc);
-    DEBUG_LOG_FLUSH("\r\nBCH2 Recv: 0x");
-    debug_print_hex16(bch2_recv);
-    DEBUG_LOG_FLUSH((bch2_calc == bch2_recv) ? " (VALID)" : " (INVALID)");
+    if (frame_bits == LONG_MESSAGE_BITS) {
+        DEBUG_LOG_FLUSH("\r\nPDF2:      0x");
+        debug_print_hex32(pdf2_data);
+        DEBUG_LOG_FLUSH("\r\nBCH2 Calc: 0x");
+        debug_print_hex16(bch2_calc);
+        DEBUG_LOG_FLUSH("\r\nBCH2 Recv: 0x");
+        debug_print_hex16(bch2_recv);
+        DEBUG_LOG_FLUSH((bch2_calc == bch2_recv) ? " (VALID)" : " (INVALID)");
+    } else {
+        DEBUG_LOG_FLUSH("\r\nShort message (112 bits, no PDF-2)");
+    }
     DEBUG_LOG_FLUSH("\r\n");
 
     // Transmission info - single output
@@ -1001,7 +1148,7 @@ void debug_print_complete_frame_info(uint8_t include_hex) {
     // Conditional hex dump - dsPIC33CK optimized
     if (include_hex) {
         DEBUG_LOG_FLUSH("Frame HEX: ");
-        for (uint8_t byte = 0; byte < 18; byte++) {
+        for (uint8_t byte = 0; byte < frame_bits / 8; byte++) {
             uint8_t byte_val = 0;
             for (uint8_t bit = 0; bit < 8; bit++) {
                 byte_val = (byte_val << 1) | (beacon_frame[byte * 8 + bit] & 1);
@@ -1017,9 +1164,13 @@ uint8_t validate_frame_hardware(void) {
     uint32_t bch1_calc = compute_bch1(pdf1);
     uint32_t bch1_recv = (uint32_t)get_bit_field_volatile(beacon_frame, 86, 21);
 
-    uint32_t pdf2 = (uint32_t)get_bit_field_volatile(beacon_frame, 107, 26);
-    uint16_t bch2_calc = compute_bch2(pdf2);
-    uint16_t bch2_recv = (uint16_t)get_bit_field_volatile(beacon_frame, 133, 12);
+    // Short message: no PDF-2 / BCH2
+    uint16_t bch2_calc = 0, bch2_recv = 0;
+    if (FRAME_BITS(beacon_frame) == LONG_MESSAGE_BITS) {
+        uint32_t pdf2 = (uint32_t)get_bit_field_volatile(beacon_frame, 107, 26);
+        bch2_calc = compute_bch2(pdf2);
+        bch2_recv = (uint16_t)get_bit_field_volatile(beacon_frame, 133, 12);
+    }
 
     if(bch1_calc != bch1_recv || bch2_calc != bch2_recv) {
         DEBUG_LOG_FLUSH("FRAME VALIDATION ERROR\r\n");
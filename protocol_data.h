@@ -15,6 +15,9 @@
 #define TEST_LATITUDE 42.95463
 #define TEST_LONGITUDE 1.364479
 #define TEST_ALTITUDE 1080
+#define TEST_LATITUDE_E7  429546300L    // Same position in 1e-7 degree / mm
+#define TEST_LONGITUDE_E7 13644790L
+#define TEST_ALTITUDE_MM  1080000L
 
 // BCH Polynomials (CS-T001 compliant)
 #define BCH1_POLY       0x26D9E3  // 22-bit (X^21 + ... + 1)
@@ -27,6 +30,14 @@
 #define BCH2_DEGREE     12
 #define BCH2_DATA_BITS  26
 
+// BCH backend, selected at build time (-DBCH_USE_CRC=1): 0 = software
+// compute_bch() (default), 1 = programmable CRC module (drivers/crc_engine).
+// compute_bch() stays the reference; validate_cs_t001_comprehensive()
+// cross-checks the active backend against it.
+#ifndef BCH_USE_CRC
+#define BCH_USE_CRC     0
+#endif
+
 #define PROTOCOL_ELT_DT 0x9 // 1001 binary
 
 // Frame sync patterns
@@ -67,11 +78,21 @@
 // Complete GPS position structure for CS-T001 compliance
 typedef struct {
   uint64_t full_position_40bit;   // Complete 40-bit encoding
-  uint32_t coarse_position_21bit; // Truncated for short messages
   uint32_t fine_position_19bit;   // 30-minute resolution (PDF-1)
   uint32_t offset_position_18bit; // 4-second resolution offset
 } cs_gps_position_t;
 
+// Identity and position of one frame (live beacon or virtual beacon)
+typedef struct {
+  uint32_t beacon_id;             // 24-bit beacon identification
+  uint16_t country_code;          // 10-bit MID
+  uint8_t protocol_code;          // 4-bit location protocol code
+  uint8_t mode;                   // BEACON_MODE_TEST / BEACON_MODE_EXERCISE
+  int32_t lat_e7;                 // Latitude, 1e-7 degree
+  int32_t lon_e7;                 // Longitude, 1e-7 degree
+  int32_t alt_m;                  // Altitude above mean sea level, m
+} beacon_frame_params_t;
+
 // Test vector structure
 typedef struct {
   const char *name;
@@ -90,18 +111,29 @@ extern uint8_t beacon_mode;
 uint32_t compute_bch(uint64_t data, int num_bits, uint32_t poly, int poly_degree, uint32_t poly_mask);
 uint32_t compute_bch1(uint64_t data);
 uint16_t compute_bch2(uint32_t data);
+uint8_t compute_bch_crc(uint64_t data, int num_bits, uint32_t poly, int poly_degree, uint32_t *bch);
 
 // =============================
 // GPS Functions - Updated for Compliance
 // =============================
 void set_gps_position(double lat, double lon, double alt);
+void frame_params_from_gps(beacon_frame_params_t *params);
 void parse_nmea_gga(const char *line);
 
 // PRIORITY 1: Fixed GPS encoding functions
 cs_gps_position_t encode_gps_position_complete(double lat, double lon);
 uint32_t compute_30min_position(double lat, double lon);
 uint32_t compute_4sec_offset(double lat, double lon, uint32_t position_30min);
-uint8_t altitude_to_code(double altitude);
+uint8_t altitude_to_code(int32_t altitude_m);
+
+// Integer encoder, positions in 1e-7 degree (same codes, no soft-float)
+#define GPS_E7_PER_DEG      10000000L
+#define GPS_E7_DEG_LIMIT    200.0           // gps_deg_to_e7() input bound (keeps int32)
+#define GPS_E7_INVALID      INT32_MAX       // Out of range: encoder returns all-zero codes
+int32_t gps_deg_to_e7(double deg);
+cs_gps_position_t encode_gps_position_e7(int32_t lat_e7, int32_t lon_e7);
+uint32_t compute_30min_position_e7(int32_t lat_e7, int32_t lon_e7);
+uint32_t compute_4sec_offset_e7(int32_t lat_e7, int32_t lon_e7, uint32_t position_30min);
 
 // =============================
 // Standardized Bit Operations
@@ -119,6 +151,7 @@ uint64_t get_bit_field_volatile(volatile const uint8_t *frame,
 void build_test_frame(void);      // Original function
 void build_EXERCISE_frame(void);  // Original function
 void build_compliant_frame(void); // PRIORITY 2: New compliant version
+uint8_t build_frame_from_params(const beacon_frame_params_t *params, uint8_t *frame);
 
 // =============================
 // Comprehensive Testing
@@ -156,7 +189,7 @@ void initialize_debug_system(void);
 uint8_t validate_frame_hardware(void);
 void set_debug_flag_atomic(uint8_t flag_bit);
 void full_error_diagnostic(void);
-void transmit_beacon_frame(void);
+void transmit_beacon_frame(uint32_t start_ms);
 void debug_print_int16(int16_t value);
 void debug_print_hex24(uint32_t value);
 
@@ -169,10 +202,12 @@ void debug_print_hex24(uint32_t value);
     uint32_t bch1_calc = compute_bch1(pdf1);                                   \
     uint32_t bch1_recv =                                                       \
         (uint32_t)get_bit_field_volatile(beacon_frame, 86, 21);                \
-    uint32_t pdf2 = (uint32_t)get_bit_field_volatile(beacon_frame, 107, 26);   \
-    uint16_t bch2_calc = compute_bch2(pdf2);                                   \
-    uint16_t bch2_recv =                                                       \
-        (uint16_t)get_bit_field_volatile(beacon_frame, 133, 12);               \
+    uint16_t bch2_calc = 0, bch2_recv = 0;                                     \
+    if (FRAME_BITS(beacon_frame) == LONG_MESSAGE_BITS) {                       \
+      uint32_t pdf2 = (uint32_t)get_bit_field_volatile(beacon_frame, 107, 26); \
+      bch2_calc = compute_bch2(pdf2);                                          \
+      bch2_recv = (uint16_t)get_bit_field_volatile(beacon_frame, 133, 12);     \
+    }                                                                          \
     if ((bch1_calc != bch1_recv) || (bch2_calc != bch2_recv)) {                \
       debug_print_str("FRAME VALIDATION ERROR\r\n");                           \
       return 0;                                                                \
@@ -188,8 +223,6 @@ void debug_print_hex24(uint32_t value);
 #define DEBUG_FLAG_VALIDATION 4
 #define DEBUG_FLAG_TRANSMISSION 5
 
-#define MAX_DUTY_CYCLE_PERCENT 0.1 // 10%
-
 // =============================
 // Type trame Transmission 
 // =============================
@@ -198,6 +231,7 @@ typedef enum {
     BEACON_EXERCISE_FRAME
 } beacon_frame_type_t;
 
+void prepare_beacon_frame(beacon_frame_type_t frame_type);
 void start_beacon_frame(beacon_frame_type_t frame_type);
 
 
@@ -206,9 +240,6 @@ void start_beacon_frame(beacon_frame_type_t frame_type);
 // =============================
 extern uint8_t frame[MESSAGE_BITS];
 extern volatile uint8_t gps_updated;
-extern volatile double current_latitude;
-extern volatile double current_longitude;
-extern volatile double current_altitude;
 
 // =============================
 // Convenience Macros for Frame Fields
@@ -0,0 +1,304 @@
+// protocol_layout.c - Table-Driven T.001 Message Layouts (long and short)
+//
+// Each location protocol family is a const field descriptor table (flash).
+// protocol_layout_build() lays down the common header (preamble, sync,
+// format flag), packs the table fields, then runs the BCH stage shared by
+// every long message: BCH1 over bits 25-85, BCH2 over bits 107-132.
+// A short message (PROTOCOL_SHORT_FLAG) keeps the same PDF-1 and BCH1, has
+// format flag 0 and ends at bit 112: PDF-2 fields are dropped and bits
+// 107-112 (emergency code / national use) are sent as 0. T.001 defines it
+// for user protocols only; location protocols are long-only and reject it.
+// ELT(DT) keeps the original 30 min / 4 s encoders (grid = 0) so its frames
+// are bit-identical to the previous hard-coded builder.
+
+#include "includes.h"
+#include "protocol_layout.h"
+#include "system_debug.h"
+
+#define LAYOUT_PDF1_START       25
+#define LAYOUT_PDF1_BITS        61
+#define LAYOUT_PDF2_START       107
+#define LAYOUT_PDF2_BITS        26
+#define LAYOUT_SHORT_END        112     // Last bit of a short message
+
+// =============================
+// Position grids
+// =============================
+static const position_grid_t grid_standard = {2, 4, 5, 4};    // 15 min, offset +/-30 min / 4 s
+static const position_grid_t grid_national = {5, 30, 2, 4};   // 2 min, offset +/-3 min / 4 s
+static const position_grid_t grid_rls      = {1, 2, 4, 4};    // 30 min, offset +/-15 min / 4 s
+static const position_grid_t grid_user     = {4, 15, 0, 0};   // 4 min, PDF-2 only, no offset
+
+// =============================
+// Field descriptor tables (PDF-1 after bit 25, PDF-2)
+// =============================
+static const frame_field_t fields_elt_dt[] = {
+    {26,  1, FIELD_SRC_CONST, 0},           // Location protocol
+    {27, 10, FIELD_SRC_COUNTRY, 0},
+    {37,  4, FIELD_SRC_CODE, 0},
+    {41, 26, FIELD_SRC_ID, 0},              // ID type (2) + 24-bit address
+    {67, 19, FIELD_SRC_POS_COARSE, 0},      // 30 min position
+    {107, 2, FIELD_SRC_CONST, 0},           // Means of activation
+    {109, 4, FIELD_SRC_ALTITUDE, 0},
+    {113, 2, FIELD_SRC_CONST, 2},           // Location freshness
+    {115, 18, FIELD_SRC_POS_OFFSET, 0},
+    {0, 0, 0, 0}
+};
+
+static const frame_field_t fields_standard[] = {
+    {26,  1, FIELD_SRC_CONST, 0},
+    {27, 10, FIELD_SRC_COUNTRY, 0},
+    {37,  4, FIELD_SRC_CODE, 0},
+    {41, 24, FIELD_SRC_ID, 0},
+    {65, 21, FIELD_SRC_POS_COARSE, 0},      // 15 min position
+    {107, 4, FIELD_SRC_CONST, 0xD},         // Fixed 1101
+    {111, 1, FIELD_SRC_CONST, 1},           // Position from internal device
+    {112, 1, FIELD_SRC_CONST, 0},           // No 121.5 MHz homing
+    {113, 20, FIELD_SRC_POS_OFFSET, 0},
+    {0, 0, 0, 0}
+};
+
+static const frame_field_t fields_national[] = {
+    {26,  1, FIELD_SRC_CONST, 0},
+    {27, 10, FIELD_SRC_COUNTRY, 0},
+    {37,  4, FIELD_SRC_CODE, 0},
+    {41, 18, FIELD_SRC_ID, 0},
+    {59, 27, FIELD_SRC_POS_COARSE, 0},      // 2 min position
+    {107, 3, FIELD_SRC_CONST, 0x6},         // Fixed 110
+    {110, 1, FIELD_SRC_CONST, 1},           // Position from internal device
+    {111, 1, FIELD_SRC_CONST, 0},           // No 121.5 MHz homing
+    {112, 14, FIELD_SRC_POS_OFFSET, 0},
+    {126, 7, FIELD_SRC_CONST, 0},           // National use
+    {0, 0, 0, 0}
+};
+
+static const frame_field_t fields_rls[] = {
+    {26,  1, FIELD_SRC_CONST, 0},
+    {27, 10, FIELD_SRC_COUNTRY, 0},
+    {37,  4, FIELD_SRC_CODE, 0},
+    {41, 26, FIELD_SRC_ID, 0},              // Beacon type (2) + TAC/serial (24)
+    {67, 19, FIELD_SRC_POS_COARSE, 0},      // 30 min position
+    {107, 8, FIELD_SRC_CONST, 0},           // RLS data (no RLM capability)
+    {115, 18, FIELD_SRC_POS_OFFSET, 0},
+    {0, 0, 0, 0}
+};
+
+static const frame_field_t fields_user[] = {
+    {26,  1, FIELD_SRC_CONST, 1},           // User protocol
+    {27, 10, FIELD_SRC_COUNTRY, 0},
+    {37,  3, FIELD_SRC_CODE, 0},
+    {40, 44, FIELD_SRC_ID, 0},              // Identification data
+    {84,  2, FIELD_SRC_CONST, 0},           // No auxiliary radio locating device
+    {107, 1, FIELD_SRC_CONST, 1},           // Position from internal device
+    {108, 25, FIELD_SRC_POS_COARSE, 0},     // 4 min position
+    {0, 0, 0, 0}
+};
+
+static const protocol_layout_t protocol_layouts[] = {
+    {"ELT(DT)",  0, 1U << 0x9, 0, fields_elt_dt},
+    {"Standard", 0, (1U << 0x2) | (1U << 0x3) | (1U << 0x4) | (1U << 0x5) |
+                    (1U << 0x6) | (1U << 0x7) | (1U << 0xC) | (1U << 0xE),
+                 &grid_standard, fields_standard},
+    {"National", 0, (1U << 0x8) | (1U << 0xA) | (1U << 0xB) | (1U << 0xF),
+                 &grid_national, fields_national},
+    {"RLS",      0, 1U << 0xD, &grid_rls, fields_rls},
+    {"User",     1, (1U << 1) | (1U << 2) | (1U << 3) | (1U << 6) | (1U << 7),
+                 &grid_user, fields_user},
+};
+
+#define PROTOCOL_LAYOUT_COUNT (sizeof(protocol_layouts) / sizeof(protocol_layouts[0]))
+
+const protocol_layout_t* protocol_layout_find(uint8_t protocol_code) {
+    uint8_t user = (protocol_code & PROTOCOL_USER_FLAG) ? 1 : 0;
+    uint8_t code = user ? (protocol_code & 0x7) : (protocol_code & 0xF);
+
+    if (protocol_code & ~(PROTOCOL_SHORT_FLAG | PROTOCOL_USER_FLAG | 0xF)) return 0;
+    if (user && (protocol_code & 0x8)) return 0;
+    if (!user && (protocol_code & PROTOCOL_SHORT_FLAG)) return 0;
+
+    for (uint8_t i = 0; i < PROTOCOL_LAYOUT_COUNT; i++) {
+        if (protocol_layouts[i].user == user && (protocol_layouts[i].code_mask & (1U << code))) {
+            return &protocol_layouts[i];
+        }
+    }
+    return 0;
+}
+
+// =============================
+// Position encoders (sign/magnitude grid)
+// =============================
+// Integer only, from 1e-7 degree: |x| = deg.1e7 + rest, rest.units_per_deg
+// stays below 2^32 and every divide is a 32/16 DIV.UD. Positions beyond the
+// pole or the antimeridian are clamped to it.
+#define LAYOUT_E7_PER_DEG       10000000UL
+
+// Returns flag | degrees | fraction. *delta = x - grid point, in
+// 1/units_per_deg of 1e-7 degree (|delta| <= 5000000).
+static uint32_t layout_coarse_axis(int32_t x_e7, uint8_t deg_bits, const position_grid_t *grid,
+                                   int32_t *delta) {
+    uint32_t max_deg = (deg_bits == 7) ? 90UL : 180UL;
+    uint32_t a = (x_e7 < 0) ? -(uint32_t)x_e7 : (uint32_t)x_e7;
+    if (a > max_deg * LAYOUT_E7_PER_DEG) a = max_deg * LAYOUT_E7_PER_DEG;
+
+    uint16_t deg = __builtin_divud(a, 50000U) / 200U;
+    uint32_t rest = (a - (uint32_t)deg * LAYOUT_E7_PER_DEG) * grid->units_per_deg;
+    uint16_t frac = __builtin_divud(rest + LAYOUT_E7_PER_DEG / 2, 50000U) / 200U;
+    int32_t d = (int32_t)rest - (int32_t)frac * (int32_t)LAYOUT_E7_PER_DEG;
+
+    if (frac == grid->units_per_deg) {          // Rounded up to the next degree
+        deg++;
+        frac = 0;
+    }
+    *delta = (x_e7 < 0) ? -d : d;
+    return ((x_e7 < 0 ? 1UL : 0UL) << (deg_bits + grid->frac_bits)) |
+           ((uint32_t)deg << grid->frac_bits) | frac;
+}
+
+// Offset from the grid point: sign (1 = plus), minutes, 4-second steps.
+// 4-second steps = round(|delta| . 900 / (1e7 . units_per_deg))
+//                = round(|delta| . 9 / (50000 . 2 . units_per_deg))
+static uint32_t layout_offset_axis(int32_t delta, const position_grid_t *grid) {
+    uint32_t n9 = ((delta < 0) ? -(uint32_t)delta : (uint32_t)delta) * 9;
+    uint16_t den = 2 * grid->units_per_deg;
+    uint16_t total = __builtin_divud(n9 + 50000UL * grid->units_per_deg, 50000U) / den;
+    uint32_t min_max = (1UL << grid->off_min_bits) - 1;
+    uint32_t whole = total / 15;
+    uint32_t steps = total % 15;
+
+    if (whole > min_max) {
+        whole = min_max;
+        steps = 14;
+    }
+    return ((delta >= 0 ? 1UL : 0UL) << (grid->off_min_bits + grid->off_sec_bits)) |
+           (whole << grid->off_sec_bits) | steps;
+}
+
+// =============================
+// Generic packer + BCH stage
+// =============================
+uint8_t protocol_layout_build(const beacon_frame_params_t *params, uint8_t *frame) {
+    const protocol_layout_t *layout = protocol_layout_find(params->protocol_code);
+    if (!layout) return 0;
+    uint8_t is_short = PROTOCOL_IS_SHORT(params->protocol_code);
+
+    uint32_t coarse, offset = 0;
+    if (!layout->grid) {
+        cs_gps_position_t gps_pos = encode_gps_position_e7(params->lat_e7, params->lon_e7);
+        coarse = gps_pos.fine_position_19bit;
+        offset = gps_pos.offset_position_18bit;
+    } else {
+        const position_grid_t *grid = layout->grid;
+        int32_t lat_delta, lon_delta;
+        uint32_t lat = layout_coarse_axis(params->lat_e7, 7, grid, &lat_delta);
+        uint32_t lon = layout_coarse_axis(params->lon_e7, 8, grid, &lon_delta);
+        coarse = (lat << (9 + grid->frac_bits)) | lon;
+        if (grid->off_min_bits) {
+            uint8_t axis_bits = 1 + grid->off_min_bits + grid->off_sec_bits;
+            offset = (layout_offset_axis(lat_delta, grid) << axis_bits) |
+                     layout_offset_axis(lon_delta, grid);
+        }
+    }
+
+    memset(frame, 0, MESSAGE_BITS);
+    set_bit_field(frame, FRAME_PREAMBLE_START, FRAME_PREAMBLE_LENGTH, 0x7FFFUL);
+    set_bit_field(frame, FRAME_SYNC_START, FRAME_SYNC_LENGTH,
+                  (params->mode == BEACON_MODE_TEST) ? SYNC_SELF_TEST : SYNC_NORMAL_LONG);
+    set_bit_field(frame, FRAME_FORMAT_FLAG_BIT, 1, is_short ? 0UL : 1UL);
+
+    for (const frame_field_t *f = layout->fields; f->length; f++) {
+        uint64_t value;
+        if (is_short && f->start >= LAYOUT_PDF2_START) continue;
+        switch (f->source) {
+            case FIELD_SRC_COUNTRY:    value = params->country_code; break;
+            case FIELD_SRC_CODE:       value = params->protocol_code & (layout->user ? 0x7 : 0xF); break;
+            case FIELD_SRC_ID:         value = params->beacon_id; break;
+            case FIELD_SRC_POS_COARSE: value = coarse; break;
+            case FIELD_SRC_POS_OFFSET: value = offset; break;
+            case FIELD_SRC_ALTITUDE:   value = altitude_to_code(params->alt_m); break;
+            default:                   value = f->value; break;
+        }
+        if (f->length < 64) value &= (1ULL << f->length) - 1;
+        set_bit_field(frame, f->start, f->length, value);
+    }
+
+    uint64_t pdf1 = get_bit_field(frame, LAYOUT_PDF1_START, LAYOUT_PDF1_BITS);
+    set_bit_field(frame, FRAME_BCH1_START, FRAME_BCH1_LENGTH, compute_bch1(pdf1));
+    if (is_short) return 1;                     // Bits 107-112 left at 0, no BCH2
+
+    uint32_t pdf2 = (uint32_t)get_bit_field(frame, LAYOUT_PDF2_START, LAYOUT_PDF2_BITS);
+    set_bit_field(frame, FRAME_BCH2_START, FRAME_BCH2_LENGTH, compute_bch2(pdf2));
+    return 1;
+}
+
+// =============================
+// Golden vectors: bits 25-144 (15 bytes, MSB first) per protocol;
+// short messages compare bits 25-112 (11 bytes)
+// =============================
+typedef struct {
+    uint8_t protocol_code;
+    uint8_t mode;
+    uint32_t beacon_id;
+    uint16_t country_code;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    int32_t alt_m;
+    uint8_t expected[15];
+} protocol_golden_t;
+
+static const protocol_golden_t protocol_golden[] = {
+    {PROTOCOL_ELT_DT, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0x8E, 0x39, 0x04, 0x8D, 0x15, 0x8A, 0xC0, 0x1E, 0x3A, 0xA4, 0x82, 0x85, 0x68, 0x24, 0xCE}},
+    {PROTOCOL_ELT_DT, BEACON_MODE_TEST, 0xABCDEFUL, 366, -338688000L, -706693000L, 520,
+     {0x96, 0xE9, 0x2A, 0xF3, 0x7B, 0xF7, 0x9B, 0x99, 0x33, 0xC0, 0x01, 0xAF, 0xAA, 0x2E, 0x46}},
+    {PROTOCOL_STD_ELT_24BIT, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0x8E, 0x33, 0x12, 0x34, 0x56, 0x2B, 0x00, 0x2A, 0x9F, 0x1F, 0x76, 0x0A, 0xE6, 0xDF, 0x53}},
+    {PROTOCOL_STD_ELT_24BIT, BEACON_MODE_TEST, 0xABCDEFUL, 366, -338688000L, -706693000L, 520,
+     {0x96, 0xE3, 0xAB, 0xCD, 0xEF, 0xA1, 0xE8, 0xDC, 0x4B, 0x94, 0xB6, 0x1C, 0xA4, 0xD9, 0x51}},
+    {PROTOCOL_STD_PLB_SERIAL, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0x8E, 0x37, 0x12, 0x34, 0x56, 0x2B, 0x00, 0x2A, 0x48, 0xE2, 0x36, 0x0A, 0xE6, 0xDF, 0x53}},
+    {PROTOCOL_NATIONAL_ELT, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0x8E, 0x38, 0x8D, 0x15, 0x8A, 0xBA, 0x01, 0x5A, 0x62, 0x93, 0x74, 0x2C, 0x10, 0x0D, 0x4F}},
+    {PROTOCOL_NATIONAL_ELT, BEACON_MODE_TEST, 0xABCDEFUL, 366, -338688000L, -706693000L, 520,
+     {0x96, 0xE8, 0xF3, 0x7B, 0xE8, 0x75, 0x46, 0xA5, 0x67, 0xE5, 0x74, 0x08, 0x10, 0x0D, 0x33}},
+    {PROTOCOL_RLS, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0x8E, 0x3D, 0x04, 0x8D, 0x15, 0x8A, 0xC0, 0x1E, 0xED, 0x59, 0xC0, 0x05, 0x68, 0x2B, 0x3B}},
+    {PROTOCOL_RLS, BEACON_MODE_TEST, 0xABCDEFUL, 366, -338688000L, -706693000L, 520,
+     {0x96, 0xED, 0x2A, 0xF3, 0x7B, 0xE8, 0x94, 0x6C, 0xE3, 0x52, 0x00, 0x2F, 0xAA, 0x2B, 0x15}},
+    {PROTOCOL_USER_SERIAL, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0xCE, 0x36, 0x00, 0x00, 0x02, 0x46, 0x8A, 0xC7, 0x4F, 0x56, 0xE5, 0x5C, 0x01, 0x50, 0xA3}},
+    {PROTOCOL_USER_SERIAL, BEACON_MODE_TEST, 0xABCDEFUL, 366, -338688000L, -706693000L, 520,
+     {0xD6, 0xE6, 0x00, 0x00, 0x15, 0x79, 0xBD, 0xE1, 0x51, 0x0F, 0x34, 0x3B, 0x46, 0xA8, 0x59}},
+    {PROTOCOL_SHORT_FLAG | PROTOCOL_USER_SERIAL, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0x4E, 0x36, 0x00, 0x00, 0x02, 0x46, 0x8A, 0xC4, 0xB7, 0xF5, 0xC0}},
+    {PROTOCOL_SHORT_FLAG | PROTOCOL_USER_SERIAL, BEACON_MODE_TEST, 0xABCDEFUL, 366, -338688000L, -706693000L, 520,
+     {0x56, 0xE6, 0x00, 0x00, 0x15, 0x79, 0xBD, 0xE2, 0xA9, 0xAC, 0x00}},
+    {PROTOCOL_SHORT_FLAG | PROTOCOL_USER_FLAG | 0x7, BEACON_MODE_EXERCISE, 0x123456UL, 227, 429546300L, 13644790L, 1080,
+     {0x4E, 0x3E, 0x00, 0x00, 0x02, 0x46, 0x8A, 0xC5, 0x18, 0x0F, 0x40}},
+};
+
+uint8_t protocol_layout_self_test(void) {
+    uint8_t frame[MESSAGE_BITS];
+    uint8_t pass = 1;
+
+    for (uint8_t i = 0; i < sizeof(protocol_golden) / sizeof(protocol_golden[0]); i++) {
+        const protocol_golden_t *g = &protocol_golden[i];
+        beacon_frame_params_t params = {g->beacon_id, g->country_code, g->protocol_code, g->mode,
+                                        g->lat_e7, g->lon_e7, g->alt_m};
+        uint8_t ok = protocol_layout_build(&params, frame);
+
+        uint8_t bytes = (PROTOCOL_IS_SHORT(g->protocol_code) ? LAYOUT_SHORT_END : MESSAGE_BITS) / 8 - 3;
+        for (uint8_t b = 0; b < bytes && ok; b++) {
+            if ((uint8_t)get_bit_field(frame, 25 + 8 * b, 8) != g->expected[b]) ok = 0;
+        }
+        DEBUG_LOG_FLUSH(ok ? "  PASS " : "  FAIL ");
+        DEBUG_LOG_FLUSH(protocol_layout_find(g->protocol_code)->name);
+        if (PROTOCOL_IS_SHORT(g->protocol_code)) DEBUG_LOG_FLUSH(" short");
+        DEBUG_LOG_FLUSH(" code 0x");
+        debug_print_hex(g->protocol_code);
+        DEBUG_LOG_FLUSH("\r\n");
+        if (!ok) pass = 0;
+    }
+
+    DEBUG_LOG_FLUSH(pass ? "Protocol layout self-test PASS\r\n" : "Protocol layout self-test FAIL\r\n");
+    return pass;
+}
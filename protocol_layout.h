@@ -0,0 +1,65 @@
+// protocol_layout.h - Table-Driven T.001 Message Layouts (long and short)
+
+#ifndef PROTOCOL_LAYOUT_H
+#define PROTOCOL_LAYOUT_H
+
+#include <stdint.h>
+#include "protocol_data.h"
+
+// protocol_code values: 4-bit location protocol codes (bit 26 = 0), or
+// PROTOCOL_USER_FLAG | 3-bit user protocol code (bit 26 = 1).
+// PROTOCOL_SHORT_FLAG selects the 112-bit short message (PDF-1 + BCH1 only),
+// user protocols only.
+#define PROTOCOL_USER_FLAG      0x10
+#define PROTOCOL_SHORT_FLAG     0x20
+#define PROTOCOL_STD_ELT_24BIT  0x3     // Standard location, ELT 24-bit address
+#define PROTOCOL_STD_PLB_SERIAL 0x7     // Standard location, PLB serial
+#define PROTOCOL_NATIONAL_ELT   0x8     // National location, ELT
+#define PROTOCOL_RLS            0xD     // RLS location
+#define PROTOCOL_USER_SERIAL    (PROTOCOL_USER_FLAG | 0x3)  // Serial user location
+#define PROTOCOL_IS_SHORT(code) (((code) & PROTOCOL_SHORT_FLAG) ? 1 : 0)
+#define PROTOCOL_FRAME_BITS(code) (PROTOCOL_IS_SHORT(code) ? SHORT_MESSAGE_BITS : LONG_MESSAGE_BITS)
+
+// Where a field value comes from
+typedef enum {
+    FIELD_SRC_CONST = 0,        // 'value' as is
+    FIELD_SRC_COUNTRY,          // params->country_code
+    FIELD_SRC_CODE,             // Protocol code (4 bits location, 3 bits user)
+    FIELD_SRC_ID,               // params->beacon_id, right-aligned
+    FIELD_SRC_POS_COARSE,       // PDF position (protocol grid)
+    FIELD_SRC_POS_OFFSET,       // PDF-2 offset from the coarse position
+    FIELD_SRC_ALTITUDE          // altitude_to_code()
+} frame_field_src_t;
+
+typedef struct {
+    uint8_t start;              // CS bit number (1 = first preamble bit)
+    uint8_t length;             // 0 terminates a field list
+    uint8_t source;             // frame_field_src_t
+    uint32_t value;             // FIELD_SRC_CONST only
+} frame_field_t;
+
+// Sign/magnitude position grid: flag, 7 (lat) or 8 (lon) degree bits, then
+// frac_bits of 1/units_per_deg degree. Offset: sign, minutes, 4-second steps.
+typedef struct {
+    uint8_t frac_bits;
+    uint8_t units_per_deg;
+    uint8_t off_min_bits;       // 0 = no offset field
+    uint8_t off_sec_bits;
+} position_grid_t;
+
+typedef struct {
+    const char *name;
+    uint8_t user;               // 1 = user protocol (bit 26 = 1, 3-bit code)
+    uint16_t code_mask;         // Bit n set = code n uses this layout
+    const position_grid_t *grid;    // 0 = legacy ELT(DT) 30 min / 4 s encoders
+    const frame_field_t *fields;
+} protocol_layout_t;
+
+// Function prototypes
+const protocol_layout_t* protocol_layout_find(uint8_t protocol_code);
+uint8_t protocol_layout_build(const beacon_frame_params_t *params, uint8_t *frame);
+
+// Test and validation
+uint8_t protocol_layout_self_test(void);
+
+#endif /* PROTOCOL_LAYOUT_H */
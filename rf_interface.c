@@ -4,6 +4,8 @@
 #include "includes.h"
 #include "rf_interface.h"
 #include "system_debug.h"
+#include "drivers/adf4351_config.h"
+#include "drivers/adf4351_spi.h"
 
 // Build timestamp for this specific file
 const char rf_build_time[] = __TIME__;
@@ -13,21 +15,22 @@ const char rf_build_time[] = __TIME__;
 // =============================
 static volatile uint8_t rf_amp_enabled = 0;              // RF amplifier state
 static volatile uint8_t rf_current_power_mode = RF_POWER_LOW;  // Current power mode
+static volatile uint8_t rf_adl5375_enabled = 0;          // ADL5375 output state (DSOP low)
 
 // =============================
-// ADF4351 Configuration Data
+// ADF4351 Channel State
 // =============================
+// Register words come from the per-channel cache built by adf4351_config_init()
+static adf4351_channel_t rf_active_channel = ADF4351_CH_403_040_TEST;
+static uint8_t rf_adf4351_pd_enabled = 0;               // Power-down bit (R2 DB5) state
 
-// ADF4351 register values for 403 MHz output with 25 MHz reference
-// INT = 128, FRAC = 96, MOD = 100 → 25 MHz × (128 + 96/100) = 3224 MHz / 8 = 403 MHz
-const uint32_t adf4351_regs_403mhz[] = {
-    0x00580005,  // R5
-    0x00BC803C,  // R4  
-    0x000004B3,  // R3
-    0x18004E42,  // R2
-    0x080087D1,  // R1
-    0x00400798   // R0
-};
+// =============================
+// ADF4351 Register Shadow Cache
+// =============================
+// Last value written to R0..R5 (write order R5..R0), so that only changed
+// registers are sent. Invalidated whenever the chip may have lost its state.
+static uint32_t adf4351_shadow[ADF4351_REG_COUNT];
+static uint8_t adf4351_shadow_valid = 0;                 // Bit n = Rn shadow is known
 
 // =============================
 // ADF4351 Hardware SPI Driver Functions
@@ -42,44 +45,83 @@ static void adf4351_init_hardware_spi(void) {
     // Pin configuration
     TRISCbits.TRISC0 = 0;   // SDO output
     TRISCbits.TRISC2 = 0;   // SCK output
-    TRISCbits.TRISC3 = 0;   // LE output
+    TRISCbits.TRISC3 = 0;   // LE output (SS1, driven by the SPI module)
     // Note: PPS configuration is done centrally in init_all_pps()
 
-    // SPI Configuration
-    SPI1CON1L = 0x0020;     // MSTEN=1 only
-    SPI1CON1Lbits.CKE = 1;  // CPHA=0 for ADF4351
-    SPI1CON1Lbits.CKP = 0;  // CPOL=0
-    SPI1CON1H = 0x0000;
-    SPI1CON2L = 0x0007;     // 8-bit mode
-    SPI1BRGL = 24;           // 1MHz 
-    
-    // Enable SPI
-    SPI1CON1Lbits.SPIEN = 1;
+    // SPI1: 32-bit words, hardware LE, interrupt-driven queue
+    adf4351_spi_init();
+}
+
+// Queue one register without waiting; the shadow tracks what will be latched
+static void adf4351_queue_register(uint32_t reg_data) {
+    adf4351_spi_enqueue(reg_data, 0);
+
+    // Track last-written value (control bits DB2:DB0 = register number)
+    uint8_t reg_num = reg_data & 0x7;
+    if (reg_num < ADF4351_REG_COUNT) {
+        adf4351_shadow[ADF4351_REG_INDEX(reg_num)] = reg_data;
+        adf4351_shadow_valid |= (1 << reg_num);
+    }
 }
 
+// Blocking single-register write (returns once LE has latched the word)
 void adf4351_write_register(uint32_t reg_data) {
-    LATCbits.LATC3 = 0;  // LE low
-    __delay_us(2);
-    
-    // Send 32 bits as 4 bytes (MSB first)
-    SPI1BUFL = (reg_data >> 24) & 0xFF;
-    while(!SPI1STATLbits.SPIRBF);
-    (void)SPI1BUFL;
-    
-    SPI1BUFL = (reg_data >> 16) & 0xFF;
-    while(!SPI1STATLbits.SPIRBF);
-    (void)SPI1BUFL;
-    
-    SPI1BUFL = (reg_data >> 8) & 0xFF;
-    while(!SPI1STATLbits.SPIRBF);
-    (void)SPI1BUFL;
-    
-    SPI1BUFL = reg_data & 0xFF;
-    while(!SPI1STATLbits.SPIRBF);
-    (void)SPI1BUFL;
-    
-    LATCbits.LATC3 = 1;  // LE high to latch
-    __delay_us(20);
+    adf4351_queue_register(reg_data);
+    adf4351_spi_flush();
+}
+
+void adf4351_shadow_invalidate(void) {
+    adf4351_shadow_valid = 0;
+}
+
+// Diff-based write of a full R5..R0 set: only changed registers are sent,
+// R5 first and R0 last. R0 is also rewritten when a frequency-related bit
+// changed in R1..R4, since the R0 write applies double-buffered settings and
+// starts VCO band selection. Writes are queued and return immediately; the
+// lock wait flushes the queue first. Returns the number of SPI writes queued.
+uint8_t adf4351_write_registers(const uint32_t *regs) {
+    uint8_t writes = 0;
+    uint8_t retune = 0;
+
+    for (uint8_t i = ADF4351_IDX_R5; i < ADF4351_IDX_R0; i++) {
+        uint8_t reg_num = ADF4351_IDX_R0 - i;
+        uint32_t changed;
+
+        if (adf4351_shadow_valid & (1 << reg_num)) {
+            changed = adf4351_shadow[i] ^ regs[i];
+            if (!changed) continue;
+        } else {
+            changed = 0xFFFFFFFFUL;
+        }
+
+        if (reg_num == 2) changed &= ~ADF4351_R2_RUNTIME_MASK;
+        if (reg_num == 4) changed &= ~ADF4351_R4_RUNTIME_MASK;
+        if (changed) retune = 1;
+
+        adf4351_queue_register(regs[i]);
+        writes++;
+    }
+
+    if (retune || !(adf4351_shadow_valid & 0x01) ||
+        adf4351_shadow[ADF4351_IDX_R0] != regs[ADF4351_IDX_R0]) {
+        adf4351_queue_register(regs[ADF4351_IDX_R0]);
+        writes++;
+    }
+
+    return writes;
+}
+
+// Bring the chip to the active channel and power-down state (changed registers only)
+void rf_adf4351_program_registers(void) {
+    const adf4351_config_t *cfg = adf4351_get_channel_config(rf_active_channel);
+    if (!cfg) return;
+
+    uint32_t regs[ADF4351_REG_COUNT];
+    memcpy(regs, cfg->regs, sizeof(regs));
+    if (rf_adf4351_pd_enabled) {
+        regs[ADF4351_IDX_R2] |= ADF4351_R2_PD_BIT;  // Preserve power-down state
+    }
+    adf4351_write_registers(regs);
 }
 
 // =============================
@@ -104,6 +146,8 @@ uint8_t adf4351_verify_lock_status(void) {
 static uint8_t adf4351_wait_for_lock(void) {
     int timeout_ms = ADF4351_LOCK_TIMEOUT_MS;
     
+    adf4351_spi_flush();    // R0 must be latched before lock detect means anything
+
     DEBUG_LOG_FLUSH("Waiting for PLL lock");
     
     while (timeout_ms > 0) {
@@ -127,6 +171,9 @@ static uint8_t adf4351_wait_for_lock(void) {
 
 void rf_init_adf4351(void) {
     DEBUG_LOG_FLUSH("ADF4351 INIT START\r\n");
+
+    // Compute and cache register sets for every channel
+    adf4351_config_init(ADF4351_REF_FREQ_HZ);
     
     // Initialize hardware SPI
     adf4351_init_hardware_spi();
@@ -146,10 +193,8 @@ void rf_init_adf4351(void) {
     
     // Program ADF4351 registers (R5 to R0)
     DEBUG_LOG_FLUSH("Programming ADF4351 registers...\r\n");
-    for(int i = 0; i < 6; i++) {
-        adf4351_write_register(adf4351_regs_403mhz[i]);
-        __delay_ms(2);
-    }
+    adf4351_shadow_invalidate();
+    rf_adf4351_program_registers();
     
     // Wait for PLL lock with retry mechanism
     uint8_t lock_attempts = 0;
@@ -164,17 +209,17 @@ void rf_init_adf4351(void) {
         DEBUG_LOG_FLUSH("\r\n");
         
         if (adf4351_wait_for_lock()) {
-            DEBUG_LOG_FLUSH("ADF4351 initialized successfully at 403.040 MHz\r\n");
+            DEBUG_LOG_FLUSH("ADF4351 initialized successfully at ");
+            debug_print_uint32(adf4351_get_channel_freq_hz(rf_active_channel) / 1000);
+            DEBUG_LOG_FLUSH(" kHz\r\n");
             return; // Success - exit function
         } else {
             DEBUG_LOG_FLUSH("PLL lock attempt failed\r\n");
             if (lock_attempts < max_attempts) {
                 DEBUG_LOG_FLUSH("Reprogramming registers...\r\n");
                 // Reprogram all registers
-                for(int i = 0; i < 6; i++) {
-                    adf4351_write_register(adf4351_regs_403mhz[i]);
-                    __delay_ms(2);
-                }
+                adf4351_shadow_invalidate();
+                rf_adf4351_program_registers();
                 __delay_ms(50); // Extra settling time
             }
         }
@@ -190,23 +235,63 @@ void rf_adf4351_enable_output(uint8_t state) {
 }
 
 void rf_adf4351_power_down(uint8_t enable) {
-    uint32_t reg2_value = adf4351_regs_403mhz[3];  // R2 register
+    rf_adf4351_pd_enabled = enable ? 1 : 0;
+    DEBUG_LOG_FLUSH(enable ? "ADF4351 power-down enabled\r\n" : "ADF4351 power-down disabled\r\n");
 
-    if (enable) {
-        reg2_value |= (1UL << 5);   // Set PD bit (DB5)
-        DEBUG_LOG_FLUSH("ADF4351 power-down enabled\r\n");
-    } else {
-        reg2_value &= ~(1UL << 5);  // Clear PD bit (DB5)
-        DEBUG_LOG_FLUSH("ADF4351 power-down disabled\r\n");
+    // Only R2 differs from the shadow: a single SPI write
+    rf_adf4351_program_registers();
+}
+
+// =============================
+// ADF4351 Channel Selection
+// =============================
+
+// Retune to a cached channel: one table lookup, then R0 (and R1 if MOD changed)
+// R0 restarts the VCO band selection: with the PLL running, wait for lock
+// (one reprogram on timeout, as at init). In power-down the new channel is
+// locked by rf_start_transmission() at power-up.
+// Returns 1 when locked (or powered down), 0 otherwise.
+uint8_t rf_adf4351_set_channel(adf4351_channel_t channel) {
+    if (channel == rf_active_channel) return 1;
+    if (!adf4351_get_channel_config(channel)) {
+        DEBUG_LOG_FLUSH("ADF4351: invalid channel\r\n");
+        return 0;
     }
 
-    adf4351_write_register(reg2_value);
+    rf_active_channel = channel;
+    rf_adf4351_program_registers();
+
+    DEBUG_LOG_FLUSH("ADF4351 channel: ");
+    debug_print_uint32(adf4351_get_channel_freq_hz(channel) / 1000);
+    DEBUG_LOG_FLUSH(" kHz\r\n");
+
+    if (rf_adf4351_pd_enabled) return 1;
+    if (adf4351_wait_for_lock()) return 1;
+
+    DEBUG_LOG_FLUSH("Reprogramming registers...\r\n");
+    adf4351_shadow_invalidate();
+    rf_adf4351_program_registers();
+    if (adf4351_wait_for_lock()) return 1;
+
+    DEBUG_LOG_FLUSH("WARNING: PLL not locked on new channel\r\n");
+    return 0;
+}
+
+adf4351_channel_t rf_adf4351_get_channel(void) {
+    return rf_active_channel;
 }
 
 //============================
 // ADL5375 RF MOdule
 //============================
 void rf_init_adl5375(void) {
+    // I/Q baseband comes from DAC1 or the MCP4922 (see signal_processor.c);
+    // the only digital control is DSOP. Keep the output off until the chain starts.
+    ADL5375_DSOP_TRIS = 0;
+    ADL5375_DSOP_PIN = 1;
+    rf_adl5375_enabled = 0;
+
+    DEBUG_LOG_FLUSH("ADL5375 initialized: output disabled (DSOP=RC6)\r\n");
 }
 
 // =============================
@@ -214,6 +299,10 @@ void rf_init_adl5375(void) {
 // =============================
 
 void rf_adf4351_enable_chip(uint8_t state) {
+    if (!state) {
+        adf4351_spi_flush();          // Don't cut CE under a queued write
+        adf4351_shadow_invalidate();  // Full reprogram required after CE low
+    }
     ADF4351_CE_PIN = state ? 1 : 0;
     DEBUG_LOG_FLUSH(state ? "ADF4351 chip ENABLED\r\n" : "ADF4351 chip DISABLED\r\n");
     
@@ -227,6 +316,13 @@ uint8_t rf_adf4351_wait_for_lock_with_timeout(void) {
 }
 
 void rf_adl5375_enable(uint8_t state) {
+    ADL5375_DSOP_PIN = state ? 0 : 1;
+    __delay_us(1);          // Turn-on settling 220 ns (datasheet)
+    rf_adl5375_enabled = state ? 1 : 0;
+}
+
+uint8_t rf_adl5375_is_enabled(void) {
+    return rf_adl5375_enabled;
 }
 
 //============================
@@ -296,7 +392,9 @@ void rf_control_amplifier_chain(uint8_t state) {
         // 1. Enable ADF4351 LO output
         rf_adf4351_enable_output(1);
         __delay_us(5);             // Wait for LO frequency stability
-        
+
+        // 2. Enable ADL5375 modulator output
+        rf_adl5375_enable(1);
         
         // 3. Enable RA07M4047M power amplifier (last in chain)
         AMP_ENABLE_PIN = 1;
@@ -306,7 +404,9 @@ void rf_control_amplifier_chain(uint8_t state) {
         // Debug confirmation
         DEBUG_LOG_FLUSH("RF Chain ENABLED (");
         DEBUG_LOG_FLUSH((rf_current_power_mode == RF_POWER_HIGH) ? "HIGH" : "LOW");
-        DEBUG_LOG_FLUSH(" power, 403 MHz)\r\n");
+        DEBUG_LOG_FLUSH(" power, ");
+        debug_print_uint32(adf4351_get_channel_freq_hz(rf_active_channel) / 1000);
+        DEBUG_LOG_FLUSH(" kHz)\r\n");
         
     } else {
         // RF chain power-down sequence (reverse order for safety)
@@ -314,7 +414,9 @@ void rf_control_amplifier_chain(uint8_t state) {
         // 1. Disable power amplifier first (prevent overdrive)
         AMP_ENABLE_PIN = 0;
         __delay_us(100);
-        
+
+        // 2. Disable ADL5375 modulator output
+        rf_adl5375_enable(0);
         
         // 3. Disable LO output (keep PLL running, just RF off)
         rf_adf4351_enable_output(0);
@@ -332,8 +434,6 @@ void rf_control_amplifier_chain(uint8_t state) {
 // =============================
 
 void rf_start_transmission(void) {
-    DEBUG_LOG_FLUSH("Starting transmission sequence...\r\n");
-
     // Ensure all RF outputs are OFF before PLL preparation
     rf_adf4351_enable_output(0);
     AMP_ENABLE_PIN = 0;
@@ -367,7 +467,7 @@ void rf_initialize_all_modules(void) {
     
     // Initialize modules in dependency order
     DEBUG_LOG_FLUSH("About to call rf_init_adf4351...\r\n");
-    rf_init_adf4351();           // PLL synthesizer @ 403 MHz
+    rf_init_adf4351();           // PLL synthesizer (cached channel table)
     DEBUG_LOG_FLUSH("rf_init_adf4351 completed\r\n");
     
     DEBUG_LOG_FLUSH("About to call rf_init_adl5375...\r\n");
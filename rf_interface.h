@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "drivers/adf4351_config.h"
 
 // =============================
 // RF Hardware Pin Definitions
@@ -24,7 +25,12 @@
 #define ADF4351_RF_EN_TRIS   TRISCbits.TRISC8
 #define ADF4351_LD_TRIS      TRISCbits.TRISC1
 
-// ADL5375 I/Q Modulator control pins (400 MHz - 6 GHz) - DISABLED
+// Frequency select switch (RB1): 0 = 403 MHz test channel, 1 = 406 MHz channel
+#define RF_FREQ_SELECT_PIN   PORTBbits.RB1
+
+// ADL5375 I/Q Modulator control pins (400 MHz - 6 GHz)
+#define ADL5375_DSOP_PIN     LATCbits.LATC6    // Output disable (high = RF off)
+#define ADL5375_DSOP_TRIS    TRISCbits.TRISC6
 
 // RA07M4047M Power Amplifier control pins (400-520 MHz, 100mW/5W)
 #define AMP_ENABLE_PIN       LATBbits.LATB10  // PA Enable  
@@ -41,18 +47,23 @@
 // =============================
 // ADF4351 PLL Synthesizer Functions
 // =============================
-void rf_init_adf4351(void);                    // Initialize ADF4351 @ 403 MHz
+void rf_init_adf4351(void);                    // Initialize ADF4351 on the active channel
 void rf_adf4351_enable_output(uint8_t state);  // Enable/disable RF output
 void rf_adf4351_power_down(uint8_t enable);    // Enable/disable power-down mode
 uint8_t adf4351_verify_lock_status(void);      // Verify PLL lock with multiple readings
 void adf4351_write_register(uint32_t reg_data); // Write 32-bit register to ADF4351
-extern const uint32_t adf4351_regs_403mhz[6];   // ADF4351 register values for 403MHz
+uint8_t adf4351_write_registers(const uint32_t *regs); // Diff-based R5..R0 write
+void adf4351_shadow_invalidate(void);          // Force next write of all registers
+void rf_adf4351_program_registers(void);       // Write changed registers of the active channel
+uint8_t rf_adf4351_set_channel(adf4351_channel_t channel); // Retune to a cached channel, wait for lock
+adf4351_channel_t rf_adf4351_get_channel(void); // Get active channel
 
 // =============================
 // ADL5375 I/Q Modulator Functions
 // =============================
 void rf_init_adl5375(void);                    // Initialize ADL5375 I/Q modulator
-void rf_adl5375_enable(uint8_t state);         // Enable/disable modulator
+void rf_adl5375_enable(uint8_t state);         // Enable/disable modulator output (DSOP)
+uint8_t rf_adl5375_is_enabled(void);           // Get modulator output state
 
 // =============================
 // RA07M4047M Power Amplifier Functions
@@ -0,0 +1,420 @@
+// sgb_t018.c - Second-Generation Beacon (C/S T.018) OQPSK DSSS Transmit Chain
+//
+// One burst = 300 bits sent in 1 s: 50 preamble bits (0), 202 information
+// bits (main field + rotating field #0), 48 BCH(250,202) parity bits. Bits
+// are split odd -> I, even -> Q; each one is XORed with 256 chips of its
+// channel PRN sequence. Chips are half-sine shaped, Q lagging I by half a
+// chip (OQPSK), and streamed to the MCP4922 by DMA: the refill below turns
+// chips into ready-made SPI words from two small tables, so the per-word
+// cost on the CPU is two table loads.
+//
+// Only the normal-mode PRN initial states are implemented; TEST frames use
+// them with the test-protocol flag (bit 43) set.
+
+#include "includes.h"
+#include "sgb_t018.h"
+#include "system_comms.h"
+#include "system_debug.h"
+#include "signal_processor.h"
+#include "config_store.h"
+#include "tx_scheduler.h"
+#include "drivers/mcp4922_driver.h"
+
+#define SGB_BCH_MASK            ((1ULL << SGB_PARITY_BITS) - 1)
+#define SGB_CHIP_IDLE           2       // Table row: both DACs at mid-scale
+#define SGB_HALF_CHIP           (SGB_SAMPLES_PER_CHIP / 2)
+#define SGB_DMA_WORDS           (4 * SGB_DMA_SAMPLES)   // Two halves, I and Q words
+#define SGB_BEACON_TYPE_ELT_DT  0x3
+#define SGB_ALT_UNKNOWN         0x3FF
+
+static uint8_t sgb_frame[SGB_FRAME_BYTES];
+static volatile uint16_t sgb_dma_buffer[SGB_DMA_WORDS];
+
+// SPI words per chip value (0 = +, 1 = -, SGB_CHIP_IDLE) and sample index.
+// I samples at t = j.Ts, Q words leave half a sample later: Q table at (j + 0.5).Ts.
+static uint16_t sgb_i_words[3][SGB_SAMPLES_PER_CHIP];
+static uint16_t sgb_q_words[3][SGB_SAMPLES_PER_CHIP];
+
+// Chip generator state (DMA interrupt context while active)
+static sgb_prn_t sgb_prn_i, sgb_prn_q;
+static uint32_t sgb_chip = 0;           // Chips started per channel
+static uint8_t sgb_sample = 0;          // Sample within the current I chip
+static uint16_t sgb_word_i = 0, sgb_word_q = 0;  // Rest of the current 16-chip block
+static uint8_t sgb_cur_i = SGB_CHIP_IDLE, sgb_cur_q = SGB_CHIP_IDLE, sgb_prev_q = SGB_CHIP_IDLE;
+static uint8_t sgb_tail_refills = 0;
+static uint16_t sgb_burst_count = 0;
+
+// =============================
+// Frame
+// =============================
+static inline uint8_t sgb_frame_bit(const uint8_t *frame, uint16_t index) {
+    return (frame[index >> 3] >> (7 - (index & 7))) & 1;
+}
+
+// bit = information bit number (1..202), MSB first
+static void sgb_put(uint8_t *frame, uint16_t bit, uint8_t length, uint64_t value) {
+    for (uint8_t i = 0; i < length; i++) {
+        uint16_t index = SGB_PREAMBLE_BITS + bit - 1 + i;
+        uint8_t mask = 0x80 >> (index & 7);
+        if ((value >> (length - 1 - i)) & 1) frame[index >> 3] |= mask;
+        else frame[index >> 3] &= ~mask;
+    }
+}
+
+// Sign flag, then degrees and 1/32768 degree as one integer. |x| = d.1e7 + r
+// (1e-7 degree): units = d.32768 + round(r.256 / 78125), 32-bit only.
+static uint32_t sgb_encode_axis(int32_t x_e7, uint8_t deg_bits) {
+    uint32_t max_units = (deg_bits == 7 ? 90UL : 180UL) << 15;
+    uint32_t a = (x_e7 < 0) ? -(uint32_t)x_e7 : (uint32_t)x_e7;
+    uint16_t deg = __builtin_divud(a, 50000U) / 200U;
+    uint32_t r = a - (uint32_t)deg * GPS_E7_PER_DEG;
+    uint32_t units = ((uint32_t)deg << 15) + ((r << 8) + 78125UL / 2) / 78125UL;
+    if (units > max_units) units = max_units;
+    return ((x_e7 < 0 ? 1UL : 0UL) << (deg_bits + 15)) | units;
+}
+
+// Systematic BCH(250,202): remainder of m(x).x^48 by g(x)
+uint64_t sgb_compute_bch(const uint8_t *frame) {
+    uint64_t reg = 0;
+    for (uint16_t i = 0; i < SGB_INFO_BITS; i++) {
+        uint8_t feedback = (uint8_t)((reg >> (SGB_PARITY_BITS - 1)) & 1) ^
+                           sgb_frame_bit(frame, SGB_PREAMBLE_BITS + i);
+        reg = (reg << 1) & SGB_BCH_MASK;
+        if (feedback) reg ^= SGB_BCH_POLY & SGB_BCH_MASK;
+    }
+    return reg;
+}
+
+// Main field + rotating field #0 (G.008 objective requirements). The 24-bit
+// beacon ID gives the TAC (upper 10 bits) and the 14-bit serial number.
+uint8_t sgb_build_frame(const beacon_frame_params_t *params, uint8_t *frame) {
+    uint16_t altitude = SGB_ALT_UNKNOWN - 1;
+    if (params->alt_m < -400) altitude = 0;
+    else if (params->alt_m < 15952) altitude = (uint16_t)((params->alt_m + 400) / 16);
+
+    memset(frame, 0, SGB_FRAME_BYTES);
+    sgb_put(frame, 1, 16, (params->beacon_id >> 14) & 0x3FF);  // TAC
+    sgb_put(frame, 17, 14, params->beacon_id & 0x3FFF);         // Serial number
+    sgb_put(frame, 31, 10, params->country_code);
+    sgb_put(frame, 41, 1, 0);                                   // No homing
+    sgb_put(frame, 42, 1, 0);                                   // No RLS
+    sgb_put(frame, 43, 1, params->mode == BEACON_MODE_TEST ? 1 : 0);
+    sgb_put(frame, 44, 23, sgb_encode_axis(params->lat_e7, 7));
+    sgb_put(frame, 67, 24, sgb_encode_axis(params->lon_e7, 8));
+    sgb_put(frame, 91, 3, 0);                                   // No vessel ID
+    sgb_put(frame, 94, 44, 0);
+    sgb_put(frame, 138, 3, SGB_BEACON_TYPE_ELT_DT);
+    sgb_put(frame, 141, 14, 0x3FFF);                            // Spare
+
+    sgb_put(frame, 155, 4, 0);                                  // Rotating field #0
+    sgb_put(frame, 159, 6, 0);                                  // Hours since activation
+    sgb_put(frame, 165, 11, 0);                                 // Minutes since location
+    sgb_put(frame, 176, 10, altitude);
+    sgb_put(frame, 186, 8, 0xFF);                               // HDOP/VDOP not available
+    sgb_put(frame, 194, 2, 0);                                  // Manual activation
+    sgb_put(frame, 196, 3, 0x7);                                // Battery not available
+    sgb_put(frame, 199, 2, 0x2);                                // 3D fix
+    sgb_put(frame, 201, 2, 0);
+
+    sgb_put(frame, SGB_INFO_BITS + 1, SGB_PARITY_BITS, sgb_compute_bch(frame));
+    return 1;
+}
+
+// =============================
+// PRN generator (X^23 + X^18 + 1)
+// =============================
+void sgb_prn_init(sgb_prn_t *prn, uint32_t init_state) {
+    prn->state = init_state & SGB_PRN_MASK;
+}
+
+// s[n+23] = s[n+18] ^ s[n]
+uint8_t sgb_prn_next(sgb_prn_t *prn) {
+    uint32_t s = prn->state;
+    uint8_t chip = (uint8_t)(s & 1);
+    uint32_t feedback = ((s >> SGB_PRN_TAP) ^ s) & 1;
+    prn->state = (s >> 1) | (feedback << 22);
+    return chip;
+}
+
+// 16 chips per call, bit k = k-th chip out. The 16 chips entering the
+// register are B[k] = s[n+k] ^ s[n+18+k]; their taps overlap B itself five
+// places lower, so with T = s[n..n+15] ^ s[n+18..n+22]: B = T ^ (B << 5),
+// unrolled to B = T ^ T<<5 ^ T<<10 ^ T<<15. Only 16-bit operations.
+uint16_t sgb_prn_next16(sgb_prn_t *prn) {
+    uint32_t s = prn->state;
+    uint16_t chips = (uint16_t)s;
+    uint16_t t = chips ^ (uint16_t)(s >> SGB_PRN_TAP);
+    uint16_t b = t ^ (t << 5) ^ (t << 10) ^ (t << 15);
+    prn->state = ((s >> SGB_PRN_BLOCK) | ((uint32_t)b << (SGB_PRN_DEGREE - SGB_PRN_BLOCK))) & SGB_PRN_MASK;
+    return chips;
+}
+
+// a.b mod G(x)
+static uint32_t sgb_prn_mulmod(uint32_t a, uint32_t b) {
+    uint32_t r = 0;
+    for (uint8_t i = 0; i < SGB_PRN_DEGREE; i++) {
+        if (b & 1) r ^= a;
+        b >>= 1;
+        a <<= 1;
+        if (a & (1UL << SGB_PRN_DEGREE)) a ^= SGB_PRN_POLY;
+    }
+    return r;
+}
+
+static uint8_t sgb_parity32(uint32_t v) {
+    v ^= v >> 16;
+    v ^= v >> 8;
+    v ^= v >> 4;
+    return (uint8_t)((0x6996 >> (v & 0xF)) & 1);
+}
+
+// Skip 'chips' chips: chip n+k = sum of c_i.s[n+i], c = X^k mod G(X).
+// X^k by square-and-multiply, then one parity per state bit (~40 mulmods
+// for a full-burst jump instead of 38400 steps)
+void sgb_prn_jump(sgb_prn_t *prn, uint32_t chips) {
+    uint32_t r = 1, x = 2, state = 0;
+
+    while (chips) {
+        if (chips & 1) r = sgb_prn_mulmod(r, x);
+        x = sgb_prn_mulmod(x, x);
+        chips >>= 1;
+    }
+    for (uint8_t j = 0; j < SGB_PRN_DEGREE; j++) {
+        state |= (uint32_t)sgb_parity32(prn->state & r) << j;
+        r <<= 1;
+        if (r & (1UL << SGB_PRN_DEGREE)) r ^= SGB_PRN_POLY;
+    }
+    prn->state = state;
+}
+
+// =============================
+// Chip shaping and DMA refill
+// =============================
+static void sgb_build_tables(int16_t amplitude) {
+    for (uint8_t j = 0; j < SGB_SAMPLES_PER_CHIP; j++) {
+        int16_t a_i = (int16_t)lroundf(amplitude * sinf(3.14159265f * j / SGB_SAMPLES_PER_CHIP));
+        int16_t a_q = (int16_t)lroundf(amplitude * sinf(3.14159265f * (j + 0.5f) / SGB_SAMPLES_PER_CHIP));
+        sgb_i_words[0][j] = MCP4922_DAC_A_CMD | ((MCP4922_OFFSET + a_i) & 0x0FFF);
+        sgb_i_words[1][j] = MCP4922_DAC_A_CMD | ((MCP4922_OFFSET - a_i) & 0x0FFF);
+        sgb_i_words[SGB_CHIP_IDLE][j] = MCP4922_DAC_A_CMD | MCP4922_OFFSET;
+        sgb_q_words[0][j] = MCP4922_DAC_B_CMD | ((MCP4922_OFFSET + a_q) & 0x0FFF);
+        sgb_q_words[1][j] = MCP4922_DAC_B_CMD | ((MCP4922_OFFSET - a_q) & 0x0FFF);
+        sgb_q_words[SGB_CHIP_IDLE][j] = MCP4922_DAC_B_CMD | MCP4922_OFFSET;
+    }
+}
+
+static void sgb_reset_chips(void) {
+    sgb_prn_init(&sgb_prn_i, SGB_PRN_INIT_I_NORMAL);
+    sgb_prn_init(&sgb_prn_q, SGB_PRN_INIT_Q_NORMAL);
+    sgb_chip = 0;
+    sgb_sample = 0;
+    sgb_cur_i = sgb_cur_q = sgb_prev_q = SGB_CHIP_IDLE;
+    sgb_tail_refills = 0;
+}
+
+// Chips are produced 16 at a time per channel, already spread by the data
+// bit (a block never straddles two bits), and shifted out one per chip.
+// One more chip period after the last chip carries the second half of the
+// last Q chip; idle after that.
+static void sgb_next_chip(void) {
+    sgb_prev_q = sgb_cur_q;
+    if (sgb_chip < SGB_CHIPS_PER_CHANNEL) {
+        if ((sgb_chip & (SGB_PRN_BLOCK - 1)) == 0) {
+            uint16_t bit = (uint16_t)(sgb_chip / SGB_CHIPS_PER_BIT) << 1;
+            sgb_word_i = sgb_prn_next16(&sgb_prn_i) ^ (sgb_frame_bit(sgb_frame, bit) ? 0xFFFF : 0);
+            sgb_word_q = sgb_prn_next16(&sgb_prn_q) ^ (sgb_frame_bit(sgb_frame, bit + 1) ? 0xFFFF : 0);
+        }
+        sgb_cur_i = sgb_word_i & 1;
+        sgb_cur_q = sgb_word_q & 1;
+        sgb_word_i >>= 1;
+        sgb_word_q >>= 1;
+    } else {
+        sgb_cur_i = sgb_cur_q = SGB_CHIP_IDLE;
+    }
+    if (sgb_chip <= SGB_CHIPS_PER_CHANNEL) sgb_chip++;
+}
+
+// Refill boundaries fall on chip boundaries (SGB_DMA_SAMPLES is a multiple of
+// SGB_SAMPLES_PER_CHIP). The half holding the tail is out two refills later.
+static uint8_t sgb_refill(volatile uint16_t *words, uint16_t count) {
+    for (uint16_t n = 0; n < count; n += 2) {
+        uint8_t j = sgb_sample;
+        if (j == 0) sgb_next_chip();
+        words[n] = sgb_i_words[sgb_cur_i][j];
+        words[n + 1] = (j < SGB_HALF_CHIP) ? sgb_q_words[sgb_prev_q][j + SGB_HALF_CHIP]
+                                           : sgb_q_words[sgb_cur_q][j - SGB_HALF_CHIP];
+        if (++sgb_sample >= SGB_SAMPLES_PER_CHIP) sgb_sample = 0;
+    }
+    if (sgb_chip > SGB_CHIPS_PER_CHANNEL) {
+        return ++sgb_tail_refills < 3;
+    }
+    return 1;
+}
+
+// =============================
+// Transmission
+// =============================
+// Drive level: the I/Q carrier amplitude of the T.001 path (calibrated table).
+// Refused (0) while busy or while a 1 s burst would exceed the duty limit
+uint8_t sgb_transmit(const beacon_frame_params_t *params) {
+    if (signal_processor_get_mode() != MOD_MODE_IQ_MCP4922) {
+        DEBUG_LOG_FLUSH("SGB: needs MOD IQ\r\n");
+        return 0;
+    }
+    if (tx_phase != IDLE_STATE) {
+        DEBUG_LOG_FLUSH("SGB: transmitter busy\r\n");
+        return 0;
+    }
+    uint32_t now = now_ms();
+    if (!tx_sched_can_fire(now, SGB_BURST_DURATION_MS)) {
+        DEBUG_LOG_FLUSH("SGB: duty cycle limit, fits in ");
+        debug_print_uint32(tx_sched_fit_ms(now, SGB_BURST_DURATION_MS) - now);
+        DEBUG_LOG_FLUSH(" ms\r\n");
+        return 0;
+    }
+
+    mcp4922_iq_sample_t carrier = signal_processor_get_iq_carrier(1, 1);
+    sgb_build_tables((int16_t)(carrier.i_code - MCP4922_OFFSET));
+    sgb_build_frame(params, sgb_frame);
+    sgb_reset_chips();
+
+    start_sgb_transmission(sgb_dma_buffer, SGB_DMA_WORDS, SGB_WORD_RATE_HZ, sgb_refill);
+    tx_sched_account(last_tx_time, SGB_BURST_DURATION_MS);
+    sgb_burst_count++;
+    return 1;
+}
+
+// Identity from the stored config, current GPS position, current beacon mode
+uint8_t sgb_transmit_beacon(void) {
+    const beacon_config_t *cfg = config_get();
+    beacon_frame_params_t params;
+
+    frame_params_from_gps(&params);
+    params.beacon_id = cfg->beacon_id;
+    params.country_code = cfg->country_code;
+    params.protocol_code = cfg->protocol_code;
+    params.mode = beacon_mode;
+    return sgb_transmit(&params);
+}
+
+uint8_t sgb_is_active(void) {
+    return tx_phase == SGB_TX;
+}
+
+void sgb_print_status(void) {
+    DEBUG_LOG_FLUSH("SGB: ");
+    DEBUG_LOG_FLUSH(sgb_is_active() ? "active" : "idle");
+    DEBUG_LOG_FLUSH(", bursts ");
+    debug_print_uint16(sgb_burst_count);
+    DEBUG_LOG_FLUSH(", late refills ");
+    debug_print_uint16(mcp4922_dma_get_late_refills());
+    DEBUG_LOG_FLUSH("\r\n");
+}
+
+// =============================
+// Self-test
+// =============================
+// PRN: first 64 chips of the normal-mode I and Q sequences (T.018). Frame and
+// chips: golden vectors from an independent reference implementation.
+static const uint8_t sgb_golden_frame[SGB_FRAME_BYTES] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x34, 0x56, 0x38, 0xC1, 0x57,
+    0xA3, 0x10, 0x0A, 0xEA, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0xFF, 0xF0,
+    0x00, 0x00, 0x0B, 0x9F, 0xE7, 0x8E, 0xB8, 0xCA, 0x51, 0xD8, 0xB4, 0xE0
+};
+
+typedef struct {
+    uint32_t first_chip;
+    uint64_t i_chips;           // 64 chips, first one in the MSB
+    uint64_t q_chips;
+} sgb_golden_chips_t;
+
+static const sgb_golden_chips_t sgb_golden_chips[] = {
+    {0,     0x80000108421284A1ULL, 0x3F8358BAD030F231ULL},  // Preamble: bare PRN
+    {12800, 0x940053B5ADC92249ULL, 0xF693738EAC7B3B7CULL},  // Information bits
+    {38336, 0x0E935B3B01439557ULL, 0x8420200800420000ULL},  // Last 64 chips (parity)
+};
+
+#define SGB_GOLDEN_CHIP_SETS (sizeof(sgb_golden_chips) / sizeof(sgb_golden_chips[0]))
+
+// Block and jump-ahead generators against the 1-chip reference, full burst
+// of both channels. Jump offsets in increasing order.
+static const uint32_t sgb_test_jumps[] = {0, 1, 17, 255, 12800, 38399};
+
+#define SGB_TEST_JUMPS (sizeof(sgb_test_jumps) / sizeof(sgb_test_jumps[0]))
+
+static uint8_t sgb_prn_test(void) {
+    static const uint32_t inits[2] = {SGB_PRN_INIT_I_NORMAL, SGB_PRN_INIT_Q_NORMAL};
+    uint8_t pass = 1;
+
+    for (uint8_t c = 0; c < 2; c++) {
+        sgb_prn_t ref, block, jump;
+        uint8_t next_jump = 0;
+
+        sgb_prn_init(&ref, inits[c]);
+        sgb_prn_init(&block, inits[c]);
+        for (uint32_t n = 0; n < SGB_CHIPS_PER_CHANNEL; n += SGB_PRN_BLOCK) {
+            uint16_t word = 0;
+            for (uint8_t k = 0; k < SGB_PRN_BLOCK; k++) {
+                if (next_jump < SGB_TEST_JUMPS && n + k == sgb_test_jumps[next_jump]) {
+                    sgb_prn_init(&jump, inits[c]);
+                    sgb_prn_jump(&jump, sgb_test_jumps[next_jump]);
+                    if (jump.state != ref.state) pass = 0;
+                    next_jump++;
+                }
+                word |= (uint16_t)sgb_prn_next(&ref) << k;
+            }
+            if (sgb_prn_next16(&block) != word || block.state != ref.state) pass = 0;
+        }
+        if (next_jump != SGB_TEST_JUMPS) pass = 0;
+    }
+    DEBUG_LOG_FLUSH(pass ? "  PASS PRN block + jump\r\n" : "  FAIL PRN block + jump\r\n");
+    return pass;
+}
+
+uint8_t sgb_self_test(void) {
+    beacon_frame_params_t params = {0x123456UL, 227, PROTOCOL_ELT_DT, BEACON_MODE_EXERCISE,
+                                    429546300L, 13644790L, 1080};
+    uint16_t words[2 * SGB_SAMPLES_PER_CHIP * 16];
+    uint64_t i_chips = 0, q_chips = 0;
+    uint8_t set = 0, pass = 1;
+
+    if (sgb_is_active()) {
+        DEBUG_LOG_FLUSH("SGB: transmitter busy\r\n");
+        return 0;
+    }
+
+    if (!sgb_prn_test()) pass = 0;
+
+    sgb_build_frame(&params, sgb_frame);
+    uint8_t ok = (memcmp(sgb_frame, sgb_golden_frame, SGB_FRAME_BYTES) == 0);
+    DEBUG_LOG_FLUSH(ok ? "  PASS frame + BCH\r\n" : "  FAIL frame + BCH\r\n");
+    if (!ok) pass = 0;
+
+    // Run the real refill over the whole burst and read the chips back from
+    // the SPI words: I at its pulse peak, Q at the last sample of the I chip
+    sgb_build_tables(1000);
+    sgb_reset_chips();
+    for (uint32_t chip = 0; chip < SGB_CHIPS_PER_CHANNEL; chip += 16) {
+        sgb_refill(words, 2 * SGB_SAMPLES_PER_CHIP * 16);
+        for (uint8_t c = 0; c < 16; c++) {
+            const uint16_t *w = &words[2 * SGB_SAMPLES_PER_CHIP * c];
+            uint32_t k = chip + c;
+            if (set >= SGB_GOLDEN_CHIP_SETS || k < sgb_golden_chips[set].first_chip) continue;
+
+            i_chips = (i_chips << 1) | (((w[2 * SGB_HALF_CHIP] & 0x0FFF) < MCP4922_OFFSET) ? 1 : 0);
+            q_chips = (q_chips << 1) | (((w[2 * SGB_SAMPLES_PER_CHIP - 1] & 0x0FFF) < MCP4922_OFFSET) ? 1 : 0);
+            if (k == sgb_golden_chips[set].first_chip + 63) {
+                ok = (i_chips == sgb_golden_chips[set].i_chips && q_chips == sgb_golden_chips[set].q_chips);
+                DEBUG_LOG_FLUSH(ok ? "  PASS chips from " : "  FAIL chips from ");
+                debug_print_uint32(sgb_golden_chips[set].first_chip);
+                DEBUG_LOG_FLUSH("\r\n");
+                if (!ok) pass = 0;
+                set++;
+            }
+        }
+    }
+    if (set != SGB_GOLDEN_CHIP_SETS) pass = 0;
+
+    DEBUG_LOG_FLUSH(pass ? "SGB self-test PASS\r\n" : "SGB self-test FAIL\r\n");
+    return pass;
+}
@@ -0,0 +1,61 @@
+// sgb_t018.h - Second-Generation Beacon (C/S T.018) OQPSK DSSS Transmit Chain
+
+#ifndef SGB_T018_H
+#define SGB_T018_H
+
+#include <stdint.h>
+#include "protocol_data.h"
+
+// Frame: 50-bit preamble (all 0) + 202 information bits + 48 BCH(250,202) parity
+#define SGB_PREAMBLE_BITS       50
+#define SGB_INFO_BITS           202
+#define SGB_PARITY_BITS         48
+#define SGB_FRAME_BITS          300
+#define SGB_FRAME_BYTES         ((SGB_FRAME_BITS + 7) / 8)
+#define SGB_BCH_POLY            0x1C7EB85DF3C97ULL  // g(x), degree 48 (t = 6 over GF(2^8))
+
+// Spreading: odd bits on I, even bits on Q, 256 chips per bit and channel,
+// 38400 chip/s per channel, Q delayed by half a chip. 150 bits x 256 chips = 1 s.
+#define SGB_CHIP_RATE_HZ        38400UL
+#define SGB_CHIPS_PER_BIT       256
+#define SGB_CHIPS_PER_CHANNEL   ((uint32_t)(SGB_FRAME_BITS / 2) * SGB_CHIPS_PER_BIT)   // 38400
+#define SGB_BURST_DURATION_MS   1000
+
+// PRN generator: 23-stage LFSR, G(x) = X^23 + X^18 + 1. State bit k holds
+// chip k of the sequence still to come (bit 0 = next chip out).
+#define SGB_PRN_DEGREE          23
+#define SGB_PRN_TAP             18
+#define SGB_PRN_MASK            0x7FFFFFUL
+#define SGB_PRN_POLY            0x840001UL      // X^23 + X^18 + 1
+#define SGB_PRN_BLOCK           16              // Chips per sgb_prn_next16() word
+#define SGB_PRN_INIT_I_NORMAL   0x000001UL      // First chips 8000 0108 4212 84A1
+#define SGB_PRN_INIT_Q_NORMAL   0x1AC1FCUL      // First chips 3F83 58BA D030 F231
+
+// Half-sine chip shaping: samples per chip and channel (MCP4922 words per
+// chip = 2 x this, DAC A and B interleaved)
+#define SGB_SAMPLES_PER_CHIP    4
+#define SGB_WORD_RATE_HZ        (SGB_CHIP_RATE_HZ * SGB_SAMPLES_PER_CHIP * 2)  // 307200
+#define SGB_DMA_SAMPLES         64              // Samples per DMA half buffer (417 us)
+
+typedef struct {
+    uint32_t state;
+} sgb_prn_t;
+
+// Function prototypes
+uint8_t sgb_build_frame(const beacon_frame_params_t *params, uint8_t *frame);
+uint64_t sgb_compute_bch(const uint8_t *frame);
+void sgb_prn_init(sgb_prn_t *prn, uint32_t init_state);
+uint8_t sgb_prn_next(sgb_prn_t *prn);
+uint16_t sgb_prn_next16(sgb_prn_t *prn);
+void sgb_prn_jump(sgb_prn_t *prn, uint32_t chips);
+
+// Transmission (MOD IQ path, MCP4922 fed by DMA)
+uint8_t sgb_transmit(const beacon_frame_params_t *params);
+uint8_t sgb_transmit_beacon(void);
+uint8_t sgb_is_active(void);
+void sgb_print_status(void);
+
+// Test and validation
+uint8_t sgb_self_test(void);
+
+#endif /* SGB_T018_H */
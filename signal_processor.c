@@ -1,10 +1,106 @@
+#include "includes.h"
 #include "signal_processor.h"
 #include "system_comms.h"
+#include "system_debug.h"
+#include "dac_calibration.h"
 #include <math.h>
 #include <stdint.h>
 
 static uint16_t phase_plus_value = 0;
 static uint16_t phase_minus_value = 0;
+static uint16_t carrier_dac_value = 0;
+
+// I/Q table (MCP4922 codes): index = carrier phase state
+typedef enum {
+    IQ_STATE_IDLE = 0,          // Zero amplitude (both channels at bias)
+    IQ_STATE_CARRIER,           // Phase 0
+    IQ_STATE_PHASE_PLUS,        // +PHASE_SHIFT_RADIANS
+    IQ_STATE_PHASE_MINUS,       // -PHASE_SHIFT_RADIANS
+    IQ_STATE_COUNT
+} iq_state_t;
+
+static mcp4922_iq_sample_t iq_table[IQ_STATE_COUNT];
+static volatile modulation_mode_t modulation_mode = MOD_MODE_INTERNAL_DAC;
+
+// =============================
+// Pulse-Shaped Transition Tables
+// =============================
+// One half-symbol per transition type, index = (previous half << 1) | current
+// half, with 1 = +PHASE_SHIFT_RADIANS: 0 = -/-, 1 = -/+, 2 = +/-, 3 = +/+.
+// The phase moves along a raised-cosine over the first shape_rise_samples.
+#define SHAPE_HALF_SAMPLES      (1U << HALF_SYMBOL_LOG2)
+
+static uint16_t shape_dac_table[4][SHAPE_HALF_SAMPLES];
+static mcp4922_iq_sample_t shape_iq_table[4][SHAPE_HALF_SAMPLES];
+static uint16_t shape_rise_samples = 0;
+static uint16_t shape_rise_time_us = SHAPE_RISE_TIME_US;
+
+// =============================
+// NCO Digital IF (internal DAC)
+// =============================
+// 32-bit phase accumulator; the top 10 bits address a quarter-wave sine
+// (2 quadrant bits + 8 index bits). Q15, sin(i * pi / 512), i = 0..256.
+static const int16_t nco_quarter_sine[257] = {
+        0,   201,   402,   603,   804,  1005,  1206,  1407,
+     1608,  1809,  2009,  2210,  2410,  2611,  2811,  3012,
+     3212,  3412,  3612,  3811,  4011,  4210,  4410,  4609,
+     4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,
+     6393,  6590,  6786,  6983,  7179,  7375,  7571,  7767,
+     7962,  8157,  8351,  8545,  8739,  8933,  9126,  9319,
+     9512,  9704,  9896, 10087, 10278, 10469, 10659, 10849,
+    11039, 11228, 11417, 11605, 11793, 11980, 12167, 12353,
+    12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+    14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269,
+    15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673,
+    16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+    18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357,
+    19519, 19680, 19841, 20000, 20159, 20317, 20475, 20631,
+    20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+    22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027,
+    23170, 23311, 23452, 23592, 23731, 23870, 24007, 24143,
+    24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+    25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198,
+    26319, 26438, 26556, 26674, 26790, 26905, 27019, 27133,
+    27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+    28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803,
+    28898, 28992, 29085, 29177, 29268, 29358, 29447, 29534,
+    29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+    30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783,
+    30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297,
+    31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+    31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098,
+    32137, 32176, 32213, 32250, 32285, 32318, 32351, 32382,
+    32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+    32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717,
+    32728, 32737, 32745, 32752, 32757, 32761, 32765, 32766,
+    32767
+};
+
+#define NCO_PHASE_SHIFT_WORD    ((uint32_t)(PHASE_SHIFT_RADIANS / 6.28318531f * 4294967296.0f))
+
+static volatile uint32_t nco_accumulator = 0;
+static volatile uint32_t nco_tuning_word = 0;
+static volatile uint32_t nco_phase_offset = 0;      // Modulation phase (0, +/-1.1 rad)
+static volatile int16_t nco_amplitude = 0;          // Peak swing in DAC codes
+static int16_t nco_full_amplitude = 0;
+static uint16_t nco_bias_code = 0;
+static uint16_t nco_if_hz = 0;
+
+// Bias +/- half swing, same analog levels as the internal DAC path
+// DAC1 code for a carrier phase (calibration applied here, never in the ISR)
+static uint16_t dac_from_phase(float phase) {
+    float voltage = (ADL5375_BIAS_MV / 1000.0f) + (sinf(phase) * (ADL5375_SWING_MV / 2000.0f));
+    return dac_cal_voltage_to_code(voltage);
+}
+
+static mcp4922_iq_sample_t iq_from_phase(float amplitude, float phase) {
+    float bias_code = (ADL5375_BIAS_MV / 1000.0f) * MCP4922_RESOLUTION / VOLTAGE_REF_3V3;
+    float swing_code = (ADL5375_SWING_MV / 2000.0f) * MCP4922_RESOLUTION / VOLTAGE_REF_3V3;
+    mcp4922_iq_sample_t sample;
+    sample.i_code = (uint16_t)lroundf(bias_code + amplitude * cosf(phase) * swing_code);
+    sample.q_code = (uint16_t)lroundf(bias_code + amplitude * sinf(phase) * swing_code);
+    return sample;
+}
 
 void signal_processor_init(void) {
     // Calculate DAC values for ±1.1 rad
@@ -13,12 +109,85 @@ void signal_processor_init(void) {
     float voltage_minus = (ADL5375_BIAS_MV / 1000.0f) + 
                          (sinf(-PHASE_SHIFT_RADIANS) * (ADL5375_SWING_MV / 2000.0f));
     
-    phase_plus_value = (uint16_t)((voltage_plus * DAC_RESOLUTION) / VOLTAGE_REF_3V3);
-    phase_minus_value = (uint16_t)((voltage_minus * DAC_RESOLUTION) / VOLTAGE_REF_3V3);
+    phase_plus_value = dac_cal_voltage_to_code(voltage_plus);
+    phase_minus_value = dac_cal_voltage_to_code(voltage_minus);
+    carrier_dac_value = dac_cal_voltage_to_code(ADL5375_BIAS_MV / 1000.0f);
+
+    // I/Q pairs: cos/sin of the carrier phase for each state
+    iq_table[IQ_STATE_IDLE] = iq_from_phase(0.0f, 0.0f);
+    iq_table[IQ_STATE_CARRIER] = iq_from_phase(1.0f, 0.0f);
+    iq_table[IQ_STATE_PHASE_PLUS] = iq_from_phase(1.0f, PHASE_SHIFT_RADIANS);
+    iq_table[IQ_STATE_PHASE_MINUS] = iq_from_phase(1.0f, -PHASE_SHIFT_RADIANS);
+
+    signal_processor_set_rise_time_us(shape_rise_time_us);
+
+    // NCO: same bias and swing as the DC-level path
+    nco_bias_code = carrier_dac_value;
+    nco_full_amplitude = (int16_t)(dac_cal_voltage_to_code((ADL5375_BIAS_MV + ADL5375_SWING_MV / 2) / 1000.0f) -
+                                   nco_bias_code);
+    if (nco_if_hz == 0) {
+        signal_processor_nco_set_if_hz(NCO_IF_DEFAULT_HZ);
+    }
+}
+
+uint16_t signal_processor_get_carrier_dac_value(void) {
+    return carrier_dac_value;
+}
+
+// Build the four transition tables for a rise time (rounded to whole samples,
+// 0 = hard steps). Returns the rise time actually applied, in samples.
+uint16_t signal_processor_set_rise_time_us(uint16_t rise_time_us) {
+    uint16_t rise = (uint16_t)(((uint32_t)rise_time_us * SAMPLE_RATE_HZ + 500000UL) / 1000000UL);
+    if (rise > SHAPE_HALF_SAMPLES) rise = SHAPE_HALF_SAMPLES;
+    if (tx_phase != IDLE_STATE) return shape_rise_samples;
+    shape_rise_time_us = rise_time_us;
+
+    for (uint8_t type = 0; type < 4; type++) {
+        float from = (type & 0x02) ? PHASE_SHIFT_RADIANS : -PHASE_SHIFT_RADIANS;
+        float to = (type & 0x01) ? PHASE_SHIFT_RADIANS : -PHASE_SHIFT_RADIANS;
+
+        for (uint16_t k = 0; k < SHAPE_HALF_SAMPLES; k++) {
+            // Weight of the previous phase: 1 -> 0 along a raised cosine
+            float w = 0.0f;
+            if (k < rise) {
+                w = 0.5f * (1.0f + cosf(3.14159265f * (k + 0.5f) / rise));
+            }
+            float phase = to + (from - to) * w;
+            shape_dac_table[type][k] = dac_from_phase(phase);
+            shape_iq_table[type][k] = iq_from_phase(1.0f, phase);
+        }
+    }
+    shape_rise_samples = rise;
+    return rise;
+}
+
+uint16_t signal_processor_get_rise_samples(void) {
+    return shape_rise_samples;
+}
+
+// Transition type for a Biphase-L sample. prev_bit = SHAPE_NO_PREV_BIT on the
+// first bit (coming from the carrier): no transition is shaped there.
+static inline uint8_t shape_index(uint8_t prev_bit, uint8_t bit_value, uint8_t second_half) {
+    uint8_t first_plus = (bit_value == 1);
+    if (second_half) {
+        return (first_plus << 1) | !first_plus;
+    }
+    uint8_t prev_plus = (prev_bit == SHAPE_NO_PREV_BIT) ? first_plus : (prev_bit != 1);
+    return (prev_plus << 1) | first_plus;
+}
+
+uint16_t signal_processor_get_shaped_biphase_l_value(uint8_t prev_bit, uint8_t bit_value, uint16_t sample_index) {
+    uint8_t second_half = (sample_index >> HALF_SYMBOL_LOG2) & 0x01;
+    return shape_dac_table[shape_index(prev_bit, bit_value, second_half)][sample_index & HALF_SYMBOL_MASK];
+}
+
+mcp4922_iq_sample_t signal_processor_get_shaped_biphase_l_iq(uint8_t prev_bit, uint8_t bit_value, uint16_t sample_index) {
+    uint8_t second_half = (sample_index >> HALF_SYMBOL_LOG2) & 0x01;
+    return shape_iq_table[shape_index(prev_bit, bit_value, second_half)][sample_index & HALF_SYMBOL_MASK];
 }
 
 uint16_t signal_processor_get_biphase_l_value(uint8_t bit_value, uint16_t sample_index, uint16_t samples_per_bit) {
-    uint16_t half_bit = samples_per_bit / 2;
+    uint16_t half_bit = samples_per_bit >> 1;
     
     // Biphase-L encoding
     if (sample_index < half_bit) {
@@ -29,3 +198,127 @@ uint16_t signal_processor_get_biphase_l_value(uint8_t bit_value, uint16_t sample
         return (bit_value == 1) ? phase_minus_value : phase_plus_value;
     }
 }
+
+// =============================
+// Modulation Mode Selection
+// =============================
+// Only switched between transmissions; returns 1 if the mode was applied
+uint8_t signal_processor_set_mode(modulation_mode_t mode) {
+    if (mode != MOD_MODE_INTERNAL_DAC && mode != MOD_MODE_IQ_MCP4922 &&
+        mode != MOD_MODE_NCO_IF) return 0;
+    if (tx_phase != IDLE_STATE) return 0;
+    if (mode == modulation_mode) return 1;
+
+    // Leave the current mode
+    if (modulation_mode == MOD_MODE_IQ_MCP4922) {
+        modulation_mode = MOD_MODE_INTERNAL_DAC;
+        mcp4922_stream_stop();
+        mcp4922_write_both(iq_table[IQ_STATE_IDLE].i_code, iq_table[IQ_STATE_IDLE].q_code);
+    } else if (modulation_mode == MOD_MODE_NCO_IF) {
+        modulation_mode = MOD_MODE_INTERNAL_DAC;
+        timer1_set_rate_log2(0);
+    }
+
+    // Enter the new one
+    if (mode == MOD_MODE_IQ_MCP4922) {
+        // Pipelined streaming: _T1Interrupt pushes one pair per sample
+        mcp4922_stream_start(0, 0, 0);
+    } else if (mode == MOD_MODE_NCO_IF) {
+        // DAC1 updated every tick, state machine still at SAMPLE_RATE_HZ
+        nco_amplitude = 0;
+        nco_phase_offset = 0;
+        timer1_set_rate_log2(NCO_RATE_LOG2);
+    }
+    modulation_mode = mode;
+
+    if (mode == MOD_MODE_IQ_MCP4922) {
+        DEBUG_LOG_FLUSH("Modulation: I/Q (MCP4922)\r\n");
+    } else if (mode == MOD_MODE_NCO_IF) {
+        DEBUG_LOG_FLUSH("Modulation: NCO IF ");
+        debug_print_uint16(nco_if_hz);
+        DEBUG_LOG_FLUSH(" Hz @ ");
+        debug_print_uint32(NCO_SAMPLE_RATE_HZ);
+        DEBUG_LOG_FLUSH(" Hz\r\n");
+    } else {
+        DEBUG_LOG_FLUSH("Modulation: internal DAC\r\n");
+    }
+    return 1;
+}
+
+modulation_mode_t signal_processor_get_mode(void) {
+    return modulation_mode;
+}
+
+mcp4922_iq_sample_t signal_processor_get_iq_idle(void) {
+    return iq_table[IQ_STATE_IDLE];
+}
+
+// Carrier scaled by level/full_scale around the bias (shutdown ramp)
+mcp4922_iq_sample_t signal_processor_get_iq_carrier(uint16_t level, uint16_t full_scale) {
+    if (level >= full_scale) return iq_table[IQ_STATE_CARRIER];
+
+    mcp4922_iq_sample_t sample = iq_table[IQ_STATE_IDLE];
+    int16_t i_swing = (int16_t)(iq_table[IQ_STATE_CARRIER].i_code - sample.i_code);
+    int16_t q_swing = (int16_t)(iq_table[IQ_STATE_CARRIER].q_code - sample.q_code);
+    sample.i_code += (int16_t)(((int32_t)i_swing * level) / full_scale);
+    sample.q_code += (int16_t)(((int32_t)q_swing * level) / full_scale);
+    return sample;
+}
+
+// =============================
+// NCO Digital IF
+// =============================
+// Tuning word = f_IF * 2^32 / f_s; returns 0 if f_IF is not below Nyquist
+uint8_t signal_processor_nco_set_if_hz(uint16_t if_hz) {
+    if (if_hz == 0 || (uint32_t)if_hz >= (NCO_SAMPLE_RATE_HZ >> 1)) return 0;
+    nco_tuning_word = (uint32_t)((((uint64_t)if_hz << 32) + (NCO_SAMPLE_RATE_HZ >> 1)) / NCO_SAMPLE_RATE_HZ);
+    nco_if_hz = if_hz;
+    return 1;
+}
+
+uint16_t signal_processor_nco_get_if_hz(void) {
+    return nco_if_hz;
+}
+
+// Q15 sine of the top 10 phase bits, quarter-wave table with mirroring
+static inline int16_t nco_sine(uint32_t phase) {
+    uint16_t top = (uint16_t)(phase >> 22);     // 0..1023
+    uint16_t index = top & 0xFF;
+    int16_t value;
+
+    if (top & 0x100) {
+        value = nco_quarter_sine[256 - index];  // Quadrants 2 and 4: mirrored
+    } else {
+        value = nco_quarter_sine[index];
+    }
+    return (top & 0x200) ? -value : value;      // Quadrants 3 and 4: negative
+}
+
+// Carrier state for the next samples. level/full_scale scales the amplitude
+// (shutdown ramp); 0/1 gives the idle output.
+void signal_processor_nco_set_carrier(uint16_t level, uint16_t full_scale) {
+    nco_phase_offset = 0;
+    if (level >= full_scale) {
+        nco_amplitude = nco_full_amplitude;
+    } else {
+        nco_amplitude = (int16_t)(((int32_t)nco_full_amplitude * level) / full_scale);
+    }
+}
+
+// Biphase-L phase state: +1.1 rad or -1.1 rad around the IF carrier
+void signal_processor_nco_set_biphase_l(uint8_t bit_value, uint16_t sample_index) {
+    uint8_t second_half = (sample_index >> HALF_SYMBOL_LOG2) & 0x01;
+    uint8_t plus = second_half ? (bit_value != 1) : (bit_value == 1);
+    nco_amplitude = nco_full_amplitude;
+    nco_phase_offset = plus ? NCO_PHASE_SHIFT_WORD : (uint32_t)(0 - NCO_PHASE_SHIFT_WORD);
+}
+
+// One DAC1 sample per Timer1 tick (integer only)
+uint16_t signal_processor_nco_next(void) {
+    if (nco_amplitude == 0) {
+        return 0;               // Idle: 0V, as in the DC-level path
+    }
+    nco_accumulator += nco_tuning_word;
+    int16_t s = nco_sine(nco_accumulator + nco_phase_offset);
+    return (uint16_t)(nco_bias_code + (int16_t)(((int32_t)s * nco_amplitude) >> 15));
+}
@@ -2,8 +2,47 @@
 #define SIGNAL_PROCESSOR_H
 
 #include <stdint.h>
+#include "system_definitions.h"
+#include "drivers/mcp4922_driver.h"
+
+// Modulation output path
+typedef enum {
+    MOD_MODE_INTERNAL_DAC = 0,  // Single real baseband level on DAC1 (RA3)
+    MOD_MODE_IQ_MCP4922,        // cos/sin pair on MCP4922 A/B -> ADL5375 I/Q
+    MOD_MODE_NCO_IF             // Phase-modulated digital IF on DAC1 (NCO)
+} modulation_mode_t;
+
+// NCO digital IF: Timer1 runs 1 << NCO_RATE_LOG2 times faster than the
+// symbol sample rate; keep NCO_SAMPLE_RATE_HZ within the ISR budget
+#define NCO_RATE_LOG2           2
+#define NCO_SAMPLE_RATE_HZ      ((uint32_t)SAMPLE_RATE_HZ << NCO_RATE_LOG2)    // 25600 Hz at 16x
+#define NCO_IF_DEFAULT_HZ       3000    // Low IF, well below NCO_SAMPLE_RATE_HZ / 2
+
+// Pulse shaping: raised-cosine phase transitions (T.001: rise/fall 150 +/- 100 us)
+#define SHAPE_RISE_TIME_US      150     // Default rise time, rounded to whole samples
+#define SHAPE_NO_PREV_BIT       0xFF    // prev_bit for the first data bit
 
 void signal_processor_init(void);
 uint16_t signal_processor_get_biphase_l_value(uint8_t bit_value, uint16_t sample_index, uint16_t samples_per_bit);
+uint16_t signal_processor_get_carrier_dac_value(void);
+
+// Shaped Biphase-L (sample_index within the symbol, 0..SAMPLES_PER_SYMBOL-1)
+uint16_t signal_processor_set_rise_time_us(uint16_t rise_time_us);
+uint16_t signal_processor_get_rise_samples(void);
+uint16_t signal_processor_get_shaped_biphase_l_value(uint8_t prev_bit, uint8_t bit_value, uint16_t sample_index);
+mcp4922_iq_sample_t signal_processor_get_shaped_biphase_l_iq(uint8_t prev_bit, uint8_t bit_value, uint16_t sample_index);
+
+// I/Q mode
+uint8_t signal_processor_set_mode(modulation_mode_t mode);
+modulation_mode_t signal_processor_get_mode(void);
+mcp4922_iq_sample_t signal_processor_get_iq_idle(void);
+mcp4922_iq_sample_t signal_processor_get_iq_carrier(uint16_t level, uint16_t full_scale);
+
+// NCO digital IF mode
+uint8_t signal_processor_nco_set_if_hz(uint16_t if_hz);
+uint16_t signal_processor_nco_get_if_hz(void);
+void signal_processor_nco_set_carrier(uint16_t level, uint16_t full_scale);
+void signal_processor_nco_set_biphase_l(uint8_t bit_value, uint16_t sample_index);
+uint16_t signal_processor_nco_next(void);
 
 #endif
@@ -8,22 +8,28 @@
 #include "signal_processor.h"
 #include "drivers/mcp4922_driver.h"
 #include "gps_nmea.h"
+#include "gps_pps.h"
+#include "tx_scheduler.h"
+#include "dac_calibration.h"
+#include "config_store.h"
+#include "vbeacon.h"
 
 // RF control function declarations
 extern void rf_start_transmission(void);
 extern void rf_stop_transmission(void);
 extern void control_rf_amplifier(uint8_t enable);
 
+static void timer1_apply_trim(void);
+
 // =================
 // Global Variables 
 // =================
-volatile uint32_t millis_counter = 0;
 volatile uint32_t last_tx_time = 0;
-volatile uint32_t tx_interval_ms = 5000;           // 5 second default interval
 volatile tx_phase_t tx_phase = IDLE_STATE;
 volatile uint16_t bit_index = 0;
 volatile uint16_t sample_count = 0;
 volatile uint8_t beacon_frame[MESSAGE_BITS] = {0};
+volatile uint8_t beacon_frame_bits = LONG_MESSAGE_BITS;  // Bits sent in the data phase
 volatile uint8_t transmission_complete_flag = 0;
 
 // RF timing - empirically calibrated for PLL stability
@@ -32,6 +38,29 @@ volatile uint16_t rf_shutdown_samples = RF_SHUTDOWN_SAMPLES;    // 640 samples (
 
 // Modulation timing
 volatile uint16_t modulation_counter = 0;
+volatile uint16_t modulation_interval = MODULATION_INTERVAL;   // Timer1 ticks per sample
+static volatile uint32_t timer1_tick_rate_hz = SAMPLE_RATE_HZ;
+
+// Armed start: start_transmission() gives the sample, the ISR switches
+// RF_STARTUP -> CARRIER_TX on it (start latency fixed to one sample)
+volatile uint32_t tx_sample_clock = 0;                          // Modulator samples since boot
+static volatile uint32_t tx_arm_sample = 0;
+static volatile uint8_t tx_arm_pending = 0;
+static volatile uint32_t tx_start_sample = 0;                  // Sample the carrier started on
+#define TX_ARM_TIMEOUT_SAMPLES  8                               // Carrier start overdue: abort the burst
+
+// PPS trim: fractional Timer1 period, PR1 = base - 1 or base, carry of a
+// 16-bit phase accumulator
+static volatile uint16_t timer1_trim_base = 0;
+static volatile uint16_t timer1_trim_frac = 0;
+static uint16_t timer1_trim_phase = 0;
+static uint32_t timer1_fcy_hz = FCY;
+static uint8_t timer1_trim = 0;
+
+// ISR load measurement (see isr_load_report)
+static volatile uint32_t isr_load_sum_cycles = 0;
+static volatile uint16_t isr_load_count = 0;
+static volatile uint16_t isr_load_max_cycles = 0;
 
 // Legacy variables for debug compatibility
 volatile uint8_t carrier_phase = 0;
@@ -84,6 +113,12 @@ void init_all_pps(void) {
     // ===== SPI1 (RF - ADF4351) =====
     RPOR8bits.RP48R = 5;   // SDO1 on RC0 (RP48)
     RPOR9bits.RP50R = 6;   // SCK1 on RC2 (RP50)
+    RPOR9bits.RP51R = 7;   // SS1 on RC3 (RP51) - ADF4351 LE
+
+    // ===== SPI2 (MCP4922 DAC) =====
+    RPOR3bits.RP39R = 9;   // SCK2 on RB7 (RP39)
+    RPOR4bits.RP40R = 8;   // SDO2 on RB8 (RP40)
+    RPOR4bits.RP41R = 10;  // SS2 on RB9 (RP41) - MCP4922 CS
 
     // ===== UART2 (Debug) =====
     _RP58R = 0x0003;       // U2TX on RC10 (RP58) - OUTPUT (function 3)
@@ -93,6 +128,9 @@ void init_all_pps(void) {
     _U3RXR = 53;           // U3RX on RC5 (RP53) - INPUT
     _RP52R = 0x0003;       // U3TX on RC4 (RP52) - OUTPUT (function 3)
 
+    // ===== SCCP2 input capture (GPS PPS) =====
+    _ICM2R = GPS_PPS_RP;   // ICM2 on RB5 (RP37) - INPUT
+
     // Lock PPS - ONLY ONCE after all configurations
     __builtin_write_RPCON(0x0800);
 }
@@ -171,8 +209,9 @@ void init_timer1(void) {
     T1CON = 0;
     TMR1 = 0;
 
-    // Calculate period for 6400 Hz sample rate
+    // Calculate period for the sample rate of the oversampling profile
     PR1 = (FCY / SAMPLE_RATE_HZ) - 1;
+    timer1_apply_trim();
 
     T1CONbits.TCKPS = 0;    // No prescaler
     T1CONbits.TCS = 0;      // Internal clock
@@ -181,7 +220,53 @@ void init_timer1(void) {
     IEC0bits.T1IE = 1;
     T1CONbits.TON = 1;
 
-    DEBUG_LOG_FLUSH("Timer1 initialized at 6400 Hz\r\n");
+    DEBUG_LOG_FLUSH("Timer1 initialized at ");
+    debug_print_uint16(SAMPLE_RATE_HZ);
+    DEBUG_LOG_FLUSH(" Hz (");
+    debug_print_uint16(SAMPLES_PER_SYMBOL);
+    DEBUG_LOG_FLUSH(" samples/symbol)\r\n");
+}
+
+// Timer1 at SAMPLE_RATE_HZ << rate_log2. The modulation state machine keeps
+// running at SAMPLE_RATE_HZ (every 1 << rate_log2 ticks); faster ticks are
+// for per-tick generators such as the NCO.
+void timer1_set_rate_log2(uint8_t rate_log2) {
+    uint32_t tick_rate_hz = (uint32_t)SAMPLE_RATE_HZ << rate_log2;
+
+    __builtin_disable_interrupts();
+    T1CONbits.TON = 0;
+    TMR1 = 0;
+    PR1 = (uint16_t)(FCY / tick_rate_hz) - 1;
+    timer1_tick_rate_hz = tick_rate_hz;
+    modulation_interval = MODULATION_INTERVAL << rate_log2;
+    modulation_counter = 0;
+    T1CONbits.TON = 1;
+    __builtin_enable_interrupts();
+    timer1_apply_trim();
+}
+
+// Recompute the optional period trim for the current tick rate and FCY
+// (main loop, 64-bit maths outside the ISR)
+static void timer1_apply_trim(void) {
+    uint32_t tick_rate_hz = timer1_tick_rate_hz;
+    uint32_t period_q16 = 0;
+
+    // Average period = true FCY / nominal rate: ticks are exact
+    if (timer1_trim) period_q16 = (uint32_t)(((uint64_t)timer1_fcy_hz << 16) / tick_rate_hz);
+
+    __builtin_disable_interrupts();
+    timer1_trim_base = (uint16_t)(period_q16 >> 16);
+    timer1_trim_frac = (uint16_t)period_q16;
+    PR1 = timer1_trim ? (uint16_t)(period_q16 >> 16) - 1 : (uint16_t)(FCY / tick_rate_hz) - 1;
+    __builtin_enable_interrupts();
+}
+
+// True FCY (PPS measurement); trim moves the Timer1 period so the sample and
+// symbol rates follow it
+void timer1_set_fcy(uint32_t fcy_hz, uint8_t trim) {
+    timer1_fcy_hz = fcy_hz;
+    timer1_trim = trim;
+    timer1_apply_trim();
 }
 
 // =============================
@@ -193,14 +278,13 @@ uint16_t calculate_idle_dac_value(void) {
 }
 
 uint16_t calculate_carrier_dac_value(void) {
-    // Carrier state: 1.65V bias for ADL5375 with LMV358 filter
-    float bias_voltage = ADL5375_BIAS_MV / 1000.0f;  // Convert mV to V
-    return (uint16_t)((bias_voltage * DAC_RESOLUTION) / VOLTAGE_REF_3V3);
+    // Carrier state: 1.65V bias for ADL5375 with LMV358 filter (precomputed, calibrated)
+    return signal_processor_get_carrier_dac_value();
 }
 
-uint16_t calculate_bpsk_dac_value(uint8_t bit_value, uint16_t sample_index) {
-    // Use existing signal processor for Biphase-L modulation
-    return signal_processor_get_biphase_l_value(bit_value, sample_index, SAMPLES_PER_SYMBOL);
+uint16_t calculate_bpsk_dac_value(uint8_t prev_bit, uint8_t bit_value, uint16_t sample_index) {
+    // Biphase-L with raised-cosine transitions (table lookup, 2-bit index)
+    return signal_processor_get_shaped_biphase_l_value(prev_bit, bit_value, sample_index);
 }
 
 // =============================
@@ -214,23 +298,38 @@ void __attribute__((interrupt, auto_psv)) _T1Interrupt(void) {
         LATBbits.LATB0 = debug_pin_state = !debug_pin_state;
     }
 
-    // Update millisecond counter (6400 Hz = 6.4 samples per ms)
-    static uint16_t ms_accumulator = 0;
-    ms_accumulator += 1000;
-    if (ms_accumulator >= SAMPLE_RATE_HZ) {
-        millis_counter++;
-        ms_accumulator -= SAMPLE_RATE_HZ;
+    // PPS trim: fractional Timer1 period (no write when trim is off)
+    if (timer1_trim_frac) {
+        uint16_t phase = timer1_trim_phase + timer1_trim_frac;
+        PR1 = timer1_trim_base - (phase >= timer1_trim_phase);
+        timer1_trim_phase = phase;
     }
 
+    modulation_mode_t mod_mode = signal_processor_get_mode();
+    uint8_t nco_mode = (mod_mode == MOD_MODE_NCO_IF);
+
     // Main transmission state machine
-    if (++modulation_counter >= MODULATION_INTERVAL) {
+    if (++modulation_counter >= modulation_interval) {
         modulation_counter = 0;
+        tx_sample_clock++;
+
+        // Armed carrier start: first carrier sample on this exact tick
+        if (tx_arm_pending && (int32_t)(tx_sample_clock - tx_arm_sample) >= 0) {
+            tx_arm_pending = 0;
+            tx_start_sample = tx_sample_clock;
+            tx_phase = CARRIER_TX;
+            sample_count = 0;
+            bit_index = 0;
+        }
         uint16_t dac_value = calculate_idle_dac_value();
+        uint8_t iq_mode = (mod_mode == MOD_MODE_IQ_MCP4922);
+        if (nco_mode) signal_processor_nco_set_carrier(0, 1);
+        mcp4922_iq_sample_t iq_sample = signal_processor_get_iq_idle();
 
         switch(tx_phase) {
             case IDLE_STATE:
-                // Idle: DAC at 0V for power saving
-                dac_value = calculate_idle_dac_value();
+                // Idle: DAC at 0V for power saving (or the calibration sweep code)
+                dac_value = dac_cal_sweep_active() ? dac_cal_sweep_code() : calculate_idle_dac_value();
                 break;
 
             case RF_STARTUP:
@@ -241,10 +340,12 @@ void __attribute__((interrupt, auto_psv)) _T1Interrupt(void) {
             case CARRIER_TX:
                 // Unmodulated carrier transmission
                 dac_value = calculate_carrier_dac_value();
+                if (iq_mode) iq_sample = signal_processor_get_iq_carrier(1, 1);
+                if (nco_mode) signal_processor_nco_set_carrier(1, 1);
                 envelope_gain = 1.0f;  // Full power during carrier
                 if (++sample_count >= CARRIER_SAMPLES) {
                     DEBUG_LOG_FLUSH("Carrier phase complete [");
-                    debug_print_uint32(millis_counter);
+                    debug_print_uint32(now_ms());
                     DEBUG_LOG_FLUSH("ms]\r\n");
                     tx_phase = DATA_TX;
                     sample_count = 0;
@@ -255,9 +356,14 @@ void __attribute__((interrupt, auto_psv)) _T1Interrupt(void) {
             case DATA_TX:
                 // Modulated data transmission
                 envelope_gain = 1.0f;  // Full power during data
-                if (bit_index < MESSAGE_BITS) {
+                if (bit_index < beacon_frame_bits) {
                     uint8_t current_bit = beacon_frame[bit_index];
-                    dac_value = calculate_bpsk_dac_value(current_bit, sample_count);
+                    uint8_t prev_bit = bit_index ? beacon_frame[bit_index - 1] : SHAPE_NO_PREV_BIT;
+                    dac_value = calculate_bpsk_dac_value(prev_bit, current_bit, sample_count);
+                    if (iq_mode) {
+                        iq_sample = signal_processor_get_shaped_biphase_l_iq(prev_bit, current_bit, sample_count);
+                    }
+                    if (nco_mode) signal_processor_nco_set_biphase_l(current_bit, sample_count);
 
                     if (++sample_count >= SAMPLES_PER_SYMBOL) {
                         sample_count = 0;
@@ -266,24 +372,45 @@ void __attribute__((interrupt, auto_psv)) _T1Interrupt(void) {
                 } else {
                     // All data transmitted - begin shutdown
                     DEBUG_LOG_FLUSH("Data transmission complete [");
-                    debug_print_uint32(millis_counter);
+                    debug_print_uint32(now_ms());
                     DEBUG_LOG_FLUSH("ms]\r\n");
                     tx_phase = RF_SHUTDOWN;
                     sample_count = 0;
                 }
                 break;
 
+            case SGB_TX:
+                // DMA owns the MCP4922; shut down as soon as the stream ends
+                if (!mcp4922_dma_is_active()) {
+                    DEBUG_LOG_FLUSH("SGB burst complete [");
+                    debug_print_uint32(now_ms());
+                    DEBUG_LOG_FLUSH("ms]\r\n");
+                    tx_phase = RF_SHUTDOWN;
+                    sample_count = rf_shutdown_samples;     // No carrier ramp
+                }
+                break;
+
             case RF_SHUTDOWN:
-                if (sample_count < (rf_shutdown_samples / 2)) {
+                if (sample_count < (rf_shutdown_samples >> 1)) {
                     dac_value = calculate_carrier_dac_value();
+                    if (iq_mode) iq_sample = signal_processor_get_iq_carrier(1, 1);
+                    if (nco_mode) signal_processor_nco_set_carrier(1, 1);
                     envelope_gain = 1.0f;
                     sample_count++;
                 } else if (sample_count < rf_shutdown_samples) {
                     uint16_t bias_dac = calculate_carrier_dac_value();
-                    uint16_t step2_samples = sample_count - (rf_shutdown_samples / 2);
-                    float reduction = (float)step2_samples / (rf_shutdown_samples / 2);
+                    uint16_t step2_samples = sample_count - (rf_shutdown_samples >> 1);
+                    float reduction = (float)step2_samples / (rf_shutdown_samples >> 1);
                     dac_value = (uint16_t)(bias_dac * (1.0f - reduction));
                     envelope_gain = 1.0f - reduction;
+                    if (iq_mode) {
+                        iq_sample = signal_processor_get_iq_carrier((rf_shutdown_samples >> 1) - step2_samples,
+                                                                    rf_shutdown_samples >> 1);
+                    }
+                    if (nco_mode) {
+                        signal_processor_nco_set_carrier((rf_shutdown_samples >> 1) - step2_samples,
+                                                         rf_shutdown_samples >> 1);
+                    }
                     sample_count++;
                 } else {
                     DEBUG_LOG_FLUSH("RF shutdown complete\r\n");
@@ -295,18 +422,79 @@ void __attribute__((interrupt, auto_psv)) _T1Interrupt(void) {
                     transmission_complete_flag = 1;
                     envelope_gain = 0.0f;
                     dac_value = calculate_idle_dac_value();
+                    if (nco_mode) signal_processor_nco_set_carrier(0, 1);
                 }
                 break;
         }
 
-        // Update DAC output
-        DAC1DATH = dac_value & 0x0FFF;
+        // Update DAC output (I/Q mode: MCP4922 carries the signal, DAC1 idles)
+        if (iq_mode && tx_phase != SGB_TX) {
+            mcp4922_stream_push(iq_sample.i_code, iq_sample.q_code);
+            dac_value = calculate_idle_dac_value();
+        }
+        if (!nco_mode) {
+            DAC1DATH = dac_value & 0x0FFF;
+        }
+    }
+
+    // NCO mode: new IF sample on every tick
+    if (nco_mode) {
+        DAC1DATH = signal_processor_nco_next() & 0x0FFF;
+    }
+
+    // ISR load: TMR1 restarted from 0 at the period match
+    uint16_t isr_cycles = TMR1;
+    if (isr_cycles > isr_load_max_cycles) isr_load_max_cycles = isr_cycles;
+    if (isr_load_count < 0xFFFF) {
+        isr_load_sum_cycles += isr_cycles;
+        isr_load_count++;
     }
 
     // Clear interrupt flag
     IFS0bits.T1IF = 0;
 }
 
+// =============================
+// ISR Load Benchmark
+// =============================
+// Cycles from the Timer1 period match to ISR exit (entry latency included),
+// against the sample period. Rebuild with another OVERSAMPLING_LOG2 and
+// compare the reports to choose the profile.
+void isr_load_report(void) {
+    uint32_t sum;
+    uint16_t count, max_cycles;
+
+    __builtin_disable_interrupts();
+    sum = isr_load_sum_cycles;
+    count = isr_load_count;
+    max_cycles = isr_load_max_cycles;
+    isr_load_sum_cycles = 0;
+    isr_load_count = 0;
+    isr_load_max_cycles = 0;
+    __builtin_enable_interrupts();
+
+    uint32_t period = (uint32_t)PR1 + 1;
+    uint16_t avg_cycles = count ? (uint16_t)(sum / count) : 0;
+
+    DEBUG_LOG_FLUSH("ISR load: ");
+    debug_print_uint16(SAMPLES_PER_SYMBOL);
+    DEBUG_LOG_FLUSH(" samples/symbol, ");
+    debug_print_uint16(SAMPLE_RATE_HZ);
+    DEBUG_LOG_FLUSH(" Hz, period ");
+    debug_print_uint32(period);
+    DEBUG_LOG_FLUSH(" cyc, avg ");
+    debug_print_uint16(avg_cycles);
+    DEBUG_LOG_FLUSH(" cyc (");
+    debug_print_uint16((uint16_t)(((uint32_t)avg_cycles * 1000) / period));
+    DEBUG_LOG_FLUSH(" permil), max ");
+    debug_print_uint16(max_cycles);
+    DEBUG_LOG_FLUSH(" cyc (");
+    debug_print_uint16((uint16_t)(((uint32_t)max_cycles * 1000) / period));
+    DEBUG_LOG_FLUSH(" permil), over ");
+    debug_print_uint16(count);
+    DEBUG_LOG_FLUSH(" samples\r\n");
+}
+
 // =============================
 // RF Timing Calibration
 // =============================
@@ -317,61 +505,181 @@ void calibrate_rf_timing(void) {
     DEBUG_LOG_FLUSH("RF startup time: ");
     debug_print_uint16(rf_startup_samples);
     DEBUG_LOG_FLUSH(" samples (");
-    debug_print_uint16((rf_startup_samples * 1000) / SAMPLE_RATE_HZ);
+    debug_print_uint16(((uint32_t)rf_startup_samples * 1000) / SAMPLE_RATE_HZ);
     DEBUG_LOG_FLUSH(" ms)\r\n");
 
     DEBUG_LOG_FLUSH("RF shutdown time: ");
     debug_print_uint16(rf_shutdown_samples);
     DEBUG_LOG_FLUSH(" samples (");
-    debug_print_uint16((rf_shutdown_samples * 1000) / SAMPLE_RATE_HZ);
+    debug_print_uint16(((uint32_t)rf_shutdown_samples * 1000) / SAMPLE_RATE_HZ);
     DEBUG_LOG_FLUSH(" ms)\r\n");
 }
 
 // =============================
 // Transmission Control
 // =============================
-void start_transmission(volatile const uint8_t* data) {
-    static uint8_t first_run = 1;
-    if(first_run) {
-        calibrate_rf_timing();
-        first_run = 0;
+// Sample period in 1/65536 us of the timebase: nominal PR1 counted on the
+// measured FCY, or exact when the PPS trim is on
+static uint32_t tx_sample_period_q16(void) {
+    if (timer1_trim) return (uint32_t)((1000000ULL << 16) / SAMPLE_RATE_HZ);
+
+    uint32_t cycles = (FCY / timer1_tick_rate_hz) * modulation_interval;
+    return (uint32_t)(((uint64_t)cycles * 1000000UL << 16) / timer1_fcy_hz);
+}
+
+// Sample clock and the timebase instant of its last sample boundary (the
+// Timer1 match that produced it); a pending match counts when TMR1 is
+// already past it
+static uint32_t tx_sample_anchor(uint64_t *boundary_us) {
+    __builtin_disable_interrupts();
+    uint32_t clock = tx_sample_clock;
+    uint16_t ticks = modulation_counter;
+    uint16_t period = PR1 + 1;
+    uint16_t tmr = TMR1;
+    if (IFS0bits.T1IF && tmr < (period >> 1)) ticks++;
+    uint64_t t_us = now_us();
+    __builtin_enable_interrupts();
+
+    uint32_t cycles = (uint32_t)ticks * period + tmr;
+    *boundary_us = t_us - (uint64_t)cycles * 1000000UL / timer1_fcy_hz;
+    return clock;
+}
+
+// Carrier start missed: the ISR ends RF_SHUTDOWN on its next sample; with
+// Timer1 stopped the RF chain is turned off here
+static void abort_transmission_start(uint32_t clock, uint32_t armed, uint32_t period_q16) {
+    uint64_t stop_us = now_us() + (((uint64_t)TX_ARM_TIMEOUT_SAMPLES * period_q16) >> 16);
+    while (tx_phase == RF_SHUTDOWN && now_us() < stop_us);
+
+    uint8_t stopped = 0;
+    __builtin_disable_interrupts();
+    if (tx_phase == RF_SHUTDOWN) {
+        tx_phase = IDLE_STATE;
+        sample_count = 0;
+        transmission_complete_flag = 1;
+        stopped = 1;
+    }
+    __builtin_enable_interrupts();
+    if (stopped) {
+        control_rf_amplifier(0);
+        rf_stop_transmission();
+        LED_TX_PIN = 1;
     }
 
-    // Update transmission timestamp
-    last_tx_time = millis_counter;
+    DEBUG_LOG_FLUSH("ERROR: carrier start timed out - sample ");
+    debug_print_uint32(tx_sample_clock);
+    DEBUG_LOG_FLUSH(" (armed ");
+    debug_print_uint32(armed);
+    DEBUG_LOG_FLUSH(", anchor ");
+    debug_print_uint32(clock);
+    DEBUG_LOG_FLUSH(stopped ? "), Timer1 stopped - RF shutdown\r\n" : ") - RF shutdown\r\n");
+}
 
-    // Copy message data
+// The carrier starts on the first modulator sample at or after start_ms
+// (TX_START_ASAP: first sample after the RF warm-up). The warm-up runs here
+// with the DAC idle (RF_STARTUP), the ISR makes the switch on the armed
+// sample, so the start no longer depends on where the main loop is inside
+// the Timer1 period. Interrupts must be enabled. No carrier
+// TX_ARM_TIMEOUT_SAMPLES after the armed sample (Timer1 stopped, arm lost):
+// the burst is aborted through RF_SHUTDOWN and not accounted.
+void start_transmission(volatile const uint8_t* data, uint32_t start_ms) {
+    // Copy message data; the format flag sets the data phase length
     __builtin_disable_interrupts();
     for (uint16_t i = 0; i < MESSAGE_BITS; i++) {
         beacon_frame[i] = data[i];
     }
+    beacon_frame_bits = FRAME_BITS(data);
     __builtin_enable_interrupts();
 
-    // Reset state machine
-    sample_count = 0;
-    bit_index = 0;
+    // Reset state machine, DAC idle until the armed sample
+    tx_phase = RF_STARTUP;
     transmission_complete_flag = 0;
 
-    // Start RF chain
-    DEBUG_LOG_FLUSH("Starting transmission sequence\r\n");
+    // Start RF chain (no log before the carrier: the warm-up lead is tight)
     rf_start_transmission();
     __delay_ms(5);  // Brief RF stabilization
     LED_TX_PIN = 0;  // Turn on TX LED
 
+    // Arm: sample boundary at or after the requested instant
+    uint64_t boundary_us, slot_us = 0;
+    uint32_t period_q16 = tx_sample_period_q16();
+    uint32_t clock = tx_sample_anchor(&boundary_us);
+    uint32_t armed = clock + 1;
+
+    if (start_ms != TX_START_ASAP) {
+        uint64_t base_ms = boundary_us / 1000UL;
+        slot_us = (base_ms + (int64_t)(int32_t)(start_ms - (uint32_t)base_ms)) * 1000UL;
+        if (slot_us > boundary_us) {
+            armed = clock + (uint32_t)((((slot_us - boundary_us) << 16) + period_q16 - 1) / period_q16);
+        }
+    }
+    tx_arm_sample = armed;
+    tx_arm_pending = 1;
+
     // Begin transmission state machine - prepare signal BEFORE RF activation
-    tx_phase = CARRIER_TX;             // Signal DAC → 500mV first
-    __delay_us(2);                    // Let DAC stabilize at 500mV
+    // ISR: DAC → 500mV on the armed sample, bounded a few samples past it
+    uint64_t deadline_us = boundary_us +
+                           (((uint64_t)(armed - clock + TX_ARM_TIMEOUT_SAMPLES) * period_q16) >> 16);
+    uint8_t timed_out = 0;
+    while (tx_phase == RF_STARTUP && !timed_out) {
+        if (now_us() < deadline_us) continue;
+        __builtin_disable_interrupts();
+        if (tx_phase == RF_STARTUP) {               // Not started on the last sample either
+            tx_arm_pending = 0;
+            tx_phase = RF_SHUTDOWN;
+            sample_count = rf_shutdown_samples;     // No carrier ramp
+            timed_out = 1;
+        }
+        __builtin_enable_interrupts();
+    }
+    if (timed_out) {
+        abort_transmission_start(clock, armed, period_q16);
+        return;
+    }
+
+    uint32_t started = tx_start_sample;
+    uint64_t start_us = boundary_us + (((uint64_t)(started - clock) * period_q16) >> 16);
+    last_tx_time = (uint32_t)(start_us / 1000UL);
+    tx_sched_account(last_tx_time, FRAME_BURST_DURATION_MS(beacon_frame_bits));
 
     rf_control_amplifier_chain(1);     // THEN activate RF chain with stable signal
-    DEBUG_LOG_FLUSH("RF carrier ON - ready for modulation [");
-    debug_print_uint32(millis_counter);
+
+    // Per-burst start report: late samples = RF warm-up overran the slot
+    DEBUG_LOG_FLUSH("Transmission sequence started\r\n");
+    DEBUG_LOG_FLUSH("RF carrier ON - sample ");
+    debug_print_uint32(started);
+    DEBUG_LOG_FLUSH(" (armed ");
+    debug_print_uint32(armed);
+    DEBUG_LOG_FLUSH(", late ");
+    debug_print_uint32(started - armed);
+    if (start_ms != TX_START_ASAP) {
+        DEBUG_LOG_FLUSH(", slot ");
+        debug_print_int32((int32_t)(start_us - slot_us));
+        DEBUG_LOG_FLUSH(" us");
+    }
+    DEBUG_LOG_FLUSH(") [");
+    debug_print_uint32(last_tx_time);
     DEBUG_LOG_FLUSH("ms]\r\n");
 }
 
-void set_tx_interval(uint32_t interval_ms) {
-    __builtin_disable_interrupts();
-    tx_interval_ms = interval_ms;
-    __builtin_enable_interrupts();
+// T.018 burst: same RF sequencing, then the MCP4922 DMA stream carries the
+// signal and the state machine waits in SGB_TX until the stream stops
+void start_sgb_transmission(volatile uint16_t *buffer, uint16_t count, uint32_t word_rate_hz,
+                            mcp4922_dma_refill_t refill) {
+    last_tx_time = now_ms();
+    transmission_complete_flag = 0;
+
+    DEBUG_LOG_FLUSH("Starting SGB transmission sequence\r\n");
+    rf_start_transmission();
+    __delay_ms(5);  // Brief RF stabilization
+    LED_TX_PIN = 0;
+
+    mcp4922_dma_start(buffer, count, word_rate_hz, refill);
+    tx_phase = SGB_TX;
+    rf_control_amplifier_chain(1);
+    DEBUG_LOG_FLUSH("SGB stream ON [");
+    debug_print_uint32(now_ms());
+    DEBUG_LOG_FLUSH("ms]\r\n");
 }
 
 // =============================
@@ -379,6 +687,7 @@ void set_tx_interval(uint32_t interval_ms) {
 // =============================
 void system_init(void) {
     init_clock();
+    timebase_init();             // SCCP3 microsecond timebase (before any timeout)
     init_gpio();
     init_all_pps();              // Configure ALL PPS mappings ONCE
     init_dac();
@@ -388,6 +697,11 @@ void system_init(void) {
     mcp4922_init();              // Initialize MCP4922 DAC
     gps_init();                  // Initialize GPS UART3
     init_timer1();
+    gps_pps_init();              // PPS capture (timebase and Timer1 discipline)
+    config_store_init();         // Persistent beacon configuration (RAM copy)
+    vbeacon_init();
+    tx_sched_init();             // First periodic slot right after boot
+    dac_cal_init();              // Load DAC calibration before building tables
     signal_processor_init();
 
     // Initialize RF modules
@@ -397,6 +711,7 @@ void system_init(void) {
     last_tx_time = 0;
     rf_startup_samples = RF_STARTUP_SAMPLES;
     rf_shutdown_samples = RF_SHUTDOWN_SAMPLES;
+    calibrate_rf_timing();       // Report here, not in the first slot's warm-up
 
     // Clear message buffer
     memset((void*)beacon_frame, 0, MESSAGE_BITS);
@@ -2,6 +2,8 @@
 #define SYSTEM_COMMS_H
 
 #include "system_definitions.h"
+#include "drivers/mcp4922_driver.h"
+#include "timebase.h"                     // now_us(), now_ms()
 
 // =============================
 // Hardware Configuration
@@ -31,7 +33,8 @@ typedef enum {
     RF_STARTUP,                 // RF chain initialization and stabilization
     CARRIER_TX,                 // Unmodulated carrier transmission
     DATA_TX,                    // Modulated data transmission
-    RF_SHUTDOWN                 // RF chain clean shutdown
+    RF_SHUTDOWN,                // RF chain clean shutdown
+    SGB_TX                      // T.018 burst, MCP4922 fed by DMA (sgb_t018.c)
 } tx_phase_t;
 
 // =============================
@@ -43,34 +46,41 @@ void init_clock(void);
 void init_gpio(void);
 void init_dac(void);
 void init_timer1(void);
+void timer1_set_rate_log2(uint8_t rate_log2);
+void timer1_set_fcy(uint32_t fcy_hz, uint8_t trim);
 void system_init(void);
 
 // Transmission control
-void start_transmission(volatile const uint8_t* data);
-void set_tx_interval(uint32_t interval_ms);
+#define TX_START_ASAP           0xFFFFFFFFUL    // start_ms: first sample after the RF warm-up
+void start_transmission(volatile const uint8_t* data, uint32_t start_ms);
+void start_sgb_transmission(volatile uint16_t *buffer, uint16_t count, uint32_t word_rate_hz,
+                            mcp4922_dma_refill_t refill);
 
 // Signal processing
-uint16_t calculate_bpsk_dac_value(uint8_t bit_value, uint16_t sample_index);
+uint16_t calculate_bpsk_dac_value(uint8_t prev_bit, uint8_t bit_value, uint16_t sample_index);
 uint16_t calculate_carrier_dac_value(void);
 uint16_t calculate_idle_dac_value(void);
 
 // RF timing calibration
 void calibrate_rf_timing(void);
 
+// ISR load benchmark
+void isr_load_report(void);
+
 // Interrupt Service Routines
 void __attribute__((__interrupt__, __auto_psv__)) _T1Interrupt(void);
 
 // =============================
 // Global Variables
 // =============================
-extern volatile uint32_t millis_counter;           // System time in milliseconds
 extern volatile tx_phase_t tx_phase;               // Current transmission phase
 extern volatile uint32_t last_tx_time;             // Last transmission timestamp
-extern volatile uint32_t tx_interval_ms;           // Transmission interval
 extern volatile uint16_t bit_index;                // Current bit index in message
 extern volatile uint16_t sample_count;             // Sample counter within current phase
 extern volatile uint8_t beacon_frame[MESSAGE_BITS]; // Message data buffer
+extern volatile uint8_t beacon_frame_bits;         // 144 (long) or 112 (short)
 extern volatile uint8_t transmission_complete_flag; // Transmission completion flag
+extern volatile uint32_t tx_sample_clock;          // Modulator samples since boot (ISR)
 
 // RF timing variables
 extern volatile uint16_t rf_startup_samples;       // RF startup time in samples
@@ -78,6 +88,7 @@ extern volatile uint16_t rf_shutdown_samples;      // RF shutdown time in sample
 
 // Legacy variables for debug compatibility
 extern volatile uint16_t modulation_counter;       // Modulation timing counter
+extern volatile uint16_t modulation_interval;      // Timer1 ticks per modulation sample
 extern volatile uint8_t carrier_phase;             // Carrier phase (legacy)
 extern volatile float envelope_gain;               // RF envelope gain
 
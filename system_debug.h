@@ -5,8 +5,6 @@
 #include "system_definitions.h"
 #include "system_comms.h"
 
-extern volatile uint32_t millis_counter;
-
 // =============================
 // Configuration materielle
 // =============================
@@ -10,7 +10,9 @@
 #define CARRIER_DURATION_MS     160     // Unmodulated carrier duration
 #define DATA_DURATION_MS        360     // Modulated data duration
 #define TOTAL_BURST_DURATION_MS 520     // Total burst time (160+360)
-#define MAX_DUTY_CYCLE          0.06    // 6% maximum duty cycle
+#define SHORT_BURST_DURATION_MS 440     // Short message burst (160+280)
+#define FRAME_BURST_DURATION_MS(bits) (CARRIER_DURATION_MS + (uint32_t)(bits) * 1000 / SYMBOL_RATE_HZ)
+#define MAX_DUTY_CYCLE_PERMIL   60      // 6% maximum duty cycle (any 60 s window, tx_scheduler.c)
 
 // RF timing - empirically determined for hardware stability
 #define RF_STARTUP_TIME_MS      1      // Time needed for RF chain stabilization
@@ -18,14 +20,31 @@
 #define PLL_LOCK_TIMEOUT_MS     10      // Maximum time to wait for PLL lock
 
 // Message structure
-#define MESSAGE_BITS            144     // Total bits to transmit
+#define MESSAGE_BITS            144     // Frame buffer size (long message)
+#define LONG_MESSAGE_BITS       144     // Format flag (bit 25) = 1
+#define SHORT_MESSAGE_BITS      112     // Format flag (bit 25) = 0, no PDF-2 / BCH2
+#define FRAME_FORMAT_FLAG_INDEX 24      // beacon_frame[] index of bit 25
+#define FRAME_BITS(frame)       ((frame)[FRAME_FORMAT_FLAG_INDEX] ? LONG_MESSAGE_BITS : SHORT_MESSAGE_BITS)
 #define SYMBOL_RATE_HZ          400     // 400 baud symbol rate (SARSAT standard)
-#define SAMPLES_PER_SYMBOL      16      // Oversampling factor
-#define SAMPLE_RATE_HZ          6400    // Derived sample rate (400 * 16)
+
+// Oversampling profile, selected at build time (-DOVERSAMPLING_LOG2=n):
+// 3 = 8, 4 = 16 (default), 5 = 32, 6 = 64 samples per symbol.
+// Every per-sample index/divide in the modulator uses this as a shift.
+#ifndef OVERSAMPLING_LOG2
+#define OVERSAMPLING_LOG2       4
+#endif
+#if OVERSAMPLING_LOG2 < 3 || OVERSAMPLING_LOG2 > 6
+#error "OVERSAMPLING_LOG2 must be 3..6 (8/16/32/64 samples per symbol)"
+#endif
+#define SAMPLES_PER_SYMBOL      (1U << OVERSAMPLING_LOG2)       // Oversampling factor
+#define HALF_SYMBOL_LOG2        (OVERSAMPLING_LOG2 - 1)         // Samples per half symbol (log2)
+#define HALF_SYMBOL_MASK        ((1U << HALF_SYMBOL_LOG2) - 1)
+#define SAMPLE_RATE_HZ          (SYMBOL_RATE_HZ << OVERSAMPLING_LOG2)  // Derived sample rate (400 * 16)
 
 // Hardware timing calculations
 #define CARRIER_SAMPLES         ((uint32_t)CARRIER_DURATION_MS * SAMPLE_RATE_HZ / 1000)    // 1024
 #define DATA_SAMPLES            ((uint32_t)MESSAGE_BITS * SAMPLES_PER_SYMBOL)              // 2304
+#define SHORT_DATA_SAMPLES      ((uint32_t)SHORT_MESSAGE_BITS * SAMPLES_PER_SYMBOL)        // 1792
 #define RF_STARTUP_SAMPLES      ((uint32_t)RF_STARTUP_TIME_MS * SAMPLE_RATE_HZ / 1000)    // 320
 #define RF_SHUTDOWN_SAMPLES     ((uint32_t)RF_SHUTDOWN_TIME_MS * SAMPLE_RATE_HZ / 1000)   // 64
 
@@ -0,0 +1,19 @@
+// host_debug.c - system_debug.c print API on stdout (tests only)
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "../../system_debug.h"
+
+void debug_print_char(char c) { putchar(c); }
+void debug_print_str(const char *str) { fputs(str, stdout); }
+void debug_full_flush(void) { fflush(stdout); }
+void debug_print_uint16(uint16_t value) { printf("%u", value); }
+void debug_print_int32(int32_t value) { printf("%" PRId32, value); }
+void debug_print_uint32(uint32_t value) { printf("%" PRIu32, value); }
+void debug_print_int(int value) { printf("%d", value); }
+void debug_print_hex(uint8_t value) { printf("%02X", value); }
+void debug_print_hex16(uint16_t value) { printf("%04X", value); }
+void debug_print_hex24(uint32_t value) { printf("%06" PRIX32, value); }
+void debug_print_hex32(uint32_t value) { printf("%08" PRIX32, value); }
+void debug_print_hex64(uint64_t value) { printf("%016" PRIX64, value); }
+void debug_print_float(double value, int precision) { printf("%.*f", precision, value); }
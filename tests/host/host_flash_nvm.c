@@ -0,0 +1,113 @@
+// host_flash_nvm.c - Array-backed flash_nvm.c (tests only)
+
+#include <xc.h>
+#include <string.h>
+#include "../../drivers/flash_nvm.h"
+#include "host_flash_nvm.h"
+
+static uint16_t flash[HOST_FLASH_PAGES][FLASH_NVM_PAGE_WORDS];
+static const volatile void *flash_owner[HOST_FLASH_PAGES];
+static uint32_t flash_erases[HOST_FLASH_PAGES];
+static uint32_t flash_overwrites;
+static uint32_t flash_writes_left;      // 0 = no power loss scheduled
+static uint8_t flash_powered = 1;
+static uint32_t flash_last_write;
+static uint8_t flash_ready;
+
+void host_flash_reset(void) {
+    memset(flash, 0xFF, sizeof(flash));
+    memset(flash_erases, 0, sizeof(flash_erases));
+    flash_overwrites = 0;
+    flash_writes_left = 0;
+    flash_powered = 1;
+    flash_last_write = 0;
+    flash_ready = 1;
+}
+
+uint32_t host_tbladdress(const volatile void *array) {
+    if (!flash_ready) host_flash_reset();
+    for (uint8_t p = 0; p < HOST_FLASH_PAGES; p++) {
+        if (!flash_owner[p]) flash_owner[p] = array;
+        if (flash_owner[p] == array) return HOST_FLASH_BASE + (uint32_t)p * FLASH_NVM_PAGE_PC_UNITS;
+    }
+    return 0;                           // More reserved pages than HOST_FLASH_PAGES
+}
+
+// Word for a PC address, NULL outside the reserved pages
+static uint16_t *flash_word(uint32_t addr) {
+    if (addr < HOST_FLASH_BASE) return NULL;
+    uint32_t offset = addr - HOST_FLASH_BASE;
+    uint32_t page = offset / FLASH_NVM_PAGE_PC_UNITS;
+    if (page >= HOST_FLASH_PAGES || !flash_owner[page]) return NULL;
+    return &flash[page][(offset % FLASH_NVM_PAGE_PC_UNITS) / 2];
+}
+
+void host_flash_power_loss_after(uint32_t writes) {
+    flash_writes_left = writes;
+}
+
+void host_flash_power_up(void) {
+    flash_writes_left = 0;
+    flash_powered = 1;
+}
+
+void host_flash_clear_bits(uint32_t addr, uint16_t mask) {
+    uint16_t *word = flash_word(addr);
+    if (word) *word &= (uint16_t)~mask;
+}
+
+uint32_t host_flash_last_write_addr(void) {
+    return flash_last_write;
+}
+
+uint32_t host_flash_erase_count(uint32_t page_addr) {
+    uint16_t *word = flash_word(page_addr);
+    return word ? flash_erases[(page_addr - HOST_FLASH_BASE) / FLASH_NVM_PAGE_PC_UNITS] : 0;
+}
+
+uint32_t host_flash_overwrites(void) {
+    return flash_overwrites;
+}
+
+static void flash_program(uint16_t *word, uint16_t value) {
+    if (*word != FLASH_NVM_ERASED_WORD) flash_overwrites++;
+    *word &= value;
+}
+
+uint8_t flash_nvm_erase_page(uint32_t page_addr) {
+    if (page_addr & (FLASH_NVM_PAGE_PC_UNITS - 1)) return 0;
+    uint16_t *word = flash_word(page_addr);
+    if (!word || !flash_powered) return 0;
+    memset(word, 0xFF, FLASH_NVM_PAGE_WORDS * sizeof(uint16_t));
+    flash_erases[(page_addr - HOST_FLASH_BASE) / FLASH_NVM_PAGE_PC_UNITS]++;
+    return 1;
+}
+
+uint8_t flash_nvm_write_double(uint32_t addr, uint16_t word0, uint16_t word1) {
+    if (addr & 0x3) return 0;
+    uint16_t *word = flash_word(addr);
+    if (!word || !flash_powered) return 0;
+
+    flash_last_write = addr;
+    flash_program(&word[0], word0);
+    if (flash_writes_left && --flash_writes_left == 0) {
+        flash_powered = 0;              // Torn: second word never programmed
+        return 0;
+    }
+    flash_program(&word[1], word1);
+    return 1;
+}
+
+uint16_t flash_nvm_read_word(uint32_t addr) {
+    uint16_t *word = flash_word(addr);
+    return word ? *word : FLASH_NVM_ERASED_WORD;
+}
+
+// Same CRC-16/CCITT as drivers/flash_nvm.c
+uint16_t flash_nvm_crc16_update(uint16_t crc, uint16_t word) {
+    crc ^= word;
+    for (uint8_t i = 0; i < 16; i++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
@@ -0,0 +1,24 @@
+// host_flash_nvm.h - Array-backed flash_nvm.c for the host tests
+//
+// Each space(prog) array passed to __builtin_tbladdress() gets its own
+// erase page. Programming only clears bits, as on the device. A power loss
+// can be scheduled: the write that reaches it programs its first word only,
+// and nothing reaches the flash afterwards until host_flash_power_up().
+
+#ifndef HOST_FLASH_NVM_H
+#define HOST_FLASH_NVM_H
+
+#include <stdint.h>
+
+#define HOST_FLASH_PAGES        4
+#define HOST_FLASH_BASE         0x00A000UL
+
+void host_flash_reset(void);                        // All pages erased, counters cleared
+void host_flash_power_loss_after(uint32_t writes);  // 0 = never
+void host_flash_power_up(void);
+void host_flash_clear_bits(uint32_t addr, uint16_t mask);
+uint32_t host_flash_last_write_addr(void);
+uint32_t host_flash_erase_count(uint32_t page_addr);
+uint32_t host_flash_overwrites(void);               // Words programmed twice without erase
+
+#endif /* HOST_FLASH_NVM_H */
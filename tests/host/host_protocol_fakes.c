@@ -0,0 +1,44 @@
+// host_protocol_fakes.c - What protocol_data.c needs from the rest of the
+// firmware: the frame buffer, a settable microsecond clock and GPS fix,
+// recorders for the transmit, scheduler and power hand-offs. The CRC module
+// never completes, so the BCH fields come from the software division.
+
+#include "../../includes.h"
+#include "../../system_comms.h"
+#include "../../gps_nmea.h"
+#include "../../tx_scheduler.h"
+#include "../../timebase.h"
+#include "../../rf_interface.h"
+#include "../../drivers/crc_engine.h"
+
+volatile uint8_t beacon_frame[MESSAGE_BITS];
+
+uint64_t host_now_us;
+uint32_t host_tx_count;
+uint32_t host_tx_interval_ms;
+gps_position_t host_gps_published;
+gps_position_t host_gps_position;
+uint8_t host_rf_power_level;
+
+uint64_t now_us(void) { return host_now_us; }
+
+void start_transmission(volatile const uint8_t *data, uint32_t start_ms) {
+    (void)data; (void)start_ms;
+    host_tx_count++;
+}
+
+void tx_sched_set_interval(uint32_t interval_ms) { host_tx_interval_ms = interval_ms; }
+
+void gps_position_publish(const gps_position_t *pos) { host_gps_published = *pos; }
+
+void gps_position_read(gps_position_t *pos) { *pos = host_gps_position; }
+
+void rf_set_power_level(uint8_t level) { host_rf_power_level = level; }
+
+void full_error_diagnostic(void) {}
+
+uint8_t crc_engine_remainder(uint32_t poly, uint8_t degree, const uint32_t *words,
+                             uint8_t count, uint32_t *remainder) {
+    (void)poly; (void)degree; (void)words; (void)count; (void)remainder;
+    return 0;
+}
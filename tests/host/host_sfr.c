@@ -0,0 +1,39 @@
+// host_sfr.c - SFR storage and interrupt masking for the host tests
+
+#include <xc.h>
+
+volatile INTCON2BITS INTCON2bits = {1};
+volatile IFS0BITS IFS0bits;
+volatile IEC0BITS IEC0bits;
+volatile IPC2BITS IPC2bits;
+volatile uint16_t IEC3;
+volatile IEC3BITS IEC3bits;
+volatile uint8_t _U3EIF, _U3EIE, _U3EIP, _DMA1IE;
+
+volatile uint16_t SPI1CON1L, SPI1CON1H, SPI1CON2L, SPI1BRGL, SPI1IMSKL;
+volatile SPI1CON1LBITS SPI1CON1Lbits;
+volatile SPI1CON1HBITS SPI1CON1Hbits;
+volatile SPI1IMSKLBITS SPI1IMSKLbits;
+
+volatile TRISCBITS TRISCbits;
+volatile uint16_t U3MODE, U3MODEH, U3STAH, U3BRG, U3RXREG;
+volatile U3MODEBITS U3MODEbits;
+
+volatile DMACONBITS DMACONbits;
+volatile uint16_t DMAL, DMAH;
+volatile uint16_t DMACH1, DMAINT1, DMASRC1, DMADST1, DMACNT1;
+volatile DMACHBITS DMACH1bits;
+volatile DMAINTBITS DMAINT1bits;
+
+void host_disable_interrupts(void) {
+    INTCON2bits.GIE = 0;
+}
+
+void host_enable_interrupts(void) {
+    INTCON2bits.GIE = 1;
+    host_interrupt_hook();
+}
+
+// Tests with interrupt sources override it
+__attribute__((weak)) void host_interrupt_hook(void) {
+}
@@ -0,0 +1,50 @@
+// host_sgb_fakes.c - What sgb_t018.c needs from the rest of the firmware:
+// the stored configuration, the beacon mode, a settable duty-cycle gate and
+// recorders for the DMA stream start and the airtime accounting
+
+#include "../../includes.h"
+#include "../../system_comms.h"
+#include "../../system_debug.h"
+#include "../../protocol_data.h"
+#include "../../config_store.h"
+#include "../../tx_scheduler.h"
+
+volatile debug_flags_t debug_flags;
+volatile uint32_t last_tx_time;
+uint8_t beacon_mode = BEACON_MODE_EXERCISE;
+
+beacon_config_t host_config;
+volatile uint16_t *host_dma_buffer;
+uint16_t host_dma_count;
+uint32_t host_dma_rate;
+mcp4922_dma_refill_t host_dma_refill;
+uint16_t host_accounted_ms;
+uint32_t host_duty_wait_ms;                 // tx_sched_fit_ms() delay, 0 = fits now
+
+const beacon_config_t *config_get(void) { return &host_config; }
+void frame_params_from_gps(beacon_frame_params_t *params) { (void)params; }
+uint16_t mcp4922_dma_get_late_refills(void) { return 0; }
+
+uint32_t now_ms(void) { return 1000; }
+
+uint32_t tx_sched_fit_ms(uint32_t start_ms, uint16_t duration_ms) {
+    (void)duration_ms;
+    return start_ms + host_duty_wait_ms;
+}
+
+uint8_t tx_sched_can_fire(uint32_t now_ms, uint16_t duration_ms) {
+    return tx_sched_fit_ms(now_ms, duration_ms) == now_ms;
+}
+
+void tx_sched_account(uint32_t start_ms, uint16_t duration_ms) {
+    (void)start_ms;
+    host_accounted_ms = duration_ms;
+}
+
+void start_sgb_transmission(volatile uint16_t *buffer, uint16_t count, uint32_t word_rate_hz,
+                            mcp4922_dma_refill_t refill) {
+    host_dma_buffer = buffer;
+    host_dma_count = count;
+    host_dma_rate = word_rate_hz;
+    host_dma_refill = refill;
+}
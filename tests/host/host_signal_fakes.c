@@ -0,0 +1,22 @@
+// host_signal_fakes.c - What signal_processor.c needs from the rest of the
+// firmware: an idle transmitter, no Timer1/MCP4922 hardware and the ideal
+// (uncalibrated) DAC mapping of dac_calibration.c
+
+#include "../../includes.h"
+#include "../../system_comms.h"
+#include "../../dac_calibration.h"
+
+volatile tx_phase_t tx_phase = IDLE_STATE;
+
+void timer1_set_rate_log2(uint8_t rate_log2) { (void)rate_log2; }
+void mcp4922_stream_start(const mcp4922_iq_sample_t *buffer, uint16_t length, uint8_t loop) {
+    (void)buffer; (void)length; (void)loop;
+}
+void mcp4922_stream_stop(void) {}
+void mcp4922_write_both(uint16_t i_value, uint16_t q_value) { (void)i_value; (void)q_value; }
+
+uint16_t dac_cal_voltage_to_code(float voltage) {
+    if (voltage <= 0.0f) return 0;
+    float code = (voltage * DAC_RESOLUTION) / VOLTAGE_REF_3V3;
+    return (code >= DAC_RESOLUTION - 1) ? (DAC_RESOLUTION - 1) : (uint16_t)code;
+}
@@ -0,0 +1,43 @@
+// host_ubx_fakes.c - What gps_ubx.c needs from gps_nmea.c and the
+// timebase: the position record, a settable millisecond clock and a
+// recorder for the UART3 configuration traffic and baud rate changes
+
+#include "../../includes.h"
+#include "../../gps_nmea.h"
+#include "../../timebase.h"
+
+#define HOST_UART_TX_MAX        256
+#define HOST_UART_BAUD_MAX      8
+
+gps_position_t host_gps_record;
+uint32_t host_gps_publish_count;
+uint32_t host_now_ms;
+
+uint8_t host_uart_tx[HOST_UART_TX_MAX];
+uint16_t host_uart_tx_len;
+uint32_t host_uart_baud[HOST_UART_BAUD_MAX];
+uint16_t host_uart_baud_at[HOST_UART_BAUD_MAX];    // host_uart_tx_len at the change
+uint8_t host_uart_baud_count;
+
+uint32_t now_ms(void) { return host_now_ms; }
+
+void gps_position_publish(const gps_position_t *pos) {
+    host_gps_record = *pos;
+    host_gps_publish_count++;
+}
+
+void gps_position_read(gps_position_t *pos) { *pos = host_gps_record; }
+
+void gps_uart_write(const uint8_t *data, uint16_t length) {
+    for (uint16_t i = 0; i < length && host_uart_tx_len < HOST_UART_TX_MAX; i++) {
+        host_uart_tx[host_uart_tx_len++] = data[i];
+    }
+}
+
+void gps_uart_set_baud(uint32_t baud) {
+    if (host_uart_baud_count < HOST_UART_BAUD_MAX) {
+        host_uart_baud[host_uart_baud_count] = baud;
+        host_uart_baud_at[host_uart_baud_count] = host_uart_tx_len;
+        host_uart_baud_count++;
+    }
+}
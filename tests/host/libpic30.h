@@ -0,0 +1,9 @@
+// libpic30.h - Host stand-in for the XC16 delay helpers (tests only)
+
+#ifndef HOST_LIBPIC30_H
+#define HOST_LIBPIC30_H
+
+#define __delay_ms(ms)  ((void)(ms))
+#define __delay_us(us)  ((void)(us))
+
+#endif /* HOST_LIBPIC30_H */
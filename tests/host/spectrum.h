@@ -0,0 +1,69 @@
+// spectrum.h - Welch power spectrum for the host signal tests
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SPECTRUM_PI 3.14159265358979323846
+
+// In-place radix-2 FFT, n a power of two
+static inline void spectrum_fft(double *re, double *im, uint32_t n) {
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            double t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        double a = -2.0 * SPECTRUM_PI / len;
+        for (uint32_t i = 0; i < n; i += len) {
+            for (uint32_t k = 0; k < len / 2; k++) {
+                double wr = cos(a * k), wi = sin(a * k);
+                double xr = re[i + k + len / 2] * wr - im[i + k + len / 2] * wi;
+                double xi = re[i + k + len / 2] * wi + im[i + k + len / 2] * wr;
+                re[i + k + len / 2] = re[i + k] - xr;
+                im[i + k + len / 2] = im[i + k] - xi;
+                re[i + k] += xr;
+                im[i + k] += xi;
+            }
+        }
+    }
+}
+
+// Averaged |X|^2 of Hann-windowed segments of n points, 50 % overlap.
+// psd[k] for bin k (negative frequencies from n/2 up). Complex input; a real
+// signal passes im = NULL.
+static inline void spectrum_welch(const double *re, const double *im, uint32_t length,
+                           uint32_t n, double *psd, double *work_re, double *work_im) {
+    uint32_t segments = 0;
+
+    memset(psd, 0, n * sizeof(double));
+    for (uint32_t start = 0; start + n <= length; start += n / 2) {
+        for (uint32_t i = 0; i < n; i++) {
+            double w = 0.5 - 0.5 * cos(2.0 * SPECTRUM_PI * i / n);
+            work_re[i] = re[start + i] * w;
+            work_im[i] = im ? im[start + i] * w : 0.0;
+        }
+        spectrum_fft(work_re, work_im, n);
+        for (uint32_t k = 0; k < n; k++) {
+            psd[k] += work_re[k] * work_re[k] + work_im[k] * work_im[k];
+        }
+        segments++;
+    }
+    for (uint32_t k = 0; k < n && segments; k++) {
+        psd[k] /= segments;
+    }
+}
+
+// Signed frequency of bin k
+static inline double spectrum_bin_hz(uint32_t k, uint32_t n, double fs) {
+    return (k < n / 2 ? (double)k : (double)k - n) * fs / n;
+}
+
+#endif /* SPECTRUM_H */
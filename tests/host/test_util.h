@@ -0,0 +1,31 @@
+// test_util.h - Minimal assertion helpers for the host tests
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ_U(a, b) do { \
+    unsigned long long va_ = (unsigned long long)(a), vb_ = (unsigned long long)(b); \
+    if (va_ != vb_) { \
+        printf("FAIL %s:%d: %s == %s (0x%llX != 0x%llX)\n", __FILE__, __LINE__, #a, #b, va_, vb_); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define TEST_DONE() do { \
+    if (test_failures) printf("%d check(s) FAILED\n", test_failures); \
+    else printf("PASS\n"); \
+    return test_failures ? 1 : 0; \
+} while (0)
+
+#endif /* TEST_UTIL_H */
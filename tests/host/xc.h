@@ -0,0 +1,108 @@
+// xc.h - Host stand-in for the XC16 device header (tests only)
+//
+// SFRs are plain variables (host_sfr.c). Registers a test has to observe
+// access by access (SPI1 buffers and status, UART3 transmit and status) are
+// routed through functions the test provides. Interrupt unmasking calls host_interrupt_hook() so a
+// test can deliver a pending interrupt where the CPU would take it. Only
+// the registers used by the modules built in tests/CMakeLists.txt exist.
+
+#ifndef HOST_XC_H
+#define HOST_XC_H
+
+#include <stdint.h>
+
+void host_disable_interrupts(void);
+void host_enable_interrupts(void);
+void host_interrupt_hook(void);
+
+#define __builtin_disable_interrupts()  host_disable_interrupts()
+#define __builtin_enable_interrupts()   host_enable_interrupts()
+#define __builtin_nop()                 ((void)0)
+#define __builtin_divud(num, den)       ((uint16_t)((uint32_t)(num) / (uint16_t)(den)))
+
+// Program-space arrays get an address in the array-backed flash (host_flash_nvm.c)
+uint32_t host_tbladdress(const volatile void *array);
+#define __builtin_tbladdress(array)     host_tbladdress(array)
+
+typedef struct { unsigned GIE:1; } INTCON2BITS;
+extern volatile INTCON2BITS INTCON2bits;
+
+// =============================
+// Interrupt controller
+// =============================
+typedef struct { unsigned T1IF:1; unsigned SPI1RXIF:1; } IFS0BITS;
+typedef struct { unsigned T1IE:1; unsigned SPI1RXIE:1; } IEC0BITS;
+typedef struct { unsigned SPI1RXIP:3; } IPC2BITS;
+typedef struct { unsigned U3RXIE:1; } IEC3BITS;
+extern volatile IFS0BITS IFS0bits;
+extern volatile IEC0BITS IEC0bits;
+extern volatile IPC2BITS IPC2bits;
+extern volatile uint16_t IEC3;
+extern volatile IEC3BITS IEC3bits;
+extern volatile uint8_t _U3EIF, _U3EIE, _U3EIP, _DMA1IE;
+
+// =============================
+// SPI1 (ADF4351)
+// =============================
+typedef struct {
+    unsigned SPIEN:1; unsigned MSTEN:1; unsigned MODE32:1; unsigned MODE16:1;
+    unsigned CKE:1; unsigned CKP:1; unsigned DISSDI:1; unsigned ENHBUF:1;
+} SPI1CON1LBITS;
+typedef struct { unsigned MSSEN:1; unsigned FRMPOL:1; unsigned FRMEN:1; } SPI1CON1HBITS;
+typedef struct {
+    unsigned SPIRBF:1; unsigned SPIRBE:1; unsigned SPITBF:1; unsigned SPITBE:1;
+    unsigned SPIROV:1; unsigned SRMT:1;
+} SPI1STATLBITS;
+typedef struct { unsigned SPIRBFEN:1; } SPI1IMSKLBITS;
+
+extern volatile uint16_t SPI1CON1L, SPI1CON1H, SPI1CON2L, SPI1BRGL, SPI1IMSKL;
+extern volatile SPI1CON1LBITS SPI1CON1Lbits;
+extern volatile SPI1CON1HBITS SPI1CON1Hbits;
+extern volatile SPI1IMSKLBITS SPI1IMSKLbits;
+
+// Every access is seen by the test's SPI1 model (time advances on status reads)
+volatile uint16_t *host_spi1_buf(uint8_t high);
+volatile SPI1STATLBITS *host_spi1_statl(void);
+#define SPI1BUFL        (*host_spi1_buf(0))
+#define SPI1BUFH        (*host_spi1_buf(1))
+#define SPI1STATLbits   (*host_spi1_statl())
+
+// =============================
+// PORTC, UART3 (GPS), DMA
+// =============================
+typedef struct { unsigned TRISC4:1; unsigned TRISC5:1; } TRISCBITS;
+extern volatile TRISCBITS TRISCbits;
+
+typedef struct {
+    unsigned UARTEN:1; unsigned UTXEN:1; unsigned URXEN:1; unsigned BRGH:1; unsigned MOD:4;
+} U3MODEBITS;
+typedef struct {
+    unsigned OERR:1; unsigned FERIF:1; unsigned TRMT:1; unsigned OERIE:1; unsigned FERIE:1;
+} U3STABITS;
+typedef struct { unsigned UTXBF:1; unsigned URXISEL:3; } U3STAHBITS;
+
+extern volatile uint16_t U3MODE, U3MODEH, U3STAH, U3BRG, U3RXREG;
+extern volatile U3MODEBITS U3MODEbits;
+
+// Every access is seen by the test's UART3 model (writes reach the receiver)
+volatile uint16_t *host_u3txreg(void);
+volatile U3STABITS *host_u3sta(void);
+volatile U3STAHBITS *host_u3stah(void);
+#define U3TXREG         (*host_u3txreg())
+#define U3STAbits       (*host_u3sta())
+#define U3STAHbits      (*host_u3stah())
+
+typedef struct { unsigned DMAEN:1; unsigned PRSSEL:1; } DMACONBITS;
+typedef struct {
+    unsigned CHEN:1; unsigned SIZE:1; unsigned TRMODE:2; unsigned SAMODE:2; unsigned DAMODE:2;
+    unsigned RELOAD:1;
+} DMACHBITS;
+typedef struct { unsigned CHSEL:7; } DMAINTBITS;
+
+extern volatile DMACONBITS DMACONbits;
+extern volatile uint16_t DMAL, DMAH;
+extern volatile uint16_t DMACH1, DMAINT1, DMASRC1, DMADST1, DMACNT1;
+extern volatile DMACHBITS DMACH1bits;
+extern volatile DMAINTBITS DMAINT1bits;
+
+#endif /* HOST_XC_H */
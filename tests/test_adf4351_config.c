@@ -0,0 +1,100 @@
+// test_adf4351_config.c - ADF4351 register math against the datasheet
+//
+// Datasheet worked example, the legacy hand-computed 403 MHz table, and for
+// every T.001 channel the register fields decoded back to the output
+// frequency and checked against the datasheet limits.
+
+#include "../includes.h"
+#include "../drivers/adf4351_config.h"
+#include "host/test_util.h"
+
+// R0..R5 field decode (datasheet register maps)
+#define R0_INT(r)       (((r) >> 15) & 0xFFFF)
+#define R0_FRAC(r)      (((r) >> 3) & 0x0FFF)
+#define R1_PRESC(r)     (((r) >> 27) & 1)
+#define R1_MOD(r)       (((r) >> 3) & 0x0FFF)
+#define R2_R(r)         (((r) >> 14) & 0x03FF)
+#define R2_LDF(r)       (((r) >> 8) & 1)
+#define R4_DIVSEL(r)    (((r) >> 20) & 7)
+#define R4_BANDDIV(r)   (((r) >> 12) & 0xFF)
+
+static void test_datasheet_example(void) {
+    adf4351_config_t cfg;
+
+    // REFin 10 MHz, RFout 2112.6 MHz, 100 kHz channels: INT = 422,
+    // FRAC/MOD = 26/50, RF divider 2, fPFD 10 MHz
+    CHECK(adf4351_compute_config(10000000UL, 2112600000UL, 100000UL, &cfg));
+    CHECK_EQ_U(cfg.int_value, 422);
+    CHECK_EQ_U(cfg.rf_div_sel, 1);
+    CHECK_EQ_U(cfg.pfd_hz, 10000000UL);
+    CHECK_EQ_U((uint32_t)cfg.frac * 50, (uint32_t)cfg.mod * 26);
+    CHECK_EQ_U(cfg.prescaler_8_9, 1);
+}
+
+static void test_legacy_403mhz(void) {
+    // Hand-computed table shipped before the engine: INT = 128,
+    // FRAC/MOD = 243/250, /8 (the legacy R2 had double buffering off)
+    static const uint32_t legacy[ADF4351_REG_COUNT] = {
+        0x00580005, 0x00BC803C, 0x000004B3, 0x18004E42, 0x080087D1, 0x00400798
+    };
+    adf4351_config_t cfg;
+
+    CHECK(adf4351_compute_config(ADF4351_REF_FREQ_HZ, 403037500UL, 12500UL, &cfg));
+    cfg.regs[ADF4351_IDX_R2] &= ~ADF4351_R2_DOUBLE_BUF_BIT;
+    for (uint8_t i = 0; i < ADF4351_REG_COUNT; i++) {
+        CHECK_EQ_U(cfg.regs[i], legacy[i]);
+    }
+}
+
+static void test_channel_table(void) {
+    adf4351_config_init(ADF4351_REF_FREQ_HZ);
+
+    for (uint8_t ch = 0; ch < ADF4351_CHANNEL_COUNT; ch++) {
+        const adf4351_config_t *cfg = adf4351_get_channel_config((adf4351_channel_t)ch);
+        CHECK(cfg != 0);
+        if (!cfg) continue;
+
+        uint32_t r0 = cfg->regs[ADF4351_IDX_R0], r1 = cfg->regs[ADF4351_IDX_R1];
+        uint32_t r2 = cfg->regs[ADF4351_IDX_R2], r4 = cfg->regs[ADF4351_IDX_R4];
+
+        // Control bits DB2:DB0 select the register
+        for (uint8_t i = 0; i < ADF4351_REG_COUNT; i++) {
+            CHECK_EQ_U(cfg->regs[i] & 7, ADF4351_IDX_R0 - i);
+        }
+
+        // RFout = fPFD x (INT + FRAC/MOD) / 2^DIVSEL, from the register words
+        uint32_t pfd = ADF4351_REF_FREQ_HZ / R2_R(r2);
+        uint64_t vco_x_mod = (uint64_t)pfd * (R0_INT(r0) * R1_MOD(r1) + R0_FRAC(r0));
+        CHECK_EQ_U(vco_x_mod % R1_MOD(r1), 0);
+        uint64_t vco = vco_x_mod / R1_MOD(r1);
+        CHECK_EQ_U(vco >> R4_DIVSEL(r4), adf4351_get_channel_freq_hz((adf4351_channel_t)ch));
+
+        // Datasheet limits
+        CHECK(vco >= ADF4351_VCO_MIN_HZ && vco <= ADF4351_VCO_MAX_HZ);
+        CHECK(pfd <= ADF4351_PFD_MAX_FRAC_HZ);
+        CHECK(pfd / R4_BANDDIV(r4) <= ADF4351_BAND_SEL_MAX_HZ);
+        CHECK(R1_MOD(r1) >= 2);
+        CHECK(R0_FRAC(r0) < R1_MOD(r1));
+        CHECK(R0_INT(r0) >= (R1_PRESC(r1) ? ADF4351_INT_MIN_PRESC_8_9 : ADF4351_INT_MIN_PRESC_4_5));
+        CHECK_EQ_U(R2_LDF(r2), R0_FRAC(r0) == 0);
+    }
+}
+
+static void test_rejects(void) {
+    adf4351_config_t cfg;
+
+    CHECK(!adf4351_compute_config(ADF4351_REF_FREQ_HZ, 30000000UL, 1000UL, &cfg));     // VCO below range even /64
+    CHECK(!adf4351_compute_config(ADF4351_REF_FREQ_HZ, 406025000UL, 7UL, &cfg));       // Step does not divide fPFD
+    CHECK(!adf4351_compute_config(ADF4351_REF_FREQ_HZ, 406025001UL, 1UL, &cfg));       // MOD > 4095
+    CHECK(!cfg.valid);
+    CHECK(!adf4351_compute_config(0, 406025000UL, 1000UL, &cfg));
+    CHECK(!adf4351_get_channel_config(ADF4351_CHANNEL_COUNT));
+}
+
+int main(void) {
+    test_datasheet_example();
+    test_legacy_403mhz();
+    test_channel_table();
+    test_rejects();
+    TEST_DONE();
+}
@@ -0,0 +1,264 @@
+// test_adf4351_spi.c - SPI1 queue against a model of SPI1 and the ADF4351
+//
+// The model sees every SPI1BUFL/SPI1BUFH access in order. In 32-bit mode the
+// word is pushed by the BUFH write, so BUFL must come first. Pushed words are
+// shifted out MSB first at the configured clock, framed by SS1 (= LE) as set
+// up in SPI1CON1H, and clocked into a 32-bit ADF4351 shift register that
+// latches on the LE rising edge. Completion raises SPI1RXIF; the ISR runs
+// when interrupts are unmasked, as on the CPU.
+
+#include "../includes.h"
+#include "../drivers/adf4351_spi.h"
+#include "host/test_util.h"
+
+#define MODEL_MAX_WORDS     64
+#define MODEL_MAX_STEPS     100000
+
+void _SPI1RXInterrupt(void);
+
+static struct {
+    // Access being performed (classified at the next model event)
+    volatile uint16_t cell;
+    int8_t pending;                 // -1 none, 0 BUFL, 1 BUFH
+    uint8_t pending_read;
+
+    uint16_t tx_low;
+    uint8_t tx_low_valid;
+    uint32_t shifting;
+    uint8_t busy;                   // Word in the shift register
+    uint8_t rx_halves;              // RX halves still to read (2 = word unread)
+
+    // ADF4351 side
+    uint32_t adf_shift;
+    uint32_t latched[MODEL_MAX_WORDS];
+    uint8_t frame_clocks[MODEL_MAX_WORDS];
+    uint8_t latch_count;
+    uint8_t le_low;
+
+    uint16_t order_errors;          // BUFH before BUFL, overrun, read of an empty buffer
+    uint32_t steps;
+    uint8_t in_isr;
+} model;
+
+static volatile SPI1STATLBITS model_stat;
+
+// ADF4351: data sampled on the CLK rising edge while LE is low, register
+// latched on the LE rising edge (datasheet timing diagram)
+static void model_shift_word(uint32_t word) {
+    uint8_t frame_bits = SPI1CON1Lbits.MODE32 ? 32 : (SPI1CON1Lbits.MODE16 ? 16 : 8);
+    uint8_t sample_rising = (SPI1CON1Lbits.CKP == 0 && SPI1CON1Lbits.CKE == 1);
+    uint8_t clocks = 0;
+    uint8_t prev_bit = 0;
+
+    // SS1 is LE only with MSSEN; active low with FRMPOL = 0
+    uint8_t le_framed = SPI1CON1Hbits.MSSEN && !SPI1CON1Hbits.FRMPOL;
+
+    for (int8_t b = frame_bits - 1; b >= 0; b--) {
+        if (le_framed && b == frame_bits - 1) model.le_low = 1;
+        uint8_t bit = (word >> b) & 1;
+        // Wrong clock phase: the ADF4351 sees the previous data bit
+        model.adf_shift = (model.adf_shift << 1) | (sample_rising ? bit : prev_bit);
+        prev_bit = bit;
+        clocks++;
+    }
+    if (le_framed && model.le_low) {
+        model.le_low = 0;
+        if (model.latch_count < MODEL_MAX_WORDS) {
+            model.frame_clocks[model.latch_count] = clocks;
+            model.latched[model.latch_count++] = model.adf_shift;
+        }
+    }
+}
+
+// Finish the access started by the previous host_spi1_buf() call
+static void model_commit_access(void) {
+    if (model.pending < 0) return;
+    uint8_t high = (uint8_t)model.pending;
+    model.pending = -1;
+
+    if (model.pending_read) {
+        // Drain of the RX word: BUFL then BUFH
+        if ((high && model.rx_halves != 1) || (!high && model.rx_halves != 2)) model.order_errors++;
+        if (model.rx_halves) model.rx_halves--;
+        if (!model.rx_halves) {
+            model_stat.SPIRBE = 1;
+            model_stat.SPIRBF = 0;
+        }
+        return;
+    }
+
+    if (!high) {
+        model.tx_low = model.cell;
+        model.tx_low_valid = 1;
+        return;
+    }
+    // BUFH write pushes the 32-bit word
+    if (!model.tx_low_valid || model.busy) model.order_errors++;
+    model.shifting = ((uint32_t)model.cell << 16) | model.tx_low;
+    model.tx_low_valid = 0;
+    model.busy = 1;
+}
+
+static void model_deliver_interrupts(void) {
+    while (!model.in_isr && INTCON2bits.GIE && IEC0bits.SPI1RXIE && IFS0bits.SPI1RXIF) {
+        model.in_isr = 1;
+        _SPI1RXInterrupt();
+        model.in_isr = 0;
+    }
+}
+
+// One step of bus time: the word in flight completes
+static void model_advance(void) {
+    model_commit_access();
+    if (++model.steps > MODEL_MAX_STEPS) {
+        printf("FAIL: SPI1 model step limit (driver stuck)\n");
+        exit(1);
+    }
+    if (model.busy) {
+        model_shift_word(model.shifting);
+        model.busy = 0;
+        if (model.rx_halves) {
+            model_stat.SPIROV = 1;
+            model.order_errors++;
+        }
+        model.rx_halves = 2;
+        model_stat.SPIRBE = 0;
+        model_stat.SPIRBF = 1;
+        if (SPI1IMSKLbits.SPIRBFEN) IFS0bits.SPI1RXIF = 1;
+    }
+}
+
+volatile uint16_t *host_spi1_buf(uint8_t high) {
+    model_commit_access();
+    model.pending = (int8_t)high;
+    model.pending_read = (model.rx_halves != 0);
+    model.cell = 0xFFFF;            // DISSDI: no MISO, reads return idle high
+    return &model.cell;
+}
+
+volatile SPI1STATLBITS *host_spi1_statl(void) {
+    model_advance();
+    return &model_stat;
+}
+
+void host_interrupt_hook(void) {
+    model_commit_access();
+    model_deliver_interrupts();
+}
+
+// Main loop running with interrupts enabled until the bus is idle
+static void model_run_idle(void) {
+    do {
+        model_advance();
+        model_deliver_interrupts();
+    } while (model.busy || model.rx_halves || adf4351_spi_busy());
+}
+
+static void model_reset(void) {
+    memset((void *)&model, 0, sizeof(model));
+    model.pending = -1;
+    model_stat.SPIRBE = 1;
+    model_stat.SPIRBF = 0;
+    model_stat.SPIROV = 0;
+    IFS0bits.SPI1RXIF = 0;
+    INTCON2bits.GIE = 1;
+    adf4351_spi_init();
+}
+
+static uint32_t callback_words[MODEL_MAX_WORDS];
+static uint8_t callback_count;
+
+static void record_callback(uint32_t reg_data) {
+    if (callback_count < MODEL_MAX_WORDS) callback_words[callback_count++] = reg_data;
+}
+
+// Six registers of a channel, R5 first (control bits in DB2:0)
+static const uint32_t regs[6] = {
+    0x00580005, 0x00BC803C, 0x000004B3, 0x18005E42, 0x080087D1, 0x00400798
+};
+
+static void test_configuration(void) {
+    model_reset();
+    CHECK(SPI1CON1Lbits.SPIEN && SPI1CON1Lbits.MSTEN);
+    CHECK(SPI1CON1Lbits.MODE32);
+    CHECK(SPI1CON1Hbits.MSSEN && !SPI1CON1Hbits.FRMPOL);
+    CHECK(SPI1IMSKLbits.SPIRBFEN && IEC0bits.SPI1RXIE);
+
+    // Fastest clock the ADF4351 accepts (t1/t2 >= 25 ns -> 20 MHz)
+    uint32_t sck = FCY / (2UL * (SPI1BRGL + 1));
+    CHECK(sck <= ADF4351_SPI_MAX_HZ);
+    CHECK(SPI1BRGL == 0 || FCY / (2UL * SPI1BRGL) > ADF4351_SPI_MAX_HZ);
+    CHECK_EQ_U(adf4351_spi_get_clock_hz(), sck);
+}
+
+static void test_interrupt_driven(void) {
+    model_reset();
+    callback_count = 0;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        CHECK(adf4351_spi_enqueue(regs[i], record_callback));   // Returns without waiting
+    }
+    model_run_idle();
+
+    CHECK_EQ_U(model.order_errors, 0);
+    CHECK_EQ_U(model.latch_count, 6);
+    CHECK_EQ_U(callback_count, 6);
+    for (uint8_t i = 0; i < 6; i++) {
+        CHECK_EQ_U(model.latched[i], regs[i]);
+        CHECK_EQ_U(model.frame_clocks[i], 32);      // One LE frame per register
+        CHECK_EQ_U(callback_words[i], regs[i]);
+    }
+    CHECK(!model_stat.SPIROV);
+}
+
+static void test_masked_flush(void) {
+    model_reset();
+    callback_count = 0;
+
+    // Caller with GIE = 0 (Timer1 ISR, critical section): the queue must
+    // not unmask interrupts and flush must complete by polling
+    __builtin_disable_interrupts();
+    for (uint8_t i = 0; i < 3; i++) {
+        adf4351_spi_enqueue(regs[i], record_callback);
+    }
+    adf4351_spi_flush();
+    CHECK(!INTCON2bits.GIE);
+    __builtin_enable_interrupts();
+
+    CHECK(!adf4351_spi_busy());
+    CHECK_EQ_U(model.order_errors, 0);
+    CHECK_EQ_U(model.latch_count, 3);
+    CHECK_EQ_U(callback_count, 3);
+    for (uint8_t i = 0; i < 3; i++) {
+        CHECK_EQ_U(model.latched[i], regs[i]);
+    }
+}
+
+static void test_queue_full(void) {
+    model_reset();
+    callback_count = 0;
+    uint8_t waited = 0;
+
+    __builtin_disable_interrupts();
+    for (uint8_t i = 0; i < 12; i++) {
+        if (!adf4351_spi_enqueue(0x01000000UL * i + (i % 6), record_callback)) waited++;
+    }
+    adf4351_spi_flush();
+    __builtin_enable_interrupts();
+
+    CHECK(waited > 0);                              // Full queue drained in place
+    CHECK_EQ_U(model.order_errors, 0);
+    CHECK_EQ_U(model.latch_count, 12);
+    for (uint8_t i = 0; i < 12; i++) {
+        CHECK_EQ_U(model.latched[i], 0x01000000UL * i + (i % 6));
+    }
+    CHECK_EQ_U(callback_count, 12);
+}
+
+int main(void) {
+    test_configuration();
+    test_interrupt_driven();
+    test_masked_flush();
+    test_queue_full();
+    TEST_DONE();
+}
@@ -0,0 +1,204 @@
+// test_config_store.c - Wear-levelled configuration records on array flash
+//
+// Runs config_store.c against host_flash_nvm.c: reload after each save,
+// both page swaps, records torn by a power loss (mid record and first
+// record after a swap), a corrupted CRC, the 16-bit sequence wrap, a save
+// refused during a transmission and the duty-cycle floor of the intervals.
+
+#include "../includes.h"
+#include "../config_store.h"
+#include "../system_debug.h"
+#include "../rf_interface.h"
+#include "../system_comms.h"
+#include "../protocol_layout.h"
+#include "../tx_scheduler.h"
+#include "../drivers/flash_nvm.h"
+#include "host/host_flash_nvm.h"
+#include "host/test_util.h"
+
+volatile debug_flags_t debug_flags;
+volatile tx_phase_t tx_phase = IDLE_STATE;
+
+// Page addresses in the order config_store.c first asks for them
+#define PAGE_A      HOST_FLASH_BASE
+#define PAGE_B      (HOST_FLASH_BASE + FLASH_NVM_PAGE_PC_UNITS)
+
+static uint32_t saved_id;
+static uint32_t slots_per_page;         // Measured by test_page_swaps
+
+static uint8_t save_id(uint32_t id) {
+    beacon_config_t cfg = *config_get();
+    cfg.beacon_id = id;
+    if (!config_set(&cfg)) return 0;
+    return config_save();
+}
+
+// Power cycle: RAM copy from flash only
+static uint32_t reboot_id(void) {
+    host_flash_power_up();
+    config_store_init();
+    return config_get()->beacon_id;
+}
+
+static void test_empty(void) {
+    host_flash_reset();
+    config_store_init();
+    CHECK(!config_is_stored());
+    CHECK_EQ_U(config_get()->beacon_id, 0x123456);
+
+    // Out-of-range edits never reach the RAM copy
+    beacon_config_t cfg = *config_get();
+    cfg.beacon_id = 0x1000000UL;
+    CHECK(!config_set(&cfg));
+    cfg = *config_get();
+    cfg.exercise_power = 7;
+    CHECK(!config_set(&cfg));
+    CHECK_EQ_U(config_get()->exercise_power, RF_POWER_HIGH);
+}
+
+static void test_page_swaps(void) {
+    host_flash_reset();
+    config_store_init();
+
+    // Fill page A, swap to B, fill B, swap back to A
+    uint32_t saves = 0;
+    while (host_flash_erase_count(PAGE_A) == 0 && saves < 2 * FLASH_NVM_PAGE_WORDS) {
+        if (host_flash_erase_count(PAGE_B) == 1 && !slots_per_page) slots_per_page = saves - 1;
+        saved_id = 0x100000UL + saves;
+        CHECK(save_id(saved_id));
+        saves++;
+        CHECK_EQ_U(reboot_id(), saved_id);
+        CHECK(config_is_stored());
+    }
+    CHECK_EQ_U(host_flash_erase_count(PAGE_A), 1);
+    CHECK_EQ_U(host_flash_erase_count(PAGE_B), 1);
+    CHECK(slots_per_page > 1);
+    CHECK_EQ_U(saves, 2 * slots_per_page + 1);
+    CHECK_EQ_U(host_flash_overwrites(), 0);
+}
+
+static void test_torn_records(void) {
+    host_flash_reset();
+    config_store_init();
+    CHECK(save_id(0x0A0001));
+    CHECK(save_id(0x0A0002));
+    saved_id = 0x0A0002;
+
+    // Power lost after the first double word of the next record
+    host_flash_power_loss_after(1);
+    CHECK(!save_id(0x0A0003));
+    CHECK_EQ_U(reboot_id(), saved_id);
+
+    // Power lost on the last double word
+    host_flash_power_loss_after(4);
+    CHECK(!save_id(0x0A0004));
+    CHECK_EQ_U(reboot_id(), saved_id);
+
+    // Saving goes on after the torn slots
+    CHECK(save_id(0x0A0005));
+    CHECK_EQ_U(reboot_id(), 0x0A0005);
+
+    // Failed write without a reset: the retry must not reprogram that slot
+    host_flash_power_loss_after(2);
+    CHECK(!save_id(0x0A0006));
+    host_flash_power_up();
+    CHECK(save_id(0x0A0007));
+    CHECK_EQ_U(reboot_id(), 0x0A0007);
+
+    // Corrupted newest record (bit cleared in its last double word): CRC rejects it
+    host_flash_clear_bits(host_flash_last_write_addr(), 0x0001);
+    CHECK_EQ_U(reboot_id(), 0x0A0005);
+    CHECK_EQ_U(host_flash_overwrites(), 0);
+}
+
+static void test_torn_after_swap(void) {
+    host_flash_reset();
+    config_store_init();
+
+    // Page A full: the next save erases page B and loses power there
+    for (uint32_t i = 0; i < slots_per_page; i++) CHECK(save_id(0x0B0000 + i));
+    saved_id = 0x0B0000 + slots_per_page - 1;
+    host_flash_power_loss_after(1);
+    CHECK(!save_id(0x0BFFFF));
+    CHECK_EQ_U(host_flash_erase_count(PAGE_B), 1);
+    CHECK_EQ_U(reboot_id(), saved_id);              // Page A still holds it
+    CHECK(save_id(0x0BFFFE));
+    CHECK_EQ_U(reboot_id(), 0x0BFFFE);
+    CHECK_EQ_U(host_flash_erase_count(PAGE_A), 0);
+}
+
+static void test_sequence_wrap(void) {
+    host_flash_reset();
+    config_store_init();
+
+    // Newest record must win across the 0xFFFF -> 0 wrap
+    for (uint32_t i = 0; i < 0x10010UL; i++) {
+        if (!save_id(0x0C0000 + (i & 0xFFFF))) {
+            CHECK(0);
+            break;
+        }
+    }
+    CHECK_EQ_U(reboot_id(), 0x0C000F);
+    CHECK(save_id(0x0CFFFF));
+    CHECK_EQ_U(reboot_id(), 0x0CFFFF);
+}
+
+// No flash access while the modulator runs (page erase stalls Timer1)
+static void test_busy(void) {
+    host_flash_reset();
+    config_store_init();
+    CHECK(save_id(0x0A0A0A));
+
+    // Next save needs the page swap: the erase must not happen mid-burst
+    while (host_flash_erase_count(PAGE_B) == 0) {
+        uint32_t last = host_flash_last_write_addr();
+        tx_phase = DATA_TX;
+        CHECK(!save_id(0x0B0B0B));
+        CHECK_EQ_U(host_flash_last_write_addr(), last);
+        CHECK_EQ_U(host_flash_erase_count(PAGE_B), 0);
+        tx_phase = IDLE_STATE;
+        CHECK(save_id(0x0C0C0C));
+    }
+    CHECK_EQ_U(reboot_id(), 0x0C0C0C);
+}
+
+// Intervals never below what the scheduler sends (long 9920 ms, short 7490 ms)
+static void test_interval_floor(void) {
+    host_flash_reset();
+    config_store_init();
+    beacon_config_t cfg = *config_get();
+    CHECK(cfg.test_interval_ms >= TX_SCHED_MIN_PERIOD_MS);
+
+    cfg.test_interval_ms = MIN_TX_INTERVAL_MS;
+    CHECK(!config_set(&cfg));
+    CHECK(config_raise_intervals(&cfg));
+    CHECK_EQ_U(cfg.test_interval_ms, TX_SCHED_MIN_PERIOD_MS);
+    CHECK(!config_raise_intervals(&cfg));
+    CHECK(config_set(&cfg));
+
+    // Short protocol: lower floor; back to long raises both again
+    cfg.protocol_code = PROTOCOL_SHORT_FLAG | PROTOCOL_USER_SERIAL;
+    cfg.test_interval_ms = TX_SCHED_MIN_PERIOD_FOR(SHORT_BURST_DURATION_MS);
+    cfg.exercise_interval_ms = TX_SCHED_MIN_PERIOD_FOR(SHORT_BURST_DURATION_MS);
+    CHECK(config_set(&cfg));
+    beacon_config_t low = cfg;
+    low.test_interval_ms--;
+    CHECK(!config_set(&low));
+    cfg.protocol_code = PROTOCOL_ELT_DT;
+    CHECK(!config_set(&cfg));
+    CHECK(config_raise_intervals(&cfg));
+    CHECK_EQ_U(cfg.test_interval_ms, TX_SCHED_MIN_PERIOD_MS);
+    CHECK_EQ_U(cfg.exercise_interval_ms, TX_SCHED_MIN_PERIOD_MS);
+    CHECK(config_set(&cfg));
+}
+
+int main(void) {
+    test_empty();
+    test_page_swaps();
+    test_torn_records();
+    test_torn_after_swap();
+    test_sequence_wrap();
+    test_busy();
+    test_interval_floor();
+    TEST_DONE();
+}
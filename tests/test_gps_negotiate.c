@@ -0,0 +1,438 @@
+// test_gps_negotiate.c - gps_init() startup negotiation against fake receivers
+//
+// A scripted u-blox or MediaTek receiver talks to the UART3/DMA1 model:
+// NMEA epochs once per second paced at its own baud rate, garbage when
+// U3BRG is set for another rate, PUBX,40/41 and PMTK314/251 commands taken
+// from U3TXREG byte by byte. DMA1 writes into the firmware's ring at
+// DMADST1, so gps_nmea.c is compiled into this file to give the model that
+// static buffer. Built with GPS_NMEA_BAUD 38400 to exercise the rate change.
+
+#define GPS_NMEA_BAUD   38400
+#include "../gps_nmea.c"
+#include "host/test_util.h"
+
+volatile uint8_t gps_updated;
+
+int32_t gps_deg_to_e7(double deg) {
+    return (int32_t)lround(deg * GPS_E7_PER_DEG);
+}
+
+#define MODEL_STEP_US   100         // Model time per now_ms() call
+#define RX_EPOCH_US     1000000UL
+
+// Sentences a receiver can output, in PMTK314 field order where it has one
+enum { RX_GLL, RX_RMC, RX_VTG, RX_GGA, RX_GSA, RX_GSV, RX_ZDA, RX_MSG_COUNT };
+
+static const char * const rx_msg_names[RX_MSG_COUNT] = { "GLL", "RMC", "VTG", "GGA", "GSA", "GSV", "ZDA" };
+static const uint8_t pmtk314_field[RX_MSG_COUNT] = { 0, 1, 2, 3, 4, 5, 17 };
+
+typedef enum { RX_NONE, RX_UBLOX, RX_MTK } rx_vendor_t;
+
+typedef struct {
+    rx_vendor_t vendor;
+    uint32_t baud;
+    uint8_t accept_baud;            // Honours PUBX,41 / PMTK251
+    uint8_t rate[RX_MSG_COUNT];     // Output every n epochs, 0 = off
+    uint32_t phase_us;              // Epoch output start within the second
+
+    char out[1024];
+    uint16_t out_len, out_pos;
+    uint32_t epoch;
+    uint64_t next_byte_us;
+
+    char cmd[96];
+    uint8_t cmd_len;
+    uint16_t cmds, cmds_bad, baud_cmds, garbled;
+} fake_rx_t;
+
+static struct {
+    uint64_t us;
+    fake_rx_t rx;
+    uint16_t tx_cell;
+    uint8_t tx_pending;
+    U3STABITS sta;
+    U3STAHBITS stah;
+    uint16_t dma_start;
+    uint8_t dma_latched;
+    uint16_t dma_count;
+    uint16_t dma_errors;            // Writes outside the ring
+    uint16_t rx_overruns;           // Bytes with DMA1 off
+    uint32_t garbage;
+} model;
+
+static uint32_t rng_state = 0x1234567;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525UL + 1013904223UL;
+    return rng_state >> 8;
+}
+
+static uint16_t brg_for(uint32_t baud) {
+    return (uint16_t)((FCY / (16UL * baud)) - 1);
+}
+
+// UART3 and the receiver agree on the rate (the BRG divisors are within 3%)
+static uint8_t rates_match(void) {
+    uint32_t uart_baud = FCY / (16UL * ((uint32_t)U3BRG + 1));
+    uint32_t diff = uart_baud > model.rx.baud ? uart_baud - model.rx.baud : model.rx.baud - uart_baud;
+    return diff * 100 < model.rx.baud * 3;
+}
+
+// =============================
+// Receiver
+// =============================
+static void rx_append(const char *body) {
+    fake_rx_t *rx = &model.rx;
+    uint8_t checksum = 0;
+    for (const char *p = body; *p; p++) checksum ^= (uint8_t)*p;
+    rx->out_len += (uint16_t)snprintf(&rx->out[rx->out_len], sizeof(rx->out) - rx->out_len,
+                                      "$%s*%02X\r\n", body, checksum);
+}
+
+static void rx_build_epoch(void) {
+    fake_rx_t *rx = &model.rx;
+    const char *talker = rx->vendor == RX_UBLOX ? "GN" : "GP";
+    uint32_t tod = 36000UL + rx->epoch;
+    char body[96];
+
+    rx->out_len = rx->out_pos = 0;
+    for (uint8_t m = 0; m < RX_MSG_COUNT; m++) {
+        if (!rx->rate[m] || rx->epoch % rx->rate[m]) continue;
+        switch (m) {
+            case RX_GGA:
+                snprintf(body, sizeof(body), "%sGGA,%02lu%02lu%02lu.00,4257.27780,N,00121.86874,E,1,09,1.0,520.4,M,49.6,M,,",
+                         talker, (unsigned long)(tod / 3600), (unsigned long)(tod / 60 % 60),
+                         (unsigned long)(tod % 60));
+                break;
+            case RX_RMC:
+                snprintf(body, sizeof(body), "%sRMC,%02lu%02lu%02lu.00,A,4257.27780,N,00121.86874,E,0.01,,181026,,,A",
+                         talker, (unsigned long)(tod / 3600), (unsigned long)(tod / 60 % 60),
+                         (unsigned long)(tod % 60));
+                break;
+            case RX_GSV:
+                rx_append("GPGSV,3,1,11,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45");
+                rx_append("GPGSV,3,2,11,15,55,120,44,17,33,295,42,19,12,155,38,24,60,045,47");
+                snprintf(body, sizeof(body), "GPGSV,3,3,11,25,05,010,30,29,15,250,36,32,43,180,44");
+                break;
+            default:
+                snprintf(body, sizeof(body), "%s%s,filler,%lu", talker, rx_msg_names[m], (unsigned long)rx->epoch);
+                break;
+        }
+        rx_append(body);
+    }
+    rx->epoch++;
+}
+
+static uint8_t rx_field(const char *cmd, uint8_t index, char *field, uint8_t size) {
+    const char *p = cmd;
+    for (uint8_t i = 0; i < index; i++) {
+        p = strchr(p, ',');
+        if (!p) return 0;
+        p++;
+    }
+    uint8_t n = 0;
+    while (p[n] && p[n] != ',' && p[n] != '*' && n < size - 1) {
+        field[n] = p[n];
+        n++;
+    }
+    field[n] = '\0';
+    return 1;
+}
+
+static void rx_command(const char *cmd) {
+    fake_rx_t *rx = &model.rx;
+    char field[16];
+
+    rx->cmds++;
+    if (!gps_validate_checksum(cmd)) {
+        rx->cmds_bad++;
+        return;
+    }
+    if (rx->vendor == RX_UBLOX && strncmp(cmd, "$PUBX,40,", 9) == 0) {
+        // msgId, rddc, rus1 (this port), ...
+        rx_field(cmd, 2, field, sizeof(field));
+        for (uint8_t m = 0; m < RX_MSG_COUNT; m++) {
+            if (strcmp(field, rx_msg_names[m]) == 0 && rx_field(cmd, 4, field, sizeof(field))) {
+                rx->rate[m] = (uint8_t)atoi(field);
+                break;
+            }
+        }
+    } else if (rx->vendor == RX_MTK && strncmp(cmd, "$PMTK314,", 9) == 0) {
+        for (uint8_t m = 0; m < RX_MSG_COUNT; m++) {
+            if (rx_field(cmd, 1 + pmtk314_field[m], field, sizeof(field))) rx->rate[m] = (uint8_t)atoi(field);
+        }
+    } else if (rx->vendor == RX_UBLOX && strncmp(cmd, "$PUBX,41,1,", 11) == 0) {
+        rx->baud_cmds++;
+        if (rx->accept_baud && rx_field(cmd, 5, field, sizeof(field))) rx->baud = (uint32_t)atol(field);
+    } else if (rx->vendor == RX_MTK && strncmp(cmd, "$PMTK251,", 9) == 0) {
+        rx->baud_cmds++;
+        if (rx->accept_baud && rx_field(cmd, 1, field, sizeof(field))) rx->baud = (uint32_t)atol(field);
+    }
+}
+
+// One byte from U3TXREG, at the rate U3BRG has when it leaves
+static void rx_input(uint8_t byte) {
+    fake_rx_t *rx = &model.rx;
+
+    if (rx->vendor == RX_NONE || !U3MODEbits.UARTEN || !U3MODEbits.UTXEN) return;
+    if (!rates_match()) {
+        rx->garbled++;
+        rx->cmd_len = 0;
+        return;
+    }
+    if (byte == '$') rx->cmd_len = 0;
+    if (rx->cmd_len < sizeof(rx->cmd) - 1) rx->cmd[rx->cmd_len++] = (char)byte;
+    if (byte == '\n') {
+        rx->cmd[rx->cmd_len] = '\0';
+        if (rx->cmd[0] == '$') rx_command(rx->cmd);
+        rx->cmd_len = 0;
+    }
+}
+
+// =============================
+// UART3 receiver and DMA1
+// =============================
+static void uart_receive(uint8_t byte) {
+    if (!U3MODEbits.UARTEN || !U3MODEbits.URXEN) return;
+    if (!rates_match()) {
+        byte = (uint8_t)rng();
+        model.garbage++;
+        model.sta.FERIF = 1;
+    }
+    U3RXREG = byte;
+
+    if (!DMACONbits.DMAEN || !DMACH1bits.CHEN || DMAINT1bits.CHSEL != GPS_DMA_TRIGGER) {
+        model.rx_overruns++;
+        model.sta.OERR = 1;
+        return;
+    }
+    if (!model.dma_latched) {
+        model.dma_start = DMADST1;
+        model.dma_count = 0;
+        model.dma_latched = 1;
+    }
+    uint16_t offset = (uint16_t)(DMADST1 - (uint16_t)gps_rx_buffer);
+    if (offset >= GPS_BUFFER_SIZE || DMASRC1 != (uint16_t)&U3RXREG) {
+        model.dma_errors++;
+        return;
+    }
+    gps_rx_buffer[offset] = (uint8_t)U3RXREG;
+    DMADST1++;
+    if (++model.dma_count == DMACNT1 && DMACH1bits.RELOAD) {
+        DMADST1 = model.dma_start;
+        model.dma_count = 0;
+    }
+}
+
+static void model_advance(uint32_t us) {
+    fake_rx_t *rx = &model.rx;
+
+    model.us += us;
+    if (rx->vendor == RX_NONE) return;
+    while (rx->next_byte_us <= model.us) {
+        if (rx->out_pos == rx->out_len) {
+            uint64_t epoch_us = (uint64_t)rx->epoch * RX_EPOCH_US + rx->phase_us;
+            if (epoch_us > model.us) {
+                rx->next_byte_us = epoch_us;
+                break;
+            }
+            rx_build_epoch();
+            if (rx->next_byte_us < epoch_us) rx->next_byte_us = epoch_us;
+            continue;
+        }
+        uart_receive((uint8_t)rx->out[rx->out_pos++]);
+        rx->next_byte_us += 10000000UL / rx->baud;      // 8N1
+    }
+}
+
+static void model_commit_tx(void) {
+    if (!model.tx_pending) return;
+    model.tx_pending = 0;
+    rx_input((uint8_t)model.tx_cell);
+}
+
+volatile uint16_t *host_u3txreg(void) {
+    model_commit_tx();
+    model.tx_pending = 1;
+    return &model.tx_cell;
+}
+
+volatile U3STABITS *host_u3sta(void) {
+    model_commit_tx();
+    model.sta.TRMT = 1;
+    return &model.sta;
+}
+
+volatile U3STAHBITS *host_u3stah(void) {
+    model_commit_tx();
+    model.stah.UTXBF = 0;
+    return &model.stah;
+}
+
+uint32_t now_ms(void) {
+    model_advance(MODEL_STEP_US);
+    return (uint32_t)(model.us / 1000);
+}
+
+// =============================
+// Scenarios
+// =============================
+static void model_reset(rx_vendor_t vendor, uint32_t baud, uint8_t accept_baud) {
+    static const uint8_t ublox_default[RX_MSG_COUNT] = { 1, 1, 1, 1, 1, 1, 0 };
+    static const uint8_t mtk_default[RX_MSG_COUNT] = { 0, 1, 1, 1, 1, 1, 0 };
+
+    memset(&model, 0, sizeof(model));
+    model.us = 5000000;             // Receiver already running when the MCU starts
+    model.rx.vendor = vendor;
+    model.rx.baud = baud;
+    model.rx.accept_baud = accept_baud;
+    model.rx.phase_us = 300000;
+    model.rx.epoch = 5;
+    model.rx.next_byte_us = model.us;
+    memcpy(model.rx.rate, vendor == RX_MTK ? mtk_default : ublox_default, RX_MSG_COUNT);
+    model.sta.TRMT = 1;
+    gps_debug_raw = 0;
+    printf("--- ");
+}
+
+// Main loop after gps_init(): gps_update() every 5 ms for the given time
+static uint16_t run_main_loop(uint32_t ms) {
+    uint16_t updates = 0;
+    for (uint32_t t = 0; t < ms; t += 5) {
+        updates += gps_update();
+        model_advance(5000);
+    }
+    return updates;
+}
+
+static void check_pruned(void) {
+    for (uint8_t m = 0; m < RX_MSG_COUNT; m++) {
+        uint8_t expect = m == RX_GGA ? 1 : (m == RX_RMC ? GPS_RMC_DIVIDER : 0);
+        CHECK_EQ_U(model.rx.rate[m], expect);
+    }
+}
+
+static void check_common(void) {
+    CHECK_EQ_U(model.dma_errors, 0);
+    CHECK_EQ_U(model.rx_overruns, 0);
+    CHECK_EQ_U(model.dma_start, (uint16_t)gps_rx_buffer);
+    CHECK_EQ_U(DMACNT1, GPS_BUFFER_SIZE);
+    CHECK_EQ_U(U3BRG, brg_for(gps_get_link_stats()->baud));
+}
+
+// Pruned output: GGA every second, RMC every fifth, position parsed
+static void check_steady_state(void) {
+    gps_position_t pos;
+    uint16_t updates = run_main_loop(10000);
+    const gps_link_stats_t *link = gps_get_link_stats();
+
+    gps_position_read(&pos);
+    CHECK(updates >= 10 && updates <= 14);
+    CHECK(link->sentences_per_s >= 1 && link->sentences_per_s <= 2);
+    CHECK_EQ_U(pos.position_valid, 1);
+    CHECK_EQ_U(pos.fix_quality, GPS_FIX_GPS);
+    CHECK_EQ_U(pos.lat_e7, 429546300L);
+    CHECK_EQ_U(pos.lon_e7, 13644790L);
+    CHECK_EQ_U(pos.alt_mm, 520400L);
+    CHECK_EQ_U(model.garbage, 0);
+}
+
+// u-blox at the factory 9600 baud: found on the first probe, pruned, moved to 38400
+static void test_ublox_9600(void) {
+    model_reset(RX_UBLOX, 9600, 1);
+    gps_init();
+    const gps_link_stats_t *link = gps_get_link_stats();
+
+    CHECK_EQ_U(link->baud, 38400);
+    CHECK_EQ_U(model.rx.baud, 38400);
+    CHECK_EQ_U(link->pruned, 1);
+    CHECK(link->first_sentence_ms > 0 && link->first_sentence_ms <= GPS_PROBE_MS);
+    CHECK_EQ_U(model.rx.cmds_bad, 0);
+    CHECK_EQ_U(model.rx.baud_cmds, 1);
+    check_pruned();
+    check_common();
+    model.garbage = 0;
+    check_steady_state();
+}
+
+// MediaTek at 115200 (third rate tried): garbage at 9600 and 38400 must not
+// be taken for NMEA, PMTK314/251 apply, PUBX is ignored
+static void test_mtk_115200(void) {
+    model_reset(RX_MTK, 115200, 1);
+    gps_init();
+    const gps_link_stats_t *link = gps_get_link_stats();
+
+    CHECK(model.garbage > 0);
+    CHECK_EQ_U(link->baud, 38400);
+    CHECK_EQ_U(model.rx.baud, 38400);
+    CHECK(link->first_sentence_ms > 2 * GPS_PROBE_MS && link->first_sentence_ms <= 3 * GPS_PROBE_MS);
+    CHECK_EQ_U(model.rx.cmds_bad, 0);
+    check_pruned();
+    check_common();
+    model.garbage = 0;
+    check_steady_state();
+}
+
+// Receiver refusing the rate change: back to the detected rate, still pruned
+static void test_baud_refused(void) {
+    model_reset(RX_UBLOX, 4800, 0);
+    gps_init();
+    const gps_link_stats_t *link = gps_get_link_stats();
+
+    CHECK_EQ_U(link->baud, 4800);
+    CHECK_EQ_U(model.rx.baud, 4800);
+    CHECK_EQ_U(model.rx.baud_cmds, 1);
+    CHECK(link->first_sentence_ms > 3 * GPS_PROBE_MS);
+    check_pruned();
+    check_common();
+    model.garbage = 0;
+    check_steady_state();
+}
+
+// Already at GPS_NMEA_BAUD (MCU reset, receiver kept its setting): no rate command
+static void test_already_38400(void) {
+    model_reset(RX_UBLOX, 38400, 1);
+    gps_init();
+    const gps_link_stats_t *link = gps_get_link_stats();
+
+    CHECK_EQ_U(link->baud, 38400);
+    CHECK_EQ_U(model.rx.baud_cmds, 0);
+    check_pruned();
+    check_common();
+}
+
+// Last rate in the list
+static void test_19200(void) {
+    model_reset(RX_MTK, 19200, 1);
+    gps_init();
+    const gps_link_stats_t *link = gps_get_link_stats();
+
+    CHECK_EQ_U(link->baud, 38400);
+    CHECK(link->first_sentence_ms > 5 * GPS_PROBE_MS);
+    check_pruned();
+    check_common();
+}
+
+// Nothing connected: every rate tried once, 9600 kept, nothing sent
+static void test_no_receiver(void) {
+    model_reset(RX_NONE, 9600, 0);
+    uint64_t start = model.us;
+    gps_init();
+    const gps_link_stats_t *link = gps_get_link_stats();
+    uint32_t elapsed_ms = (uint32_t)((model.us - start) / 1000);
+
+    CHECK_EQ_U(link->baud, 9600);
+    CHECK_EQ_U(link->first_sentence_ms, 0);
+    CHECK_EQ_U(U3BRG, brg_for(9600));
+    CHECK(elapsed_ms >= 6 * GPS_PROBE_MS && elapsed_ms < 6 * GPS_PROBE_MS + 50);
+}
+
+int main(void) {
+    test_ublox_9600();
+    test_mtk_115200();
+    test_baud_refused();
+    test_already_38400();
+    test_19200();
+    test_no_receiver();
+    TEST_DONE();
+}
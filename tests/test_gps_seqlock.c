@@ -0,0 +1,176 @@
+// test_gps_seqlock.c - GPS position record under preemption
+//
+// gps_position_publish() and gps_position_try_read() from gps_nmea.c, with
+// a SIGALRM handler standing in for the interrupt, both ways round:
+// - the handler publishes while the main loop reads (the writer preempts
+//   the reader)
+// - the main loop publishes while the handler reads with try_read (the
+//   ISR reader of the firmware, which must not spin)
+// Every record carries related fields (lat_e7 == -lon_e7 == f(n), alt_mm
+// == n, seq == 2n mod 2^16), so a torn snapshot mixes two records and
+// shows. Both runs must also see failed reads, or the preemption never hit
+// a copy and the test proves nothing.
+
+#include "../includes.h"
+#include "../gps_nmea.h"
+#include "../protocol_data.h"
+#include "../timebase.h"
+#include "host/test_util.h"
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define TIMER_US        20
+#define HANDLER_RUNS    20000
+
+volatile uint8_t gps_updated;
+
+// Rest of gps_nmea.c (UART3, parsers): linked, not exercised here
+static U3STABITS u3sta;
+static U3STAHBITS u3stah;
+static uint16_t u3txreg;
+
+volatile uint16_t *host_u3txreg(void) { return &u3txreg; }
+volatile U3STABITS *host_u3sta(void) { return &u3sta; }
+volatile U3STAHBITS *host_u3stah(void) { return &u3stah; }
+uint32_t now_ms(void) { return 0; }
+int32_t gps_deg_to_e7(double deg) { return (int32_t)lround(deg * GPS_E7_PER_DEG); }
+
+static volatile sig_atomic_t handler_mode;          // 0: publish, 1: try_read
+static volatile uint32_t handler_runs;
+static volatile uint32_t published;                 // Records fully published
+static volatile uint8_t writing;                    // Main loop inside publish
+
+static uint32_t isr_reads, isr_fails, isr_torn, isr_fails_idle;
+
+static int32_t lat_for(uint32_t n) {
+    return (int32_t)(n * 7919UL % 1800000001UL) - 900000000L;
+}
+
+static void record_for(uint32_t n, gps_position_t *pos) {
+    memset(pos, 0, sizeof(*pos));
+    pos->lat_e7 = lat_for(n);
+    pos->lon_e7 = -pos->lat_e7;
+    pos->alt_mm = (int32_t)n;
+    pos->last_update_ms = n * 3;
+    pos->utc_ms = n * 5;
+    pos->hdop_x10 = (uint16_t)n;
+    pos->fix_quality = (uint8_t)(n % 3);
+    pos->satellites = (uint8_t)n;
+    pos->position_valid = 1;
+}
+
+// Record n (seq 2n, 16 bits) or the boot record (TEST position, seq 0)
+static uint8_t record_ok(const gps_position_t *pos) {
+    uint32_t n = (uint32_t)pos->alt_mm;
+    gps_position_t expect;
+
+    if (!pos->position_valid) {
+        memset(&expect, 0, sizeof(expect));
+        expect.lat_e7 = TEST_LATITUDE_E7;
+        expect.lon_e7 = TEST_LONGITUDE_E7;
+        expect.alt_mm = TEST_ALTITUDE_MM;
+    } else {
+        record_for(n, &expect);
+        expect.seq = (uint16_t)(2 * n);
+    }
+    return pos->seq == expect.seq && pos->lat_e7 == expect.lat_e7 && pos->lon_e7 == expect.lon_e7 &&
+           pos->alt_mm == expect.alt_mm && pos->last_update_ms == expect.last_update_ms &&
+           pos->utc_ms == expect.utc_ms && pos->hdop_x10 == expect.hdop_x10 &&
+           pos->fix_quality == expect.fix_quality && pos->satellites == expect.satellites &&
+           pos->position_valid == expect.position_valid;
+}
+
+static void publish_next(void) {
+    gps_position_t pos;
+    record_for(published + 1, &pos);
+    gps_position_publish(&pos);
+    published = published + 1;
+}
+
+static void on_alarm(int sig) {
+    (void)sig;
+    handler_runs = handler_runs + 1;
+    if (handler_mode == 0) {
+        publish_next();
+        return;
+    }
+
+    gps_position_t pos;
+    isr_reads++;
+    if (!gps_position_try_read(&pos)) {
+        isr_fails++;
+        if (!writing) isr_fails_idle++;             // Failed with no write in progress
+    } else if (!record_ok(&pos)) {
+        isr_torn++;
+    }
+}
+
+static void timer_start(void) {
+    struct itimerval it = {{0, TIMER_US}, {0, TIMER_US}};
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+static void timer_stop(void) {
+    struct itimerval it = {{0, 0}, {0, 0}};
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+// Writer preempts the reader
+static void test_preempting_writer(void) {
+    uint32_t reads = 0, fails = 0, torn = 0, fails_stale = 0;
+
+    handler_mode = 0;
+    handler_runs = 0;
+    timer_start();
+    while (handler_runs < HANDLER_RUNS) {
+        gps_position_t pos;
+        uint32_t before = published;
+        reads++;
+        if (!gps_position_try_read(&pos)) {
+            fails++;
+            if (published == before) fails_stale++;  // No publish ran during the read
+        } else if (!record_ok(&pos)) {
+            torn++;
+        }
+    }
+    timer_stop();
+
+    printf("writer in the handler: %lu records, %lu reads, %lu retries, %lu torn\n",
+           (unsigned long)published, (unsigned long)reads, (unsigned long)fails, (unsigned long)torn);
+    CHECK_EQ_U(torn, 0);
+    CHECK_EQ_U(fails_stale, 0);
+    CHECK(fails > 0);                               // The preemption did hit reads
+
+    gps_position_t last;
+    gps_position_read(&last);
+    CHECK(record_ok(&last));
+    CHECK_EQ_U(last.alt_mm, published);
+}
+
+// Reader (try_read, no spinning) preempts the writer
+static void test_preempting_reader(void) {
+    handler_mode = 1;
+    handler_runs = 0;
+    timer_start();
+    while (handler_runs < HANDLER_RUNS) {
+        writing = 1;
+        publish_next();
+        writing = 0;
+    }
+    timer_stop();
+
+    printf("reader in the handler: %lu records, %lu reads, %lu failed, %lu torn\n",
+           (unsigned long)published, (unsigned long)isr_reads, (unsigned long)isr_fails,
+           (unsigned long)isr_torn);
+    CHECK_EQ_U(isr_torn, 0);
+    CHECK_EQ_U(isr_fails_idle, 0);
+    CHECK(isr_fails > 0);                           // Some reads landed inside a write
+}
+
+int main(void) {
+    signal(SIGALRM, on_alarm);
+    test_preempting_writer();
+    test_preempting_reader();
+    TEST_DONE();
+}
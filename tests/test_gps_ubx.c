@@ -0,0 +1,386 @@
+// test_gps_ubx.c - UBX NAV-PVT decoder and receiver configuration
+//
+// There is no receiver capture in the repo. The fixtures are written from
+// the u-blox M8 protocol description: one NAV-PVT frame and the CFG/ACK
+// frames as literal bytes (Fletcher-8 computed offline), then a generated
+// stream of NAV-PVT epochs mixed with NMEA text, ACKs, oversized NAV
+// messages, noise, bit-flipped and truncated frames, as a receiver switched
+// from NMEA to UBX or a noisy line would produce.
+
+#include "../includes.h"
+#include "../gps_nmea.h"
+#include "../gps_ubx.h"
+#include "host/test_util.h"
+
+extern gps_position_t host_gps_record;
+extern uint32_t host_gps_publish_count;
+extern uint32_t host_now_ms;
+extern uint8_t host_uart_tx[];
+extern uint16_t host_uart_tx_len;
+extern uint32_t host_uart_baud[];
+extern uint16_t host_uart_baud_at[];
+extern uint8_t host_uart_baud_count;
+
+#define EPOCHS          1500
+#define FRAME_BYTES     (UBX_HEADER_BYTES + UBX_NAV_PVT_LEN + 2)
+
+// NAV-PVT 2026-10-18 12:34:56.250 UTC (valid 0x07), 3D fix, gnssFixOK +
+// diffSoln, 11 SV, lon 1.3644790, lat 42.9546300, hMSL 520.400 m, PDOP 1.45
+static const uint8_t pvt_fixture[FRAME_BYTES] = {
+    0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x7A, 0x2A, 0xB3, 0x02, 0xEA, 0x07,
+    0x0A, 0x12, 0x0C, 0x22, 0x38, 0x07, 0x19, 0x00, 0x00, 0x00, 0x80, 0xB2,
+    0xE6, 0x0E, 0x03, 0x03, 0xEA, 0x0B, 0xF6, 0x33, 0xD0, 0x00, 0x3C, 0x5B,
+    0x9A, 0x19, 0xBC, 0xB3, 0x08, 0x00, 0xD0, 0xF0, 0x07, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x91, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x83, 0x2D
+};
+
+// ACK-ACK for CFG-MSG, the receiver's answer to the configuration
+static const uint8_t ack_fixture[] = { 0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x01, 0x0F, 0x38 };
+
+// What gps_ubx_configure() must send at each baud rate
+static const uint8_t cfg_msg_fixture[] = {
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x01, 0x13, 0x51
+};
+static const uint8_t cfg_rate_fixture[] = {
+    0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0xE8, 0x03, 0x01, 0x00, 0x01, 0x00, 0x01, 0x39
+};
+static const uint8_t cfg_prt_fixture[] = {
+    0xB5, 0x62, 0x06, 0x00, 0x14, 0x00, 0x01, 0x00, 0x00, 0x00, 0xC0, 0x08, 0x00, 0x00,
+    0x00, 0x96, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7D, 0x64
+};
+
+static uint32_t rng_state = 0x2545F491;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525UL + 1013904223UL;
+    return rng_state >> 8;
+}
+
+static uint8_t feed(const uint8_t *data, uint16_t length) {
+    uint8_t frames = 0;
+    for (uint16_t i = 0; i < length; i++) frames += gps_ubx_input(data[i]);
+    return frames;
+}
+
+static void put_le(uint8_t *p, uint32_t value, uint8_t bytes) {
+    for (uint8_t i = 0; i < bytes; i++) p[i] = (uint8_t)(value >> (8 * i));
+}
+
+// Frame around a payload; the checksum goes through gps_ubx_checksum(),
+// which test_fixtures() holds to the literal frames above
+static uint16_t build_frame(uint8_t *frame, uint8_t cls, uint8_t id, const uint8_t *payload,
+                            uint16_t length) {
+    frame[0] = UBX_SYNC1;
+    frame[1] = UBX_SYNC2;
+    frame[2] = cls;
+    frame[3] = id;
+    put_le(&frame[4], length, 2);
+    memcpy(&frame[UBX_HEADER_BYTES], payload, length);
+    gps_ubx_checksum(&frame[2], length + 4, &frame[UBX_HEADER_BYTES + length],
+                     &frame[UBX_HEADER_BYTES + length + 1]);
+    return UBX_HEADER_BYTES + length + 2;
+}
+
+static void test_fixtures(void) {
+    uint8_t ck_a, ck_b;
+
+    gps_ubx_checksum(&pvt_fixture[2], UBX_NAV_PVT_LEN + 4, &ck_a, &ck_b);
+    CHECK_EQ_U(ck_a, pvt_fixture[FRAME_BYTES - 2]);
+    CHECK_EQ_U(ck_b, pvt_fixture[FRAME_BYTES - 1]);
+
+    memset(&host_gps_record, 0, sizeof(host_gps_record));
+    host_now_ms = 123456;
+    gps_ubx_reset();
+
+    CHECK_EQ_U(feed(ack_fixture, sizeof(ack_fixture)), 0);
+    CHECK_EQ_U(gps_ubx_get_stats()->skipped, 1);
+    CHECK_EQ_U(feed(pvt_fixture, FRAME_BYTES), 1);
+    CHECK_EQ_U(host_gps_record.lat_e7, 429546300L);
+    CHECK_EQ_U(host_gps_record.lon_e7, 13644790L);
+    CHECK_EQ_U(host_gps_record.alt_mm, 520400L);
+    CHECK_EQ_U(host_gps_record.utc_ms, (12UL * 3600 + 34 * 60 + 56) * 1000 + 250);
+    CHECK_EQ_U(host_gps_record.satellites, 11);
+    CHECK_EQ_U(host_gps_record.hdop_x10, 14);
+    CHECK_EQ_U(host_gps_record.fix_quality, GPS_FIX_DGPS);
+    CHECK_EQ_U(host_gps_record.position_valid, 1);
+    CHECK_EQ_U(host_gps_record.last_update_ms, 123456);
+
+    // Every single-bit error in class..checksum is rejected
+    uint32_t accepted = 0;
+    for (uint16_t byte = 2; byte < FRAME_BYTES; byte++) {
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            uint8_t frame[FRAME_BYTES];
+            memcpy(frame, pvt_fixture, FRAME_BYTES);
+            frame[byte] ^= (uint8_t)(1 << bit);
+            gps_ubx_reset();
+            accepted += feed(frame, FRAME_BYTES);
+            // A damaged length leaves the decoder mid-frame: resync on a good one
+            feed(pvt_fixture, FRAME_BYTES);
+            feed(pvt_fixture, FRAME_BYTES);
+        }
+    }
+    CHECK_EQ_U(accepted, 0);
+
+    // gps_init() configuration: CFG-MSG, CFG-RATE, CFG-PRT at 9600, then 38400
+    host_uart_tx_len = 0;
+    host_uart_baud_count = 0;
+    gps_ubx_configure();
+    uint16_t at = 0;
+    CHECK_EQ_U(host_uart_baud_count, 2);
+    CHECK_EQ_U(host_uart_baud[0], 9600);
+    CHECK_EQ_U(host_uart_baud[1], GPS_UBX_BAUD);
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        CHECK_EQ_U(host_uart_baud_at[pass], at);
+        CHECK(memcmp(&host_uart_tx[at], cfg_msg_fixture, sizeof(cfg_msg_fixture)) == 0);
+        at += sizeof(cfg_msg_fixture);
+        CHECK(memcmp(&host_uart_tx[at], cfg_rate_fixture, sizeof(cfg_rate_fixture)) == 0);
+        at += sizeof(cfg_rate_fixture);
+        CHECK(memcmp(&host_uart_tx[at], cfg_prt_fixture, sizeof(cfg_prt_fixture)) == 0);
+        at += sizeof(cfg_prt_fixture);
+    }
+    CHECK_EQ_U(host_uart_tx_len, at);
+}
+
+// UTC rounding: hh:mm:ss is rounded, nano can be negative, also at midnight
+static void test_time_of_day(void) {
+    static const struct { uint8_t h, m, s; int32_t nano; uint32_t utc_ms; } cases[] = {
+        { 12, 34, 56, 250000000L, 45296250UL },
+        { 12, 34, 56, -1200000L, 45295999UL },
+        { 0, 0, 0, -5000000L, 86399995UL },
+        { 23, 59, 59, 999000000L, 86399999UL },
+        { 0, 0, 0, 0, 0 },
+    };
+
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint8_t payload[UBX_NAV_PVT_LEN];
+        uint8_t frame[FRAME_BYTES];
+
+        memcpy(payload, &pvt_fixture[UBX_HEADER_BYTES], UBX_NAV_PVT_LEN);
+        payload[UBX_PVT_HOUR] = cases[i].h;
+        payload[UBX_PVT_MIN] = cases[i].m;
+        payload[UBX_PVT_SEC] = cases[i].s;
+        put_le(&payload[UBX_PVT_NANO], (uint32_t)cases[i].nano, 4);
+        build_frame(frame, UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_LEN);
+        host_gps_record.utc_ms = 0xFFFFFFFFUL;
+        CHECK_EQ_U(feed(frame, FRAME_BYTES), 1);
+        CHECK_EQ_U(host_gps_record.utc_ms, cases[i].utc_ms);
+    }
+
+    // validTime clear: the time of day is kept
+    uint8_t payload[UBX_NAV_PVT_LEN];
+    uint8_t frame[FRAME_BYTES];
+    memcpy(payload, &pvt_fixture[UBX_HEADER_BYTES], UBX_NAV_PVT_LEN);
+    payload[UBX_PVT_VALID] = 0x01;
+    build_frame(frame, UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_LEN);
+    host_gps_record.utc_ms = 777;
+    CHECK_EQ_U(feed(frame, FRAME_BYTES), 1);
+    CHECK_EQ_U(host_gps_record.utc_ms, 777);
+}
+
+// fixType 2/3/4 with gnssFixOK store a position; none, DR only, time only
+// or a fix without gnssFixOK keep the previous one and clear the fix
+static void test_fix_types(void) {
+    static const struct { uint8_t fix_type, flags, fix_quality; } cases[] = {
+        { 0, 0x01, GPS_FIX_INVALID }, { 1, 0x01, GPS_FIX_INVALID }, { 2, 0x01, GPS_FIX_GPS },
+        { 3, 0x03, GPS_FIX_DGPS }, { 4, 0x01, GPS_FIX_GPS }, { 5, 0x01, GPS_FIX_INVALID },
+        { 3, 0x00, GPS_FIX_INVALID }, { 3, 0x02, GPS_FIX_INVALID },
+    };
+
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint8_t payload[UBX_NAV_PVT_LEN];
+        uint8_t frame[FRAME_BYTES];
+
+        memcpy(payload, &pvt_fixture[UBX_HEADER_BYTES], UBX_NAV_PVT_LEN);
+        payload[UBX_PVT_FIX_TYPE] = cases[i].fix_type;
+        payload[UBX_PVT_FLAGS] = cases[i].flags;
+        build_frame(frame, UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_LEN);
+        memset(&host_gps_record, 0, sizeof(host_gps_record));
+        host_gps_record.lat_e7 = 1;
+        CHECK_EQ_U(feed(frame, FRAME_BYTES), 1);
+        CHECK_EQ_U(host_gps_record.fix_quality, cases[i].fix_quality);
+        CHECK_EQ_U(host_gps_record.lat_e7, cases[i].fix_quality ? 429546300L : 1);
+        CHECK_EQ_U(host_gps_record.position_valid, cases[i].fix_quality ? 1 : 0);
+    }
+}
+
+// Expected record of one generated epoch
+typedef struct {
+    uint32_t utc_ms;
+    int32_t lat_e7, lon_e7, alt_mm;
+    uint8_t fix_quality;
+    uint8_t satellites;
+    uint8_t must_decode;        // 0: a sync pattern just before it, may be swallowed
+} epoch_t;
+
+static epoch_t epochs[EPOCHS];
+
+static const char nmea_text[] = "$GNGGA,101010.00,4257.27780,N,00121.86874,E,1,11,0.9,520.4,M,,,,*4D\r\n";
+
+// NAV-PVT for epoch n: 1 s apart from 10:00:00, a track across the
+// hemispheres, no fix on every seventh epoch (the record keeps the last
+// stored position), DGPS on every third
+static uint16_t epoch_frame(uint8_t *frame, uint16_t n, epoch_t *expect) {
+    uint8_t payload[UBX_NAV_PVT_LEN];
+    uint32_t tod = 36000UL + n;
+    int32_t nano = (int32_t)(rng() % 2000000UL) - 1000000L;
+    uint8_t fix = (n % 7 == 3) ? 0 : 3;
+    uint8_t flags = fix ? ((n % 3 == 0) ? 0x03 : 0x01) : 0x00;
+
+    memset(payload, 0, sizeof(payload));
+    put_le(&payload[0], tod * 1000UL, 4);
+    payload[UBX_PVT_HOUR] = (uint8_t)(tod / 3600);
+    payload[UBX_PVT_MIN] = (uint8_t)(tod / 60 % 60);
+    payload[UBX_PVT_SEC] = (uint8_t)(tod % 60);
+    payload[UBX_PVT_VALID] = 0x07;
+    put_le(&payload[UBX_PVT_NANO], (uint32_t)nano, 4);
+    payload[UBX_PVT_FIX_TYPE] = fix;
+    payload[UBX_PVT_FLAGS] = flags;
+    payload[UBX_PVT_NUM_SV] = (uint8_t)(4 + n % 20);
+    put_le(&payload[UBX_PVT_LON], (uint32_t)(-1800000000L + (int32_t)n * 2400000L), 4);
+    put_le(&payload[UBX_PVT_LAT], (uint32_t)(-900000000L + (int32_t)n * 1200000L), 4);
+    put_le(&payload[UBX_PVT_HMSL], (uint32_t)(-400000L + (int32_t)n * 6011L), 4);
+    put_le(&payload[UBX_PVT_PDOP], 95 + n % 400, 2);
+
+    expect->utc_ms = tod * 1000UL + nano / 1000000L;
+    expect->satellites = payload[UBX_PVT_NUM_SV];
+    expect->lat_e7 = -900000000L + (int32_t)n * 1200000L;
+    expect->lon_e7 = -1800000000L + (int32_t)n * 2400000L;
+    expect->alt_mm = -400000L + (int32_t)n * 6011L;
+    expect->fix_quality = fix ? ((flags & 0x02) ? GPS_FIX_DGPS : GPS_FIX_GPS) : GPS_FIX_INVALID;
+    return build_frame(frame, UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_LEN);
+}
+
+static void test_stream(void) {
+    static uint8_t stream[EPOCHS * 260];
+    uint32_t length = 0;
+    uint16_t intact = 0, damaged = 0, truncated = 0, acks = 0, oversized = 0;
+    uint8_t after_truncation = 0;
+
+    // Generate
+    for (uint16_t n = 0; n < EPOCHS; n++) {
+        uint8_t frame[FRAME_BYTES];
+        uint8_t other[UBX_HEADER_BYTES + 120 + 2];
+        uint8_t payload[120];
+        epoch_t expect;
+        uint32_t r = rng() % 100;
+        uint32_t gap = length;
+
+        // Something between the epochs
+        if (r < 10) {
+            memcpy(&stream[length], nmea_text, sizeof(nmea_text) - 1);
+            length += sizeof(nmea_text) - 1;
+        } else if (r < 20) {
+            memcpy(&stream[length], ack_fixture, sizeof(ack_fixture));
+            length += sizeof(ack_fixture);
+            gap = length;
+            acks++;
+        } else if (r < 25) {
+            for (uint8_t i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t)rng();
+            uint16_t l = build_frame(other, UBX_CLASS_NAV, 0x35, payload, sizeof(payload));
+            memcpy(&stream[length], other, l);
+            gap = length + UBX_HEADER_BYTES;        // Header rejected, payload is noise
+            length += l;
+            oversized++;
+        } else if (r < 35) {
+            uint8_t count = (uint8_t)(1 + rng() % 24);
+            for (uint8_t i = 0; i < count; i++) {
+                // Noise rich in sync bytes
+                uint32_t k = rng() % 8;
+                stream[length++] = k == 0 ? UBX_SYNC1 : (k == 1 ? UBX_SYNC2 : (uint8_t)rng());
+            }
+        }
+
+        // B5 62 in the noise or in the skipped payload starts a frame that
+        // may run over this epoch, like the rest of a truncated frame
+        uint8_t captured = after_truncation;
+        for (uint32_t i = gap; i + 1 < length; i++) {
+            if (stream[i] == UBX_SYNC1 && stream[i + 1] == UBX_SYNC2) captured = 1;
+        }
+
+        uint16_t l = epoch_frame(frame, n, &expect);
+        r = rng() % 100;
+        if (r < 5) {
+            // One bit flipped after the length field
+            uint16_t at = (uint16_t)(UBX_HEADER_BYTES + rng() % (l - UBX_HEADER_BYTES));
+            frame[at] ^= (uint8_t)(1 << (rng() % 8));
+            damaged++;
+            memset(&epochs[n], 0xFF, sizeof(epochs[n]));
+            epochs[n].must_decode = 0;
+        } else if (r < 8) {
+            l = (uint16_t)(UBX_HEADER_BYTES + rng() % UBX_NAV_PVT_LEN);
+            truncated++;
+            memset(&epochs[n], 0xFF, sizeof(epochs[n]));
+            epochs[n].must_decode = 0;
+        } else {
+            epochs[n] = expect;
+            epochs[n].must_decode = !captured;
+            intact++;
+        }
+        after_truncation = (r >= 5 && r < 8);
+        memcpy(&stream[length], frame, l);
+        length += l;
+    }
+
+    // Decode: records in stream order, none invented, none missing except
+    // a frame captured by a truncated one or by a sync pattern before it
+    memset(&host_gps_record, 0, sizeof(host_gps_record));
+    gps_ubx_reset();
+    host_gps_publish_count = 0;
+    uint16_t next = 0, decoded = 0, missed = 0, wrong = 0, captured = 0;
+    gps_position_t held = host_gps_record;
+    for (uint32_t i = 0; i < length; i++) {
+        if (!gps_ubx_input(stream[i])) continue;
+        decoded++;
+        while (next < EPOCHS && epochs[next].utc_ms != host_gps_record.utc_ms) {
+            if (epochs[next].must_decode) missed++;
+            next++;
+        }
+        if (next == EPOCHS) {
+            wrong++;
+            break;
+        }
+        const epoch_t *e = &epochs[next++];
+        if (e->fix_quality != GPS_FIX_INVALID) {
+            held.lat_e7 = e->lat_e7;
+            held.lon_e7 = e->lon_e7;
+            held.alt_mm = e->alt_mm;
+        }
+        if (host_gps_record.lat_e7 != held.lat_e7 || host_gps_record.lon_e7 != held.lon_e7 ||
+            host_gps_record.alt_mm != held.alt_mm || host_gps_record.fix_quality != e->fix_quality ||
+            host_gps_record.satellites != e->satellites) {
+            wrong++;
+        }
+    }
+    while (next < EPOCHS) {
+        if (epochs[next++].must_decode) missed++;
+    }
+    for (uint16_t n = 0; n < EPOCHS; n++) {
+        if (!epochs[n].must_decode && epochs[n].utc_ms != 0xFFFFFFFFUL) captured++;
+    }
+
+    const gps_ubx_stats_t *stats = gps_ubx_get_stats();
+    printf("stream %lu bytes: %u intact, %u bit-flipped, %u truncated NAV-PVT, %u ACK, %u oversized\n",
+           (unsigned long)length, intact, damaged, truncated, acks, oversized);
+    printf("decoded %u (%u intact frames exposed to capture), missed %u, wrong %u; stats frames %u, checksum errors %u, skipped %u\n",
+           decoded, captured, missed, wrong, stats->frames, stats->ck_errors, stats->skipped);
+
+    CHECK_EQ_U(wrong, 0);
+    CHECK_EQ_U(missed, 0);
+    CHECK_EQ_U(stats->frames, decoded);
+    CHECK_EQ_U(host_gps_publish_count, decoded);
+    CHECK(decoded >= intact - captured);
+    CHECK(stats->ck_errors >= damaged);
+    CHECK(stats->skipped >= oversized);
+}
+
+int main(void) {
+    test_fixtures();
+    test_time_of_day();
+    test_fix_types();
+    test_stream();
+    TEST_DONE();
+}
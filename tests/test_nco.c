@@ -0,0 +1,112 @@
+// test_nco.c - NCO digital IF: frequency, modulation phase and spur level
+//
+// 4096 samples at NCO_SAMPLE_RATE_HZ hold exactly 480 cycles of the 3000 Hz
+// IF, and the accumulator returns to the same value after each block, so a
+// rectangular-window FFT puts the carrier in one bin and blocks taken in
+// different phase states can be compared directly.
+
+#include "../includes.h"
+#include "../signal_processor.h"
+#include "../system_comms.h"
+#include "host/spectrum.h"
+#include "host/test_util.h"
+
+#define BLOCK               4096
+#define IF_BIN              ((uint32_t)NCO_IF_DEFAULT_HZ * BLOCK / NCO_SAMPLE_RATE_HZ)     // 480
+#define RAD_TO_DEG          (180.0 / SPECTRUM_PI)
+
+static double block_re[BLOCK], block_im[BLOCK];
+static uint16_t block_codes[BLOCK];
+
+static double phase_rad, sfdr_db, carrier_amplitude;
+static uint32_t peak_bin;
+
+static void run_block(void) {
+    double mean = 0.0;
+
+    for (uint32_t n = 0; n < BLOCK; n++) {
+        block_codes[n] = signal_processor_nco_next();
+        mean += block_codes[n];
+    }
+    mean /= BLOCK;
+    for (uint32_t n = 0; n < BLOCK; n++) {
+        block_re[n] = block_codes[n] - mean;
+        block_im[n] = 0.0;
+    }
+    spectrum_fft(block_re, block_im, BLOCK);
+
+    double peak = 0.0, spur = 0.0;
+    for (uint32_t k = 1; k < BLOCK / 2; k++) {
+        double p = block_re[k] * block_re[k] + block_im[k] * block_im[k];
+        if (p > peak) { peak = p; peak_bin = k; }
+    }
+    for (uint32_t k = 1; k < BLOCK / 2; k++) {
+        double p = block_re[k] * block_re[k] + block_im[k] * block_im[k];
+        if (k != peak_bin && p > spur) spur = p;
+    }
+    // sin() reference: bin phase of a sine at 0 rad is -pi/2
+    phase_rad = atan2(block_im[peak_bin], block_re[peak_bin]) + SPECTRUM_PI / 2;
+    sfdr_db = 10.0 * log10(peak / spur);
+    carrier_amplitude = 2.0 * sqrt(peak) / BLOCK;
+}
+
+static double wrap(double a) {
+    while (a > SPECTRUM_PI) a -= 2 * SPECTRUM_PI;
+    while (a < -SPECTRUM_PI) a += 2 * SPECTRUM_PI;
+    return a;
+}
+
+int main(void) {
+    signal_processor_init();
+    CHECK_EQ_U(signal_processor_nco_get_if_hz(), NCO_IF_DEFAULT_HZ);
+
+    // IF limits
+    CHECK(!signal_processor_nco_set_if_hz(0));
+    CHECK(!signal_processor_nco_set_if_hz(NCO_SAMPLE_RATE_HZ / 2));
+    CHECK_EQ_U(signal_processor_nco_get_if_hz(), NCO_IF_DEFAULT_HZ);
+
+    // Idle output
+    signal_processor_nco_set_carrier(0, 1);
+    CHECK_EQ_U(signal_processor_nco_next(), 0);
+
+    printf("state       phase error (deg)   SFDR (dBc)\n");
+
+    signal_processor_nco_set_carrier(1, 1);
+    run_block();
+    double carrier_phase = phase_rad;
+    double full = carrier_amplitude;
+    CHECK_EQ_U(peak_bin, IF_BIN);                   // 0 Hz frequency error
+    CHECK(sfdr_db > 65.0);
+    printf("carrier     %10.2f %20.1f\n", 0.0, sfdr_db);
+
+    // Biphase-L bit 1: +1.1 rad in the first half, -1.1 rad in the second
+    static const struct { uint16_t sample; double expect; const char *name; } states[] = {
+        { 0, PHASE_SHIFT_RADIANS, "+1.1 rad" },
+        { SAMPLES_PER_SYMBOL / 2, -PHASE_SHIFT_RADIANS, "-1.1 rad" },
+    };
+    for (uint8_t s = 0; s < 2; s++) {
+        signal_processor_nco_set_biphase_l(1, states[s].sample);
+        run_block();
+        double error = wrap(phase_rad - carrier_phase - states[s].expect);
+        CHECK_EQ_U(peak_bin, IF_BIN);
+        CHECK(fabs(error * RAD_TO_DEG) < 0.5);
+        CHECK(sfdr_db > 65.0);
+        CHECK(fabs(carrier_amplitude - full) < 0.01 * full);
+        printf("%-10s  %10.2f %20.1f\n", states[s].name, error * RAD_TO_DEG, sfdr_db);
+    }
+    // Bit 0 is the mirror image
+    signal_processor_nco_set_biphase_l(0, 0);
+    run_block();
+    CHECK(fabs(wrap(phase_rad - carrier_phase + PHASE_SHIFT_RADIANS)) * RAD_TO_DEG < 0.5);
+
+    // Shutdown ramp: half level, half amplitude around the same bias
+    signal_processor_nco_set_carrier(1, 2);
+    run_block();
+    CHECK(fabs(carrier_amplitude - full / 2) < 0.01 * full);
+
+    // Any IF below Nyquist is accepted
+    CHECK(signal_processor_nco_set_if_hz(1234));
+    CHECK_EQ_U(signal_processor_nco_get_if_hz(), 1234);
+
+    TEST_DONE();
+}
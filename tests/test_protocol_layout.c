@@ -0,0 +1,300 @@
+// test_protocol_layout.c - T.001 message layouts on the host
+//
+// Runs the golden-frame self-test of protocol_layout.c (PROTO TEST on the
+// target), checks which protocol codes may use the short message (user
+// protocols only, location protocols are long-only in T.001) and compares
+// the integer grid encoders with the double-precision formulas they
+// replaced on pseudo-random positions. The ELT(DT) e7 encoder is checked
+// against compute_30min_position() / compute_4sec_offset() on a dense
+// grid, with the documented differences (exact ties, |lat| > 63.75 deg)
+// asserted on their own.
+
+#include "../includes.h"
+#include "../protocol_layout.h"
+#include "../config_store.h"
+#include "../system_debug.h"
+#include "host/test_util.h"
+
+volatile debug_flags_t debug_flags;
+
+// protocol_data.c reads the stored configuration for TEST/EXERCISE frames
+static beacon_config_t config;
+const beacon_config_t *config_get(void) { return &config; }
+
+static void test_codes(void) {
+    for (uint8_t code = 0; code < 16; code++) {
+        const protocol_layout_t *layout = protocol_layout_find(code);
+        CHECK((code == 0 || code == 1) ? !layout : layout && !layout->user);
+        CHECK(!protocol_layout_find(PROTOCOL_SHORT_FLAG | code));
+    }
+    for (uint8_t code = 0; code < 8; code++) {
+        uint8_t valid = (code == 1 || code == 2 || code == 3 || code == 6 || code == 7);
+        const protocol_layout_t *layout = protocol_layout_find(PROTOCOL_USER_FLAG | code);
+        CHECK(valid ? layout && layout->user : !layout);
+        CHECK(valid == (protocol_layout_find(PROTOCOL_SHORT_FLAG | PROTOCOL_USER_FLAG | code) != 0));
+    }
+    CHECK(!protocol_layout_find(PROTOCOL_USER_FLAG | 0xB));
+    CHECK(!protocol_layout_find(0x40 | PROTOCOL_ELT_DT));
+}
+
+static void test_short_frame(void) {
+    uint8_t long_frame[MESSAGE_BITS], short_frame[MESSAGE_BITS];
+    beacon_frame_params_t params = {0x123456UL, 227, PROTOCOL_USER_SERIAL, BEACON_MODE_EXERCISE,
+                                    429546300L, 13644790L, 1080};
+
+    CHECK(protocol_layout_build(&params, long_frame));
+    params.protocol_code |= PROTOCOL_SHORT_FLAG;
+    CHECK(protocol_layout_build(&params, short_frame));
+
+    // Same PDF-1 apart from the format flag, own BCH1, nothing after bit 112
+    CHECK_EQ_U(get_bit_field(short_frame, FRAME_FORMAT_FLAG_BIT, 1), 0);
+    CHECK_EQ_U(get_bit_field(long_frame, FRAME_FORMAT_FLAG_BIT, 1), 1);
+    CHECK_EQ_U(get_bit_field(short_frame, 26, 60), get_bit_field(long_frame, 26, 60));
+    CHECK_EQ_U(get_bit_field(short_frame, FRAME_BCH1_START, FRAME_BCH1_LENGTH),
+               compute_bch1(get_bit_field(short_frame, 25, 61)));
+    CHECK_EQ_U(get_bit_field(short_frame, 107, 6), 0);
+    CHECK_EQ_U(get_bit_field(short_frame, 113, 32), 0);
+
+    // Location protocols build long frames only
+    params.protocol_code = PROTOCOL_SHORT_FLAG | PROTOCOL_ELT_DT;
+    CHECK(!protocol_layout_build(&params, short_frame));
+}
+
+// Previous double-precision grid encoders (reference)
+typedef struct {
+    uint8_t code;
+    uint8_t coarse_start, coarse_bits, offset_start, offset_bits;
+    uint8_t frac_bits, units_per_deg, off_min_bits, off_sec_bits;
+} grid_case_t;
+
+static const grid_case_t grid_cases[] = {
+    {PROTOCOL_STD_ELT_24BIT, 65, 21, 113, 20, 2, 4, 5, 4},
+    {PROTOCOL_NATIONAL_ELT,  59, 27, 112, 14, 5, 30, 2, 4},
+    {PROTOCOL_RLS,           67, 19, 115, 18, 1, 2, 4, 4},
+    {PROTOCOL_USER_SERIAL,  108, 25,   0,  0, 4, 15, 0, 0},
+};
+
+static uint32_t ref_coarse_axis(double x, uint8_t deg_bits, const grid_case_t *g, double *coarse_deg) {
+    uint32_t max_units = (deg_bits == 7 ? 90UL : 180UL) * g->units_per_deg;
+    uint32_t units = (uint32_t)(fabs(x) * g->units_per_deg + 0.5);
+    if (units > max_units) units = max_units;
+    *coarse_deg = (double)units / g->units_per_deg;
+    if (x < 0.0) *coarse_deg = -*coarse_deg;
+    return ((x < 0.0 ? 1UL : 0UL) << (deg_bits + g->frac_bits)) |
+           ((units / g->units_per_deg) << g->frac_bits) | (units % g->units_per_deg);
+}
+
+static uint32_t ref_offset_axis(double x, double coarse_deg, const grid_case_t *g) {
+    double delta = x - coarse_deg;
+    double minutes = fabs(delta) * 60.0;
+    uint32_t min_max = (1UL << g->off_min_bits) - 1;
+    uint32_t whole = (uint32_t)minutes;
+    uint32_t steps = (uint32_t)((minutes - whole) * 15.0 + 0.5);
+    if (steps >= 15) { whole++; steps = 0; }
+    if (whole > min_max) { whole = min_max; steps = 14; }
+    return ((delta >= 0.0 ? 1UL : 0UL) << (g->off_min_bits + g->off_sec_bits)) |
+           (whole << g->off_sec_bits) | steps;
+}
+
+static void test_integer_grids(void) {
+    uint8_t frame[MESSAGE_BITS];
+    uint32_t lcg = 1, bad = 0;
+
+    for (uint8_t c = 0; c < sizeof(grid_cases) / sizeof(grid_cases[0]); c++) {
+        const grid_case_t *g = &grid_cases[c];
+        for (uint16_t n = 0; n < 20000; n++) {
+            lcg = lcg * 1664525UL + 1013904223UL;
+            int32_t lat_e7 = (int32_t)(lcg % 1800000001UL) - 900000000L;
+            lcg = lcg * 1664525UL + 1013904223UL;
+            int32_t lon_e7 = (int32_t)(lcg % 3600000001UL) - 1800000000L;
+            if (n < 4) lat_e7 = (n & 1) ? 900000000L : -900000000L;     // Poles and antimeridian
+            if (n < 4) lon_e7 = (n & 2) ? 1800000000L : -1800000000L;
+
+            beacon_frame_params_t params = {0x123456UL, 227, g->code, BEACON_MODE_EXERCISE, lat_e7, lon_e7, 0};
+            protocol_layout_build(&params, frame);
+
+            double lat = lat_e7 / 1e7, lon = lon_e7 / 1e7, lat_ref, lon_ref;
+            uint32_t coarse = (ref_coarse_axis(lat, 7, g, &lat_ref) << (9 + g->frac_bits)) |
+                              ref_coarse_axis(lon, 8, g, &lon_ref);
+            if (get_bit_field(frame, g->coarse_start, g->coarse_bits) != coarse) bad++;
+            if (g->offset_bits) {
+                uint8_t axis_bits = 1 + g->off_min_bits + g->off_sec_bits;
+                uint32_t offset = (ref_offset_axis(lat, lat_ref, g) << axis_bits) | ref_offset_axis(lon, lon_ref, g);
+                if (get_bit_field(frame, g->offset_start, g->offset_bits) != offset) bad++;
+            }
+        }
+    }
+    CHECK_EQ_U(bad, 0);
+}
+
+// =============================
+// ELT(DT) 30-min / 4-second codes: e7 encoder vs the double reference
+// =============================
+// The double reference misses the e7 arithmetic only where its
+// representation error picks a side: offsets of an exact half 4-second
+// step (|d| = 50000 + 100000.j e7, 9|d| ends in 50000) and exact whole
+// minutes (|d| a multiple of 500000 e7, zero included: the sign can flip).
+// Past |lat| 63.75 deg the 30-min latitude saturates at -128/127 half
+// degrees and the offset can exceed 15 minutes: the e7 encoder saturates
+// the minutes at 15, the double one wraps them through a uint8_t cast
+// (256 minutes and more). Everywhere the e7 codes must equal exact
+// arithmetic, done here in 64 bits without the firmware's divide split.
+#define ELT_GRID_STEP_E7    97          // ~1 cm, prime to the 4-second step
+#define ELT_GRID_POINTS     37113402UL  // lon -180..180 once, lat -90..90 twice
+
+static int16_t ref_sign_extend(uint32_t code, uint8_t bits) {
+    return (int16_t)(code << (16 - bits)) >> (16 - bits);
+}
+
+static uint32_t e7_abs(int64_t d) {
+    return (uint32_t)(d < 0 ? -d : d);
+}
+
+static uint8_t elt_exception(int32_t x_e7, int16_t ref) {
+    uint32_t a = e7_abs((int64_t)x_e7 - (int64_t)ref * 5000000);
+    return a % 100000 == 50000 || a % 500000 == 0;
+}
+
+// Exact minutes of the offset (before the 4-bit saturation)
+static uint64_t elt_exact_minutes(int32_t x_e7, int16_t ref) {
+    return (uint64_t)e7_abs((int64_t)x_e7 - (int64_t)ref * 5000000) * 9 / 1500000;
+}
+
+// Sign | minutes | 4-second steps: 9|d| = minutes.1500000 + rem, steps =
+// rem / 100000 rounded half up
+static uint16_t elt_exact_axis(int32_t x_e7, int16_t ref) {
+    int64_t d = (int64_t)x_e7 - (int64_t)ref * 5000000;
+    uint64_t n9 = (uint64_t)e7_abs(d) * 9;
+    uint64_t minutes = n9 / 1500000, steps = (n9 % 1500000 + 50000) / 100000;
+    if (minutes > 15) minutes = 15;
+    if (steps > 15) steps = 15;
+    return (uint16_t)((d >= 0 ? 0x100 : 0) | (minutes << 4) | steps);
+}
+
+static uint32_t elt_exact_30min(int32_t lat_e7, int32_t lon_e7) {
+    int64_t lat = ((int64_t)lat_e7 + (lat_e7 < 0 ? -2500000 : 2500000)) / 5000000;     // Halves away from 0
+    int64_t lon = ((int64_t)lon_e7 + (lon_e7 < 0 ? -2500000 : 2500000)) / 5000000;
+    if (lat < -128) lat = -128;
+    if (lat > 127) lat = 127;
+    return ((uint32_t)(lat & 0x1FF) << 10) | (uint32_t)(lon & 0x3FF);
+}
+
+static void test_elt_dt_grid(void) {
+    uint32_t bad_exact = 0, bad_double = 0, excused = 0, wrapped = 0;
+
+    for (uint32_t k = 0; k <= ELT_GRID_POINTS; k++) {
+        int32_t lon_e7 = -1800000000L + (int32_t)(k * ELT_GRID_STEP_E7);
+        int32_t lat_e7 = -900000000L + (int32_t)((uint64_t)k * ELT_GRID_STEP_E7 % 1800000001UL);
+        double lat = lat_e7 / 1e7, lon = lon_e7 / 1e7;
+
+        uint32_t pos30 = compute_30min_position_e7(lat_e7, lon_e7);
+        uint32_t offset = compute_4sec_offset_e7(lat_e7, lon_e7, pos30);
+        uint32_t pos30_double = compute_30min_position(lat, lon);
+        uint32_t offset_double = compute_4sec_offset(lat, lon, pos30_double);
+        int16_t lat_ref = ref_sign_extend(pos30 >> 10, 9), lon_ref = ref_sign_extend(pos30, 10);
+
+        if (pos30 != elt_exact_30min(lat_e7, lon_e7) ||
+            offset != (((uint32_t)elt_exact_axis(lat_e7, lat_ref) << 9) | elt_exact_axis(lon_e7, lon_ref))) {
+            bad_exact++;
+        }
+        if (pos30 != pos30_double) bad_double++;    // No exception for the 30-min code
+        if (offset == offset_double) continue;
+
+        uint16_t lat_axis = offset >> 9, lon_axis = offset & 0x1FF;
+        uint16_t lat_double = offset_double >> 9, lon_double = offset_double & 0x1FF;
+        if (lat_axis != lat_double) {
+            if (elt_exact_minutes(lat_e7, lat_ref) >= 256) wrapped++;
+            else if (elt_exception(lat_e7, lat_ref)) excused++;
+            else bad_double++;
+        }
+        if (lon_axis != lon_double) {
+            if (elt_exception(lon_e7, lon_ref)) excused++;
+            else bad_double++;
+        }
+    }
+    printf("ELT(DT) grid: %lu points, %lu differ from exact, %lu from double "
+           "(%lu ties/whole minutes, %lu wrapped minutes excused)\n",
+           ELT_GRID_POINTS + 1, (unsigned long)bad_exact, (unsigned long)bad_double,
+           (unsigned long)excused, (unsigned long)wrapped);
+    CHECK_EQ_U(bad_exact, 0);
+    CHECK_EQ_U(bad_double, 0);
+    CHECK(wrapped > 0);                             // The grid reaches the wrap region
+}
+
+// Every exact tie and whole minute within 16 minutes of every reference
+// point: the e7 encoder rounds ties up (half a step away from the
+// reference) and a whole minute gives 0 steps with the sign bit set at 0
+static void test_elt_dt_ties(void) {
+    uint32_t ties = 0, minutes = 0, bad = 0, double_differs = 0;
+
+    for (int16_t ref = -360; ref <= 360; ref++) {
+        for (int32_t d = -2700000; d <= 2700000; d += 50000) {      // 16.2 minutes
+            int32_t x_e7 = ref * 5000000L + d;
+            if (x_e7 < -1800000000L || x_e7 > 1800000000L) continue;
+            uint32_t a = e7_abs(d);
+            uint8_t tie = (a % 100000 == 50000), whole = (a % 500000 == 0);
+            if (!tie && !whole) continue;
+
+            uint32_t pos30 = compute_30min_position_e7(0, x_e7);
+            if (ref_sign_extend(pos30, 10) != ref) continue;       // Other reference cell
+            uint16_t axis = compute_4sec_offset_e7(0, x_e7, pos30) & 0x1FF;
+            uint32_t n9 = a * 9;
+            uint16_t expect_min = n9 / 1500000, expect_steps;
+
+            if (tie) {
+                expect_steps = (n9 % 1500000) / 100000 + 1;         // Half step: up
+                ties++;
+            } else {
+                expect_steps = 0;
+                minutes++;
+            }
+            if (expect_min > 15) expect_min = 15;
+            if (expect_steps > 15) expect_steps = 15;
+            if (axis != ((d >= 0 ? 0x100 : 0) | (expect_min << 4) | expect_steps)) bad++;
+
+            double x = x_e7 / 1e7;
+            if ((compute_4sec_offset(0.0, x, compute_30min_position(0.0, x)) & 0x1FF) != axis) double_differs++;
+        }
+    }
+    printf("ELT(DT) exact points: %lu ties, %lu whole minutes, %lu wrong, double differs on %lu\n",
+           (unsigned long)ties, (unsigned long)minutes, (unsigned long)bad, (unsigned long)double_differs);
+    CHECK(ties > 10000 && minutes > 5000);
+    CHECK_EQ_U(bad, 0);
+    CHECK(double_differs > 0);                      // The documented exception is real
+}
+
+// |lat| > 63.75 deg: 30-min latitude saturated on both encoders, e7 offset
+// minutes saturated at 15
+static void test_elt_dt_saturation(void) {
+    uint32_t points = 0, bad = 0;
+
+    for (int32_t lat_e7 = 637500001L; lat_e7 <= 900000000L; lat_e7 += 9973) {
+        for (int8_t sign = -1; sign <= 1; sign += 2) {
+            int32_t x_e7 = sign * lat_e7;
+            uint32_t pos30 = compute_30min_position_e7(x_e7, 0);
+            int16_t ref = ref_sign_extend(pos30 >> 10, 9);
+            uint16_t axis = compute_4sec_offset_e7(x_e7, 0, pos30) >> 9;
+            uint64_t exact_min = elt_exact_minutes(x_e7, ref);
+
+            points++;
+            if (pos30 != compute_30min_position(x_e7 / 1e7, 0.0)) bad++;
+            if (sign > 0 ? ref != 127 : (x_e7 < -642500000L && ref != -128)) bad++;
+            if (exact_min >= 15 && ((axis >> 4) & 0xF) != 15) bad++;
+            if (axis != elt_exact_axis(x_e7, ref)) bad++;
+        }
+    }
+    printf("ELT(DT) |lat| > 63.75: %lu points, %lu wrong\n", (unsigned long)points, (unsigned long)bad);
+    CHECK_EQ_U(bad, 0);
+}
+
+int main(void) {
+    debug_flags.gps_encoding_printed = 1;           // No first-encode debug dump
+    test_codes();
+    test_short_frame();
+    test_integer_grids();
+    test_elt_dt_grid();
+    test_elt_dt_ties();
+    test_elt_dt_saturation();
+    CHECK(protocol_layout_self_test());
+    TEST_DONE();
+}
@@ -0,0 +1,115 @@
+// test_pulse_shaping.c - Spectrum of the shaped Biphase-L transitions
+//
+// Builds the complex baseband the I/Q tables put on the ADL5375 for a long
+// pseudo-random bit stream, zero-order held at 16x SAMPLE_RATE_HZ as the
+// MCP4922 outputs it (before the reconstruction filter), and reports the
+// peak level outside +/-1.2, 3 and 7.5 kHz relative to the unmodulated
+// carrier in a 100 Hz resolution bandwidth. Hard steps (rise time 0) are the
+// reference: the raised-cosine transitions must not be worse anywhere and
+// must be clearly better beyond the main lobe.
+
+#include "../includes.h"
+#include "../signal_processor.h"
+#include "../system_comms.h"
+#include "host/spectrum.h"
+#include "host/test_util.h"
+
+#define HOLD                16                              // ZOH subsamples per DAC update
+#define FS_HZ               ((double)SAMPLE_RATE_HZ * HOLD) // 102.4 kHz
+#define FFT_POINTS          1024                            // 100 Hz bins
+#define TEST_BITS           1500
+#define TEST_LENGTH         ((uint32_t)TEST_BITS * SAMPLES_PER_SYMBOL * HOLD)
+
+static const double offsets_hz[] = { 1200.0, 3000.0, 7500.0 };
+#define OFFSET_COUNT        (sizeof(offsets_hz) / sizeof(offsets_hz[0]))
+
+static double sig_re[TEST_LENGTH], sig_im[TEST_LENGTH];
+static double psd[FFT_POINTS], work_re[FFT_POINTS], work_im[FFT_POINTS];
+static double carrier_peak;
+
+static uint32_t lcg_state;
+
+static uint8_t next_bit(void) {
+    lcg_state = lcg_state * 1664525UL + 1013904223UL;
+    return (uint8_t)(lcg_state >> 31);
+}
+
+static double iq_bias_code(void) {
+    mcp4922_iq_sample_t idle = signal_processor_get_iq_idle();
+    return idle.i_code;
+}
+
+// Peak PSD beyond each offset, dB relative to the carrier
+static void measure(uint16_t rise_time_us, double *level_db) {
+    double bias = iq_bias_code();
+    uint8_t prev_bit = SHAPE_NO_PREV_BIT;
+    uint32_t n = 0;
+
+    signal_processor_set_rise_time_us(rise_time_us);
+    lcg_state = 12345;
+    for (uint16_t b = 0; b < TEST_BITS; b++) {
+        uint8_t bit = next_bit();
+        for (uint16_t s = 0; s < SAMPLES_PER_SYMBOL; s++) {
+            mcp4922_iq_sample_t iq = signal_processor_get_shaped_biphase_l_iq(prev_bit, bit, s);
+            for (uint16_t h = 0; h < HOLD; h++, n++) {
+                sig_re[n] = iq.i_code - bias;
+                sig_im[n] = iq.q_code - bias;
+            }
+        }
+        prev_bit = bit;
+    }
+    spectrum_welch(sig_re, sig_im, TEST_LENGTH, FFT_POINTS, psd, work_re, work_im);
+
+    for (uint8_t o = 0; o < OFFSET_COUNT; o++) {
+        double peak = 0.0;
+        for (uint32_t k = 0; k < FFT_POINTS; k++) {
+            if (fabs(spectrum_bin_hz(k, FFT_POINTS, FS_HZ)) >= offsets_hz[o] && psd[k] > peak) peak = psd[k];
+        }
+        level_db[o] = 10.0 * log10(peak / carrier_peak);
+    }
+}
+
+// Reference: unmodulated carrier through the same window and averaging
+static void measure_carrier(void) {
+    mcp4922_iq_sample_t iq = signal_processor_get_iq_carrier(1, 1);
+    double bias = iq_bias_code();
+
+    for (uint32_t n = 0; n < TEST_LENGTH; n++) {
+        sig_re[n] = iq.i_code - bias;
+        sig_im[n] = iq.q_code - bias;
+    }
+    spectrum_welch(sig_re, sig_im, TEST_LENGTH, FFT_POINTS, psd, work_re, work_im);
+    carrier_peak = psd[0];
+}
+
+int main(void) {
+    static const uint16_t rise_us[] = { 0, SHAPE_RISE_TIME_US, 470 };
+    double level[3][OFFSET_COUNT];
+
+    signal_processor_init();
+    measure_carrier();
+    CHECK(carrier_peak > 0.0);
+
+    printf("rise (us/samples)   >1.2 kHz   >3 kHz   >7.5 kHz   (dBc, 100 Hz RBW)\n");
+    for (uint8_t r = 0; r < 3; r++) {
+        measure(rise_us[r], level[r]);
+        printf("%4u / %u          %8.1f %8.1f %9.1f\n", rise_us[r], signal_processor_get_rise_samples(),
+               level[r][0], level[r][1], level[r][2]);
+    }
+
+    CHECK_EQ_U(signal_processor_set_rise_time_us(0), 0);
+    CHECK_EQ_U(signal_processor_set_rise_time_us(SHAPE_RISE_TIME_US), 1);
+    CHECK_EQ_U(signal_processor_set_rise_time_us(470), 3);
+
+    // Shaped never worse than hard steps, and longer rise never worse
+    for (uint8_t o = 0; o < OFFSET_COUNT; o++) {
+        CHECK(level[1][o] <= level[0][o] + 0.1);
+        CHECK(level[2][o] <= level[1][o] + 0.1);
+    }
+    // Clear gain beyond the main lobe
+    CHECK(level[1][0] < level[0][0] - 1.0);
+    CHECK(level[2][1] < level[0][1] - 4.0);
+    CHECK(level[2][2] < level[0][2] - 2.0);
+
+    TEST_DONE();
+}
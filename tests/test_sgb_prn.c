@@ -0,0 +1,120 @@
+// test_sgb_prn.c - T.018 PRN: block and jump-ahead generators
+//
+// sgb_prn_next16() and sgb_prn_jump() against a naive one-chip LFSR
+// (s[n+23] = s[n+18] ^ s[n], state bit k = s[n+k]) over a whole burst of
+// both channels, from arbitrary states and across the full 2^23 - 1
+// period, then a timing report: 1-chip, 16-chip and jump-ahead.
+
+#include "../includes.h"
+#include "../sgb_t018.h"
+#include "host/test_util.h"
+#include <time.h>
+
+#define PRN_PERIOD      ((1UL << SGB_PRN_DEGREE) - 1)
+
+static uint32_t naive_step(uint32_t *state) {
+    uint32_t s = *state;
+    uint32_t chip = s & 1;
+    *state = (s >> 1) | ((((s >> 18) ^ s) & 1) << 22);
+    return chip;
+}
+
+static void test_block(uint32_t init) {
+    sgb_prn_t block;
+    uint32_t ref = init;
+    uint32_t bad = 0;
+
+    sgb_prn_init(&block, init);
+    for (uint32_t n = 0; n < SGB_CHIPS_PER_CHANNEL; n += SGB_PRN_BLOCK) {
+        uint16_t word = 0;
+        for (uint8_t k = 0; k < SGB_PRN_BLOCK; k++) word |= (uint16_t)naive_step(&ref) << k;
+        if (sgb_prn_next16(&block) != word || block.state != ref) bad++;
+    }
+    CHECK_EQ_U(bad, 0);
+}
+
+static void test_jump(uint32_t init) {
+    static const uint32_t jumps[] = {0, 1, 15, 16, 17, 22, 23, 255, 256, 12800, 38399, 38400, 1000003};
+    uint32_t ref = init;
+    uint32_t at = 0;
+
+    for (uint8_t j = 0; j < sizeof(jumps) / sizeof(jumps[0]); j++) {
+        sgb_prn_t jump;
+        while (at < jumps[j]) {
+            naive_step(&ref);
+            at++;
+        }
+        sgb_prn_init(&jump, init);
+        sgb_prn_jump(&jump, jumps[j]);
+        CHECK_EQ_U(jump.state, ref);
+    }
+
+    // Whole period and one more chip
+    sgb_prn_t jump;
+    sgb_prn_init(&jump, init);
+    sgb_prn_jump(&jump, PRN_PERIOD);
+    CHECK_EQ_U(jump.state, init & SGB_PRN_MASK);
+    uint32_t one = init & SGB_PRN_MASK;
+    naive_step(&one);
+    sgb_prn_init(&jump, init);
+    sgb_prn_jump(&jump, PRN_PERIOD + 1);
+    CHECK_EQ_U(jump.state, one);
+}
+
+// The single-chip generator against the naive one, and a full period
+static void test_period(void) {
+    sgb_prn_t prn;
+    uint32_t ref = SGB_PRN_INIT_I_NORMAL, bad = 0;
+
+    sgb_prn_init(&prn, SGB_PRN_INIT_I_NORMAL);
+    for (uint32_t n = 0; n < PRN_PERIOD; n++) {
+        if (sgb_prn_next(&prn) != naive_step(&ref)) bad++;
+        if (n + 1 < PRN_PERIOD && prn.state == SGB_PRN_INIT_I_NORMAL) bad++;    // Maximal length
+    }
+    CHECK_EQ_U(bad, 0);
+    CHECK_EQ_U(prn.state, SGB_PRN_INIT_I_NORMAL);
+}
+
+static double elapsed_ns(struct timespec a, struct timespec b) {
+    return (b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec);
+}
+
+static void benchmark(void) {
+    const uint32_t chips = 16UL * SGB_CHIPS_PER_CHANNEL;
+    volatile uint32_t sink = 0;
+    struct timespec t0, t1, t2, t3;
+    sgb_prn_t prn;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    sgb_prn_init(&prn, SGB_PRN_INIT_I_NORMAL);
+    for (uint32_t n = 0; n < chips; n++) sink += sgb_prn_next(&prn);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sgb_prn_init(&prn, SGB_PRN_INIT_I_NORMAL);
+    for (uint32_t n = 0; n < chips; n += SGB_PRN_BLOCK) sink += sgb_prn_next16(&prn);
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    for (uint16_t n = 0; n < 1000; n++) {
+        sgb_prn_init(&prn, SGB_PRN_INIT_I_NORMAL);
+        sgb_prn_jump(&prn, SGB_CHIPS_PER_CHANNEL - 1);
+        sink += prn.state;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t3);
+
+    double one = elapsed_ns(t0, t1) / chips;
+    double block = elapsed_ns(t1, t2) / chips;
+    printf("1-chip %.2f ns/chip, 16-chip %.2f ns/chip (%.1fx), jump to chip %lu %.0f ns\n",
+           one, block, one / block, (unsigned long)(SGB_CHIPS_PER_CHANNEL - 1), elapsed_ns(t2, t3) / 1000);
+    CHECK(block < one);
+    (void)sink;
+}
+
+int main(void) {
+    static const uint32_t inits[] = {SGB_PRN_INIT_I_NORMAL, SGB_PRN_INIT_Q_NORMAL, 0x7FFFFF, 0x555555, 0x400000};
+
+    for (uint8_t i = 0; i < sizeof(inits) / sizeof(inits[0]); i++) {
+        test_block(inits[i]);
+        test_jump(inits[i]);
+    }
+    test_period();
+    benchmark();
+    TEST_DONE();
+}
@@ -0,0 +1,164 @@
+// test_sgb_t018.c - Bit-exact T.018 transmit chain on the host
+//
+// Runs SGB TEST (frame + BCH golden, published PRN chips, chip stream from
+// the refill), then plays back a whole burst started by sgb_transmit() and
+// compares every I and Q chip with a naive model written from the
+// specification: one-chip LFSR s[n+23] = s[n+18] ^ s[n], odd frame bits on
+// I, even bits on Q, Q half a chip late. The BCH parity is checked by plain
+// long division of the 250-bit codeword by g(x).
+
+#include "../includes.h"
+#include "../sgb_t018.h"
+#include "../signal_processor.h"
+#include "../system_comms.h"
+#include "host/test_util.h"
+
+#define SAMPLES         SGB_SAMPLES_PER_CHIP
+#define BURST_WORDS     ((SGB_CHIPS_PER_CHANNEL + 2) * 2 * SAMPLES)
+
+extern volatile uint16_t *host_dma_buffer;
+extern uint16_t host_dma_count;
+extern uint32_t host_dma_rate;
+extern mcp4922_dma_refill_t host_dma_refill;
+extern uint16_t host_accounted_ms;
+extern uint32_t host_duty_wait_ms;
+
+static uint16_t stream[BURST_WORDS + 1024];
+static uint8_t ref_i[SGB_CHIPS_PER_CHANNEL], ref_q[SGB_CHIPS_PER_CHANNEL];
+
+// Reference sequence: state bit k = s[k]
+static void naive_prn(uint32_t init, uint8_t *chips, uint32_t count) {
+    uint8_t s[SGB_CHIPS_PER_CHANNEL + SGB_PRN_DEGREE];
+    for (uint8_t k = 0; k < SGB_PRN_DEGREE; k++) s[k] = (init >> k) & 1;
+    for (uint32_t n = 0; n < count; n++) {
+        s[n + 23] = s[n + 18] ^ s[n];
+        chips[n] = s[n];
+    }
+}
+
+static uint8_t frame_bit(const uint8_t *frame, uint16_t index) {
+    return (frame[index / 8] >> (7 - index % 8)) & 1;
+}
+
+static uint64_t first64(const uint8_t *chips) {
+    uint64_t v = 0;
+    for (uint8_t k = 0; k < 64; k++) v = (v << 1) | chips[k];
+    return v;
+}
+
+static void check_bch(const uint8_t *frame) {
+    uint8_t r[SGB_INFO_BITS + SGB_PARITY_BITS];
+
+    for (uint16_t i = 0; i < SGB_INFO_BITS + SGB_PARITY_BITS; i++) r[i] = frame_bit(frame, SGB_PREAMBLE_BITS + i);
+    for (uint16_t i = 0; i < SGB_INFO_BITS; i++) {
+        if (!r[i]) continue;
+        for (uint8_t j = 0; j <= SGB_PARITY_BITS; j++) r[i + j] ^= (SGB_BCH_POLY >> (SGB_PARITY_BITS - j)) & 1;
+    }
+    uint8_t zero = 1;
+    for (uint16_t i = SGB_INFO_BITS; i < SGB_INFO_BITS + SGB_PARITY_BITS; i++) if (r[i]) zero = 0;
+    CHECK(zero);
+}
+
+static void test_burst(void) {
+    beacon_frame_params_t params = {0x2ABCDEUL, 366, PROTOCOL_ELT_DT, BEACON_MODE_TEST,
+                                    -338688000L, -706693000L, 520};
+    uint8_t frame[SGB_FRAME_BYTES];
+    uint32_t words = 0;
+
+    CHECK(!sgb_transmit(&params));                  // Needs MOD IQ
+    CHECK(signal_processor_set_mode(MOD_MODE_IQ_MCP4922));
+    host_duty_wait_ms = 2500;                       // Over the duty limit: held
+    CHECK(!sgb_transmit(&params));
+    CHECK(host_dma_refill == 0);
+    host_duty_wait_ms = 0;
+    CHECK(sgb_transmit(&params));
+    CHECK(host_dma_refill != 0);
+    CHECK_EQ_U(host_dma_rate, SGB_WORD_RATE_HZ);
+    CHECK_EQ_U(host_accounted_ms, SGB_BURST_DURATION_MS);
+    if (!host_dma_refill) return;
+
+    // Ping-pong halves until the refill asks to stop
+    uint16_t half = host_dma_count / 2;
+    uint8_t more = 1;
+    for (uint8_t h = 0; more && words + half <= sizeof(stream) / sizeof(stream[0]); h ^= 1) {
+        volatile uint16_t *w = host_dma_buffer + h * half;
+        more = host_dma_refill(w, half);
+        for (uint16_t n = 0; n < half; n++) stream[words++] = w[n];
+    }
+    CHECK(!more);
+    CHECK(words >= BURST_WORDS);
+
+    sgb_build_frame(&params, frame);
+    check_bch(frame);
+    CHECK(frame_bit(frame, SGB_PREAMBLE_BITS + 42));    // Test-protocol flag (bit 43)
+
+    naive_prn(SGB_PRN_INIT_I_NORMAL, ref_i, SGB_CHIPS_PER_CHANNEL);
+    naive_prn(SGB_PRN_INIT_Q_NORMAL, ref_q, SGB_CHIPS_PER_CHANNEL);
+    CHECK_EQ_U(first64(ref_i), 0x80000108421284A1ULL);  // T.018 normal-mode I
+    CHECK_EQ_U(first64(ref_q), 0x3F8358BAD030F231ULL);  // T.018 normal-mode Q
+
+    // Words alternate DAC A (I) and DAC B (Q); I chip k on samples 4k..4k+3,
+    // Q chip k on 4k+2..4k+5. Every sample must carry its chip's sign.
+    uint32_t bad_i = 0, bad_q = 0, bad_cmd = 0;
+    for (uint32_t k = 0; k < SGB_CHIPS_PER_CHANNEL; k++) {
+        uint16_t bit = (uint16_t)(k / SGB_CHIPS_PER_BIT) * 2;
+        uint8_t chip_i = ref_i[k] ^ frame_bit(frame, bit);
+        uint8_t chip_q = ref_q[k] ^ frame_bit(frame, bit + 1);
+        for (uint8_t j = 0; j < SAMPLES; j++) {
+            uint32_t n = k * SAMPLES + j;
+            int16_t i = (int16_t)(stream[2 * n] & 0x0FFF) - MCP4922_OFFSET;
+            int16_t q = (int16_t)(stream[2 * (n + SAMPLES / 2) + 1] & 0x0FFF) - MCP4922_OFFSET;
+            if (j > 0 && (i < 0) != chip_i) bad_i++;
+            if (j == 0 && i != 0) bad_i++;              // Half-sine zero at the chip edge
+            if ((q < 0) != chip_q || q == 0) bad_q++;
+            if ((stream[2 * n] & 0xF000) != MCP4922_DAC_A_CMD) bad_cmd++;
+            if ((stream[2 * n + 1] & 0xF000) != MCP4922_DAC_B_CMD) bad_cmd++;
+        }
+    }
+    CHECK_EQ_U(bad_i, 0);
+    CHECK_EQ_U(bad_q, 0);
+    CHECK_EQ_U(bad_cmd, 0);
+
+    // After the last Q half chip both DACs sit at mid-scale
+    for (uint32_t n = 2 * (SGB_CHIPS_PER_CHANNEL * SAMPLES + SAMPLES / 2); n < words; n++) {
+        if ((stream[n] & 0x0FFF) != MCP4922_OFFSET) {
+            CHECK_EQ_U(n, 0);
+            break;
+        }
+    }
+}
+
+// Integer position encoder against the double-precision formula it replaced
+static void test_position(void) {
+    uint8_t frame[SGB_FRAME_BYTES];
+    uint32_t lcg = 7, bad = 0;
+
+    for (uint16_t n = 0; n < 20000; n++) {
+        lcg = lcg * 1664525UL + 1013904223UL;
+        int32_t lat_e7 = (int32_t)(lcg % 1800000001UL) - 900000000L;
+        lcg = lcg * 1664525UL + 1013904223UL;
+        int32_t lon_e7 = (int32_t)(lcg % 3600000001UL) - 1800000000L;
+        beacon_frame_params_t params = {0x123456UL, 227, PROTOCOL_ELT_DT, BEACON_MODE_EXERCISE, lat_e7, lon_e7, 0};
+        sgb_build_frame(&params, frame);
+
+        for (uint8_t axis = 0; axis < 2; axis++) {
+            double x = (axis ? lon_e7 : lat_e7) / 1e7;
+            uint8_t deg_bits = axis ? 8 : 7;
+            uint32_t expect = ((x < 0.0 ? 1UL : 0UL) << (deg_bits + 15)) | (uint32_t)(fabs(x) * 32768.0 + 0.5);
+            uint32_t got = 0;
+            for (uint8_t i = 0; i < deg_bits + 16; i++) {
+                got = (got << 1) | frame_bit(frame, SGB_PREAMBLE_BITS + (axis ? 66 : 43) + i);
+            }
+            if (got != expect) bad++;
+        }
+    }
+    CHECK_EQ_U(bad, 0);
+}
+
+int main(void) {
+    signal_processor_init();
+    CHECK(sgb_self_test());
+    test_burst();
+    test_position();
+    TEST_DONE();
+}
@@ -0,0 +1,293 @@
+// test_tx_scheduler.c - Duty-cycle limit with every burst source
+//
+// tx_sched_fit_ms() against a brute-force search over random burst
+// histories, a burst slipped in between a slot's prepare and fire, slots of
+// a short-message protocol, then two hours of simulated traffic at 1 ms
+// resolution: the periodic slots (tx_sched_poll) with SGB commands, then the
+// virtual beacon table at its per-beacon minimum periods with SGB commands.
+// The sources use the scheduler as the firmware does (slot FIRE,
+// tx_sched_can_fire gate, tx_sched_account at the carrier start). Every 60 s
+// window of the burst log is then summed independently of the accountant.
+
+#include "../includes.h"
+#include "../tx_scheduler.h"
+#include "../system_definitions.h"
+#include "../system_comms.h"
+#include "../config_store.h"
+#include "../sgb_t018.h"
+#include "../vbeacon.h"
+#include "../protocol_layout.h"
+#include "host/test_util.h"
+
+#define SIM_PHASE_MS        3600000UL
+#define LOG_MAX             4096
+#define VB_COUNT            8
+#define VB_GAP_MS           1000        // VBEACON_MIN_GAP_MS
+#define RF_WARMUP_MS        10          // TX_START_ASAP: carrier after the warm-up
+
+volatile tx_phase_t tx_phase = IDLE_STATE;
+
+static uint32_t sim_ms;
+static beacon_config_t sim_config;
+
+uint64_t now_us(void) { return (uint64_t)sim_ms * 1000; }
+uint32_t now_ms(void) { return sim_ms; }
+const beacon_config_t *config_get(void) { return &sim_config; }
+
+static uint32_t rng_state = 0x9E3779B9;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1664525UL + 1013904223UL;
+    return rng_state >> 8;
+}
+
+// =============================
+// tx_sched_fit_ms() vs brute force
+// =============================
+typedef struct {
+    uint32_t start_ms;
+    uint16_t duration_ms;
+} burst_t;
+
+static uint32_t overlap(const burst_t *bursts, uint16_t count, uint32_t from, uint32_t to) {
+    uint32_t total = 0;
+    for (uint16_t n = 0; n < count; n++) {
+        uint32_t a = bursts[n].start_ms, b = a + bursts[n].duration_ms;
+        if (a < from) a = from;
+        if (b > to) b = to;
+        if (b > a) total += b - a;
+    }
+    return total;
+}
+
+static void test_fit(void) {
+    uint32_t bad = 0, moved = 0;
+
+    for (uint16_t trial = 0; trial < 400; trial++) {
+        burst_t bursts[TX_SCHED_BURST_RECORDS];
+        uint16_t count = (uint16_t)(1 + rng() % 12);
+        uint32_t t = 100000 + rng() % 1000;
+
+        tx_sched_init();
+        for (uint16_t n = 0; n < count; n++) {
+            static const uint16_t durations[] = { 440, 520, SGB_BURST_DURATION_MS };
+            bursts[n].start_ms = t;
+            bursts[n].duration_ms = durations[rng() % 3];
+            tx_sched_account(t, bursts[n].duration_ms);
+            t += bursts[n].duration_ms + rng() % 6000;
+        }
+
+        uint16_t duration = (rng() & 1) ? 520 : SGB_BURST_DURATION_MS;
+        uint32_t start = t;                         // After the last recorded burst
+        uint32_t expect = start;
+        while (overlap(bursts, count, expect + duration - TX_SCHED_DUTY_WINDOW_MS, expect + duration) + duration >
+               TX_SCHED_DUTY_LIMIT_MS) {
+            expect++;
+        }
+        if (expect != start) moved++;
+        if (tx_sched_fit_ms(start, duration) != expect) bad++;
+        if (tx_sched_can_fire(start, duration) != (expect == start)) bad++;
+    }
+    printf("fit: 400 random histories, %lu start times moved, %lu wrong\n", (unsigned long)moved,
+           (unsigned long)bad);
+    CHECK_EQ_U(bad, 0);
+    CHECK(moved > 50);
+}
+
+// SGB burst between the slot's PREPARE and FIRE: the slot is moved, not fired
+static void test_burst_after_prepare(void) {
+    sim_ms = 200000;
+    tx_phase = IDLE_STATE;
+    tx_sched_init();
+    tx_sched_set_interval(MIN_TX_INTERVAL_MS);
+    tx_sched_account(sim_ms - 30000, 2200);         // 2.2 s of the 3.6 s budget used
+
+    while (tx_sched_poll(sim_ms) != TX_SCHED_PREPARE) sim_ms++;
+    uint32_t slot = tx_sched_next_ms();
+    CHECK(tx_sched_can_fire(sim_ms, SGB_BURST_DURATION_MS));
+    tx_sched_account(sim_ms, SGB_BURST_DURATION_MS);     // 3.2 s used, the slot no longer fits
+
+    uint8_t event;
+    uint32_t limit = sim_ms + 120000;
+    while ((event = tx_sched_poll(sim_ms)) != TX_SCHED_FIRE && sim_ms < limit) sim_ms++;
+    CHECK_EQ_U(event, TX_SCHED_FIRE);
+    CHECK(tx_sched_slot_ms() > slot);
+    CHECK_EQ_U(tx_sched_fit_ms(tx_sched_slot_ms(), TOTAL_BURST_DURATION_MS), tx_sched_slot_ms());
+}
+
+// Slot fit and period floor follow the configured protocol's burst: with
+// 3160 ms used a 440 ms short burst still fits on the slot, a 520 ms one not
+static void test_short_slots(void) {
+    static const uint8_t codes[] = { PROTOCOL_ELT_DT, PROTOCOL_SHORT_FLAG | PROTOCOL_USER_SERIAL };
+
+    for (uint8_t c = 0; c < 2; c++) {
+        uint8_t is_short = PROTOCOL_IS_SHORT(codes[c]);
+        sim_ms = 300000;
+        tx_phase = IDLE_STATE;
+        sim_config.protocol_code = codes[c];
+        tx_sched_init();
+        tx_sched_set_interval(MIN_TX_INTERVAL_MS);
+        tx_sched_account(sim_ms - 30000, TX_SCHED_DUTY_LIMIT_MS - SHORT_BURST_DURATION_MS);
+
+        uint32_t slot = tx_sched_next_ms();
+        uint8_t event;
+        while ((event = tx_sched_poll(sim_ms)) != TX_SCHED_FIRE && sim_ms < slot + 60000) sim_ms++;
+        CHECK_EQ_U(event, TX_SCHED_FIRE);
+        CHECK_EQ_U(tx_sched_slot_ms() == slot, is_short);
+
+        uint32_t period = tx_sched_next_ms() - tx_sched_slot_ms();
+        uint32_t floor = is_short ? TX_SCHED_MIN_PERIOD_FOR(SHORT_BURST_DURATION_MS) : TX_SCHED_MIN_PERIOD_MS;
+        CHECK(period >= floor && period <= floor + floor * TX_SCHED_JITTER_PERMIL * 2 / 1000);
+    }
+    sim_config.protocol_code = PROTOCOL_ELT_DT;
+}
+
+// =============================
+// Traffic simulation
+// =============================
+static burst_t sim_log[LOG_MAX];
+static uint16_t sim_count;
+static uint32_t sim_on_air_until;
+static uint32_t sim_last_end;
+
+static uint32_t sgb_next_try, sgb_sent, sgb_held;
+static uint32_t periodic_sent;
+static uint32_t vb_due[VB_COUNT], vb_sent, vb_held;
+static uint8_t vb_waiting;
+
+static void sim_burst(uint32_t start_ms, uint16_t duration_ms) {
+    CHECK(start_ms >= sim_on_air_until);            // One transmitter
+    if (sim_count < LOG_MAX) {
+        sim_log[sim_count].start_ms = start_ms;
+        sim_log[sim_count].duration_ms = duration_ms;
+        sim_count++;
+    }
+    tx_sched_account(start_ms, duration_ms);
+    sim_on_air_until = start_ms + duration_ms;
+    sim_last_end = sim_on_air_until;
+    tx_phase = DATA_TX;
+}
+
+static void sim_tick(void) {
+    if (tx_phase != IDLE_STATE && sim_ms >= sim_on_air_until) tx_phase = IDLE_STATE;
+}
+
+// SGB command at random instants (sgb_transmit: idle transmitter and the gate)
+static void sim_sgb(void) {
+    if ((int32_t)(sim_ms - sgb_next_try) < 0 || tx_phase != IDLE_STATE) return;
+    sgb_next_try = sim_ms + 2000 + rng() % 15000;
+    if (!tx_sched_can_fire(sim_ms, SGB_BURST_DURATION_MS)) {
+        sgb_held++;
+        return;
+    }
+    sim_burst(sim_ms, SGB_BURST_DURATION_MS);
+    sgb_sent++;
+}
+
+// main.c periodic path: carrier on the slot, accounted from there
+static void sim_periodic(void) {
+    if (tx_sched_poll(sim_ms) == TX_SCHED_FIRE) {
+        uint32_t slot = tx_sched_slot_ms();
+        sim_burst(slot > sim_ms ? slot : sim_ms, TOTAL_BURST_DURATION_MS);
+        periodic_sent++;
+    }
+}
+
+// vbeacon_poll(): idle channel, gap after the last burst, round robin, gate
+static void sim_vbeacons(void) {
+    static uint8_t next = 0;
+
+    if (tx_phase != IDLE_STATE || sim_ms - sim_last_end < VB_GAP_MS) return;
+    for (uint8_t n = 0; n < VB_COUNT; n++) {
+        uint8_t i = (uint8_t)((next + n) % VB_COUNT);
+        uint16_t bits = (i & 1) ? SHORT_MESSAGE_BITS : LONG_MESSAGE_BITS;
+        uint16_t duration = (uint16_t)FRAME_BURST_DURATION_MS(bits);
+
+        if ((int32_t)(sim_ms - vb_due[i]) < 0) continue;
+        if (!tx_sched_can_fire(sim_ms, duration)) {
+            if (!vb_waiting) vb_held++;             // Held bursts, not polls
+            vb_waiting = 1;
+            return;
+        }
+        vb_waiting = 0;
+        sim_burst(sim_ms + RF_WARMUP_MS, duration);
+        vb_due[i] = sim_ms + VBEACON_MIN_INTERVAL_FOR(bits);
+        vb_sent++;
+        next = (uint8_t)((i + 1) % VB_COUNT);
+        return;
+    }
+}
+
+// Largest airtime of any 60 s window: the maximum is at a burst end
+static uint32_t max_window_airtime(uint16_t from, uint16_t to) {
+    uint32_t max = 0;
+    for (uint16_t n = from; n < to; n++) {
+        uint32_t end = sim_log[n].start_ms + sim_log[n].duration_ms;
+        uint32_t airtime = overlap(&sim_log[from], to - from, end - TX_SCHED_DUTY_WINDOW_MS, end);
+        if (airtime > max) max = airtime;
+    }
+    return max;
+}
+
+static uint32_t total_airtime(uint16_t from, uint16_t to) {
+    uint32_t total = 0;
+    for (uint16_t n = from; n < to; n++) total += sim_log[n].duration_ms;
+    return total;
+}
+
+static void test_traffic(void) {
+    sim_ms = 1000;
+    sim_count = 0;
+    sim_on_air_until = sim_last_end = 0;
+    tx_phase = IDLE_STATE;
+    tx_sched_init();
+    tx_sched_set_interval(MIN_TX_INTERVAL_MS);      // Asks for more than the limit allows
+    sgb_next_try = sim_ms;
+
+    // Periodic slots + SGB
+    uint32_t end = sim_ms + SIM_PHASE_MS;
+    for (; sim_ms < end; sim_ms++) {
+        sim_tick();
+        sim_sgb();
+        sim_periodic();
+    }
+    uint16_t phase1 = sim_count;
+
+    // Virtual beacons (periodic path off) + SGB
+    for (uint8_t i = 0; i < VB_COUNT; i++) vb_due[i] = sim_ms;
+    end = sim_ms + SIM_PHASE_MS;
+    for (; sim_ms < end; sim_ms++) {
+        sim_tick();
+        sim_sgb();
+        sim_vbeacons();
+    }
+
+    uint32_t max1 = max_window_airtime(0, phase1);
+    uint32_t max2 = max_window_airtime(0, sim_count);             // Across the switch too
+    uint32_t avg1 = total_airtime(0, phase1) * 1000 / SIM_PHASE_MS;
+    uint32_t avg2 = total_airtime(phase1, sim_count) * 1000 / SIM_PHASE_MS;
+
+    printf("periodic + SGB: %lu slots, %lu SGB (%lu held), worst window %lu ms, average %lu permil\n",
+           (unsigned long)periodic_sent, (unsigned long)sgb_sent, (unsigned long)sgb_held,
+           (unsigned long)max1, (unsigned long)avg1);
+    printf("virtual beacons + SGB: %lu bursts (%lu held), worst window %lu ms, average %lu permil\n",
+           (unsigned long)vb_sent, (unsigned long)vb_held, (unsigned long)max2, (unsigned long)avg2);
+    printf("limit %lu ms per %lu s window\n", (unsigned long)TX_SCHED_DUTY_LIMIT_MS,
+           (unsigned long)(TX_SCHED_DUTY_WINDOW_MS / 1000));
+
+    CHECK(sim_count < LOG_MAX);
+    CHECK(max1 <= TX_SCHED_DUTY_LIMIT_MS);
+    CHECK(max2 <= TX_SCHED_DUTY_LIMIT_MS);
+    CHECK(sgb_held > 0 && vb_held > 0);             // The demand was over the limit
+    CHECK(avg1 >= MAX_DUTY_CYCLE_PERMIL * 8 / 10);  // Still close to it: not over-conservative
+    CHECK(avg2 >= MAX_DUTY_CYCLE_PERMIL * 8 / 10);
+    CHECK(tx_sched_airtime_ms(sim_ms) <= TX_SCHED_DUTY_LIMIT_MS);
+}
+
+int main(void) {
+    test_fit();
+    test_burst_after_prepare();
+    test_short_slots();
+    test_traffic();
+    TEST_DONE();
+}
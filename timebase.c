@@ -0,0 +1,140 @@
+// timebase.c - 64-bit Microsecond Timebase (SCCP3 free-running timer)
+//
+// Time = anchor + (timer - anchor_lo) * 1e6 / FCY. The anchor is moved by the
+// wrap interrupt (once per 2^32 cycles) and by timebase_set_fcy() when the PPS
+// measures the real FCY, so the elapsed cycles stay below 2^33 and the product
+// fits in 64 bits. Anchor updates are committed with interrupts disabled and
+// bump tb_epoch; readers never mask interrupts, they retry on an epoch change.
+
+#include "includes.h"
+#include "timebase.h"
+
+static volatile uint64_t tb_anchor_us = 0;      // Time at tb_anchor_lo
+static volatile uint32_t tb_anchor_lo = 0;      // Timer value of the anchor (current wrap)
+static volatile uint32_t tb_anchor_rem = 0;     // Sub-microsecond rest, 1/tb_fcy_hz us
+static volatile uint32_t tb_fcy_hz = FCY;
+static volatile uint16_t tb_epoch = 0;
+
+void timebase_init(void) {
+    CCP3CON1L = 0;
+    CCP3CON1H = 0;
+    CCP3CON2L = 0;
+    CCP3CON2H = 0;
+    CCP3CON1Lbits.CLKSEL = 0;       // FOSC/2 = FCY
+    CCP3CON1Lbits.TMRPS = 0;
+    CCP3CON1Lbits.T32 = 1;
+    CCP3CON1Lbits.CCSEL = 0;        // Timer mode
+    CCP3CON1Lbits.MOD = 0b0000;
+    CCP3TMRL = 0;
+    CCP3TMRH = 0;
+    CCP3PRL = 0xFFFF;
+    CCP3PRH = 0xFFFF;
+
+    _CCT3IP = TIMEBASE_IRQ_PRIO;
+    _CCT3IF = 0;
+    _CCT3IE = 1;
+    CCP3CON1Lbits.CCPON = 1;
+}
+
+// 32-bit timer from two 16-bit halves: re-read the low half if the high half
+// moved (carry between the reads, at most once per 65536 cycles)
+static uint32_t tb_read_timer(void) {
+    uint16_t hi = CCP3TMRH;
+    uint16_t lo = CCP3TMRL;
+    uint16_t hi2 = CCP3TMRH;
+
+    if (hi2 != hi) lo = CCP3TMRL;
+    return ((uint32_t)hi2 << 16) | lo;
+}
+
+// Microseconds in 'cycles' FCY cycles (< 2^33) plus the rest, new rest out
+static uint64_t tb_scale(uint64_t cycles, uint32_t rem, uint32_t fcy_hz, uint32_t *rem_out) {
+    uint64_t n = cycles * TIMEBASE_US_PER_S + rem;
+    uint64_t us = n / fcy_hz;
+
+    *rem_out = (uint32_t)(n - us * fcy_hz);
+    return us;
+}
+
+// =============================
+// SCCP3 Timer Interrupt (32-bit wrap)
+// =============================
+void __attribute__((interrupt, auto_psv)) _CCT3Interrupt(void) {
+    uint32_t rem;
+    uint64_t us = tb_anchor_us + tb_scale(0x100000000ULL - tb_anchor_lo, tb_anchor_rem, tb_fcy_hz, &rem);
+
+    // Flag cleared with the new anchor: readers see old anchor + pending wrap,
+    // or new anchor + no wrap
+    __builtin_disable_interrupts();
+    tb_anchor_us = us;
+    tb_anchor_lo = 0;
+    tb_anchor_rem = rem;
+    tb_epoch++;
+    _CCT3IF = 0;
+    __builtin_enable_interrupts();
+}
+
+// =============================
+// Time Reading
+// =============================
+// Any context, interrupts enabled or not (a wrap may stay pending up to 43 s)
+uint64_t now_us(void) {
+    uint16_t epoch;
+    uint64_t anchor_us, cycles;
+    uint32_t anchor_lo, anchor_rem, fcy_hz, lo, rem;
+    uint8_t wrapped;
+
+    do {
+        epoch = tb_epoch;
+        anchor_us = tb_anchor_us;
+        anchor_lo = tb_anchor_lo;
+        anchor_rem = tb_anchor_rem;
+        fcy_hz = tb_fcy_hz;
+        lo = tb_read_timer();
+        wrapped = _CCT3IF;
+    } while (epoch != tb_epoch);
+
+    // Pending wrap: a small timer value is already past it, a large one
+    // was read just before it
+    cycles = (uint64_t)lo - anchor_lo;
+    if (wrapped && lo < 0x80000000UL) cycles += 0x100000000ULL;
+    return anchor_us + tb_scale(cycles, anchor_rem, fcy_hz, &rem);
+}
+
+// Wraps after 49.7 days, compare with (now - then)
+uint32_t now_ms(void) {
+    return (uint32_t)(now_us() / 1000UL);
+}
+
+// Measured FCY (PPS): the anchor moves to the present with the old rate, the
+// new rate applies from there, so the time stays continuous and monotonic.
+// Main loop only (waits for a pending wrap to be handled).
+void timebase_set_fcy(uint32_t fcy_hz) {
+    if (fcy_hz == tb_fcy_hz) return;
+
+    for (;;) {
+        uint16_t epoch = tb_epoch;
+        uint32_t lo = tb_read_timer();
+        uint32_t rem;
+
+        if (_CCT3IF) continue;
+        uint64_t us = tb_anchor_us + tb_scale((uint64_t)lo - tb_anchor_lo, tb_anchor_rem, tb_fcy_hz, &rem);
+        rem = (uint32_t)((uint64_t)rem * fcy_hz / tb_fcy_hz);
+
+        __builtin_disable_interrupts();
+        if (epoch == tb_epoch && !_CCT3IF) {
+            tb_anchor_us = us;
+            tb_anchor_lo = lo;
+            tb_anchor_rem = rem;
+            tb_fcy_hz = fcy_hz;
+            tb_epoch++;
+            __builtin_enable_interrupts();
+            return;
+        }
+        __builtin_enable_interrupts();
+    }
+}
+
+uint32_t timebase_get_fcy(void) {
+    return tb_fcy_hz;
+}
@@ -0,0 +1,22 @@
+// timebase.h - 64-bit Microsecond Timebase (SCCP3 free-running timer)
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+// Hardware: SCCP3 32-bit timer on FCY, period 0xFFFFFFFF (wraps every 85.9 s
+// at 50 MHz). The wrap interrupt moves the microsecond anchor forward; readers
+// add a wrap that is still pending, so the time is right at any priority,
+// with interrupts disabled, and independent of Timer1 and the modulator.
+#define TIMEBASE_IRQ_PRIO       1           // Wrap only, latency up to 43 s tolerated
+#define TIMEBASE_US_PER_S       1000000UL
+
+// Function prototypes
+void timebase_init(void);
+uint64_t now_us(void);
+uint32_t now_ms(void);
+void timebase_set_fcy(uint32_t fcy_hz);
+uint32_t timebase_get_fcy(void);
+
+#endif /* TIMEBASE_H */
@@ -0,0 +1,246 @@
+// tx_scheduler.c - Randomized Repetition Scheduler and Airtime Accountant
+//
+// Each slot (carrier start instant) is drawn when the previous one fires:
+// previous slot + nominal period +/- TX_SCHED_JITTER_PERMIL (xorshift32), so
+// start latency does not accumulate. The main loop polls: TX_SCHED_PREPARE
+// comes TX_SCHED_PREPARE_MS ahead (channel, frame build and validation),
+// TX_SCHED_FIRE comes TX_SCHED_RF_START_MS ahead (RF warm-up), the carrier
+// then starts on the first Timer1 sample of the slot. A slot that would put
+// more than MAX_DUTY_CYCLE_PERMIL of any TX_SCHED_DUTY_WINDOW_MS window on
+// air (with the burst of the configured protocol, long or short) is moved
+// to the first instant that fits, computed from the recorded bursts. Bursts
+// outside the slots (virtual beacons, SGB) ask tx_sched_can_fire() first
+// and wait while it says no.
+
+#include "includes.h"
+#include "tx_scheduler.h"
+#include "system_definitions.h"
+#include "system_comms.h"
+#include "system_debug.h"
+#include "config_store.h"
+#include "protocol_layout.h"
+
+typedef struct {
+    uint32_t start_ms;
+    uint16_t duration_ms;
+} tx_burst_record_t;
+
+// Burst records, chronological ring
+static tx_burst_record_t sched_bursts[TX_SCHED_BURST_RECORDS];
+static uint8_t sched_burst_next = 0;
+static uint8_t sched_burst_count = 0;
+
+static uint32_t sched_rng = 1;
+static uint32_t sched_interval_ms = MIN_TX_INTERVAL_MS;    // Nominal period
+static uint32_t sched_due_ms = 0;                           // Next slot (carrier start)
+static uint32_t sched_slot_ms = 0;                          // Slot of the last TX_SCHED_FIRE
+static uint32_t sched_period_ms = 0;                        // Last drawn period
+static uint8_t sched_prepared = 0;
+static uint16_t sched_fired = 0;
+static uint16_t sched_deferred = 0;                         // Slots moved by the duty limit
+static uint16_t sched_gated = 0;                            // Other bursts held by the duty limit
+static uint8_t sched_gate_closed = 0;
+
+static uint32_t sched_random(void) {
+    sched_rng ^= sched_rng << 13;
+    sched_rng ^= sched_rng >> 17;
+    sched_rng ^= sched_rng << 5;
+    return sched_rng;
+}
+
+void tx_sched_init(void) {
+    // Beacon ID: different sequences for beacons running the same firmware.
+    // Timing noise is mixed in again at every prepare.
+    sched_rng = (uint32_t)now_us() ^ (config_get()->beacon_id * 2654435761UL);
+    if (sched_rng == 0) sched_rng = 0x2545F491UL;
+
+    sched_burst_next = 0;
+    sched_burst_count = 0;
+    sched_prepared = 0;
+    sched_due_ms = now_ms() + TX_SCHED_PREPARE_MS;          // First burst right after boot
+}
+
+void tx_sched_set_interval(uint32_t interval_ms) {
+    sched_interval_ms = interval_ms;
+}
+
+uint32_t tx_sched_next_ms(void) {
+    return sched_due_ms;
+}
+
+// Carrier start instant for the burst just fired (start_transmission arms it)
+uint32_t tx_sched_slot_ms(void) {
+    return sched_slot_ms;
+}
+
+// Burst of the slot frame: prepare_beacon_frame() builds it with the
+// configured protocol
+static uint16_t sched_burst_ms(void) {
+    return (uint16_t)FRAME_BURST_DURATION_MS(PROTOCOL_FRAME_BITS(config_get()->protocol_code));
+}
+
+// Uniform in [nominal - jitter, nominal + jitter]. A nominal period below the
+// T.001 minimum or the duty-cycle pace moves the whole range up, so the
+// period stays random (clamping would repeat the floor value).
+static uint32_t sched_draw_period(void) {
+    uint32_t pace_ms = TX_SCHED_MIN_PERIOD_FOR(sched_burst_ms());
+    uint32_t floor_ms = MIN_TX_INTERVAL_MS > pace_ms ? MIN_TX_INTERVAL_MS : pace_ms;
+    uint32_t jitter = sched_interval_ms * TX_SCHED_JITTER_PERMIL / 1000;
+    uint32_t low = sched_interval_ms - jitter;
+
+    if (low < floor_ms) {
+        jitter = floor_ms * TX_SCHED_JITTER_PERMIL / 1000;
+        low = floor_ms;
+    }
+    return low + sched_random() % (2 * jitter + 1);
+}
+
+// =============================
+// Airtime Accountant
+// =============================
+// Main loop only (start_transmission, SGB start)
+void tx_sched_account(uint32_t start_ms, uint16_t duration_ms) {
+    sched_bursts[sched_burst_next].start_ms = start_ms;
+    sched_bursts[sched_burst_next].duration_ms = duration_ms;
+    if (++sched_burst_next >= TX_SCHED_BURST_RECORDS) sched_burst_next = 0;
+    if (sched_burst_count < TX_SCHED_BURST_RECORDS) sched_burst_count++;
+}
+
+static uint8_t sched_oldest(void) {
+    return (uint8_t)((sched_burst_next + TX_SCHED_BURST_RECORDS - sched_burst_count) % TX_SCHED_BURST_RECORDS);
+}
+
+// Airtime in [now - window, now)
+uint32_t tx_sched_airtime_ms(uint32_t now_ms) {
+    uint32_t window_start = now_ms - TX_SCHED_DUTY_WINDOW_MS;
+    uint32_t total = 0;
+    uint8_t i = sched_oldest();
+
+    for (uint8_t n = 0; n < sched_burst_count; n++) {
+        int32_t from = (int32_t)(sched_bursts[i].start_ms - window_start);
+        int32_t to = from + sched_bursts[i].duration_ms;
+        if (from < 0) from = 0;
+        if (to > (int32_t)TX_SCHED_DUTY_WINDOW_MS) to = TX_SCHED_DUTY_WINDOW_MS;
+        if (to > from) total += (uint32_t)(to - from);
+        if (++i >= TX_SCHED_BURST_RECORDS) i = 0;
+    }
+    return total;
+}
+
+// Earliest start >= start_ms for a burst of duration_ms within the limit.
+// The window trailing edge is moved over the recorded bursts, oldest first,
+// until the airtime left behind it fits the budget.
+uint32_t tx_sched_fit_ms(uint32_t start_ms, uint16_t duration_ms) {
+    uint32_t budget = TX_SCHED_DUTY_LIMIT_MS - duration_ms;
+    uint32_t window_start = start_ms + duration_ms - TX_SCHED_DUTY_WINDOW_MS;
+    uint32_t after = 0;
+    uint8_t i = sched_oldest();
+
+    for (uint8_t n = 0; n < sched_burst_count; n++) {
+        int32_t from = (int32_t)(sched_bursts[(i + n) % TX_SCHED_BURST_RECORDS].start_ms - window_start);
+        int32_t to = from + sched_bursts[(i + n) % TX_SCHED_BURST_RECORDS].duration_ms;
+        if (to > 0) after += (uint32_t)(to - (from < 0 ? 0 : from));
+    }
+    if (after <= budget) return start_ms;
+
+    for (uint8_t n = 0; n < sched_burst_count; n++) {
+        int32_t from = (int32_t)(sched_bursts[(i + n) % TX_SCHED_BURST_RECORDS].start_ms - window_start);
+        int32_t to = from + sched_bursts[(i + n) % TX_SCHED_BURST_RECORDS].duration_ms;
+        if (to <= 0) continue;
+        if (from < 0) from = 0;
+        after -= (uint32_t)(to - from);
+        if (after <= budget) {
+            // Edge inside this burst: what is left of it completes the budget
+            return start_ms + (uint32_t)to - (budget - after);
+        }
+    }
+    return start_ms;
+}
+
+// Gate for bursts started outside tx_sched_poll(): 1 when a burst of
+// duration_ms starting now stays within the limit, otherwise the caller
+// holds it and asks again later (tx_sched_fit_ms() tells when)
+uint8_t tx_sched_can_fire(uint32_t now_ms, uint16_t duration_ms) {
+    if (tx_sched_fit_ms(now_ms, duration_ms) == now_ms) {
+        sched_gate_closed = 0;
+        return 1;
+    }
+    if (!sched_gate_closed) sched_gated++;     // Counted once per wait, not per poll
+    sched_gate_closed = 1;
+    return 0;
+}
+
+// =============================
+// Slot Scheduling
+// =============================
+uint8_t tx_sched_poll(uint32_t now_ms) {
+    int32_t to_slot = (int32_t)(sched_due_ms - now_ms);
+
+    // Slot missed by far (virtual beacons, long command): prepare a new one now
+    if (to_slot < -(int32_t)TX_SCHED_PREPARE_MS) {
+        sched_due_ms = now_ms + TX_SCHED_PREPARE_MS;
+        sched_prepared = 0;
+        return TX_SCHED_IDLE;
+    }
+
+    if (!sched_prepared) {
+        if (to_slot > TX_SCHED_PREPARE_MS) return TX_SCHED_IDLE;
+
+        // Checked at prepare time: other bursts may have been sent meanwhile
+        uint32_t due = tx_sched_fit_ms(sched_due_ms, sched_burst_ms());
+        if (due != sched_due_ms) {
+            sched_due_ms = due;
+            sched_deferred++;
+            if ((int32_t)(due - now_ms) > TX_SCHED_PREPARE_MS) return TX_SCHED_IDLE;
+        }
+        sched_rng ^= (uint32_t)now_us();
+        if (sched_rng == 0) sched_rng = 0x2545F491UL;
+        sched_prepared = 1;
+        return TX_SCHED_PREPARE;
+    }
+
+    if (to_slot > TX_SCHED_RF_START_MS) return TX_SCHED_IDLE;
+    if (tx_phase != IDLE_STATE) return TX_SCHED_IDLE;      // Another burst still on air
+
+    // A burst sent since the prepare (SGB command) used the budget: prepare again
+    if (tx_sched_fit_ms(sched_due_ms, sched_burst_ms()) != sched_due_ms) {
+        sched_prepared = 0;
+        return TX_SCHED_IDLE;
+    }
+
+    sched_prepared = 0;
+    sched_fired++;
+    sched_slot_ms = sched_due_ms;
+    sched_period_ms = sched_draw_period();
+    sched_due_ms += sched_period_ms;
+    return TX_SCHED_FIRE;
+}
+
+void tx_sched_print_status(void) {
+    uint32_t now = now_ms();
+    uint32_t airtime = tx_sched_airtime_ms(now);
+
+    DEBUG_LOG_FLUSH("SCHED: next in ");
+    debug_print_int32((int32_t)(sched_due_ms - now));
+    DEBUG_LOG_FLUSH(" ms, period ");
+    debug_print_uint32(sched_period_ms);
+    DEBUG_LOG_FLUSH(" ms (");
+    debug_print_uint32(sched_interval_ms);
+    DEBUG_LOG_FLUSH(" +/- ");
+    debug_print_uint16(TX_SCHED_JITTER_PERMIL);
+    DEBUG_LOG_FLUSH(" permil), airtime ");
+    debug_print_uint32(airtime);
+    DEBUG_LOG_FLUSH(" ms/");
+    debug_print_uint32(TX_SCHED_DUTY_WINDOW_MS / 1000);
+    DEBUG_LOG_FLUSH(" s (");
+    debug_print_uint16((uint16_t)(airtime * 1000 / TX_SCHED_DUTY_WINDOW_MS));
+    DEBUG_LOG_FLUSH(" permil, limit ");
+    debug_print_uint16(MAX_DUTY_CYCLE_PERMIL);
+    DEBUG_LOG_FLUSH("), fired ");
+    debug_print_uint16(sched_fired);
+    DEBUG_LOG_FLUSH(", deferred ");
+    debug_print_uint16(sched_deferred);
+    DEBUG_LOG_FLUSH(", gated ");
+    debug_print_uint16(sched_gated);
+    DEBUG_LOG_FLUSH("\r\n");
+}
@@ -0,0 +1,45 @@
+// tx_scheduler.h - Randomized Repetition Scheduler and Airtime Accountant
+
+#ifndef TX_SCHEDULER_H
+#define TX_SCHEDULER_H
+
+#include <stdint.h>
+
+// T.001: the repetition period is randomized around the nominal value so that
+// two beacons never stay synchronized (50 s +/- 2.5 s operational, +/- 5 %)
+#define TX_SCHED_JITTER_PERMIL  50          // Period = nominal +/- 5 %
+#define TX_SCHED_PREPARE_MS     100         // Frame build and channel set ahead of the slot
+#define TX_SCHED_RF_START_MS    40          // start_transmission(): RF warm-up before the armed carrier sample
+
+// Sliding-window airtime accountant (every burst, any source)
+#define TX_SCHED_DUTY_WINDOW_MS 60000UL
+#define TX_SCHED_DUTY_LIMIT_MS  (TX_SCHED_DUTY_WINDOW_MS * MAX_DUTY_CYCLE_PERMIL / 1000)
+#define TX_SCHED_BURST_RECORDS  32          // Bursts remembered (oldest dropped when full)
+
+// Shortest period at which bursts of burst_ms alone never exceed the limit in
+// any window: n = limit / burst whole bursts, n periods cover the window minus
+// the rest of the limit (long 9.92 s, short 7.49 s; the 6 % average alone
+// would give 8.67 s and 7.33 s)
+#define TX_SCHED_MIN_PERIOD_FOR(burst_ms) ((TX_SCHED_DUTY_WINDOW_MS - TX_SCHED_DUTY_LIMIT_MS % (burst_ms)) / \
+                                           (TX_SCHED_DUTY_LIMIT_MS / (burst_ms)))
+#define TX_SCHED_MIN_PERIOD_MS  TX_SCHED_MIN_PERIOD_FOR(TOTAL_BURST_DURATION_MS)
+
+typedef enum {
+    TX_SCHED_IDLE = 0,          // Nothing to do yet
+    TX_SCHED_PREPARE,           // Build the frame now, the slot is TX_SCHED_PREPARE_MS away
+    TX_SCHED_FIRE               // Start the burst now (carrier at the slot instant)
+} tx_sched_event_t;
+
+// Function prototypes
+void tx_sched_init(void);
+uint8_t tx_sched_poll(uint32_t now_ms);
+void tx_sched_set_interval(uint32_t interval_ms);
+uint32_t tx_sched_next_ms(void);
+uint32_t tx_sched_slot_ms(void);
+void tx_sched_account(uint32_t start_ms, uint16_t duration_ms);
+uint32_t tx_sched_fit_ms(uint32_t start_ms, uint16_t duration_ms);
+uint8_t tx_sched_can_fire(uint32_t now_ms, uint16_t duration_ms);
+uint32_t tx_sched_airtime_ms(uint32_t now_ms);
+void tx_sched_print_status(void);
+
+#endif /* TX_SCHEDULER_H */
@@ -0,0 +1,223 @@
+// vbeacon.c - Virtual Beacon Table and Round-Robin Frame Scheduler
+//
+// One board emulates up to VBEACON_MAX beacons for receiver load tests.
+// Every entry keeps a precomputed frame; the scheduler only copies a cached
+// frame into beacon_frame[] and starts the burst. Entries are visited in
+// round-robin order: a beacon is sent when its own period has elapsed and
+// the channel has been idle for VBEACON_MIN_GAP_MS since the last burst.
+// Periods are clamped to VBEACON_MIN_INTERVAL_FOR(frame bits) so each virtual
+// beacon stays within the duty limit on its own; short (112-bit) messages
+// have a shorter burst and so a shorter minimum period and channel gap.
+// Together they can ask for more: a due beacon also waits until the burst
+// fits the transmitter duty limit (tx_sched_can_fire()).
+
+#include "includes.h"
+#include "vbeacon.h"
+#include "system_definitions.h"
+#include "system_comms.h"
+#include "system_debug.h"
+#include "protocol_data.h"
+#include "rf_interface.h"
+#include "config_store.h"
+#include "protocol_layout.h"
+#include "tx_scheduler.h"
+
+static vbeacon_identity_t vbeacon_table[VBEACON_MAX];
+static uint8_t vbeacon_frames[VBEACON_MAX][MESSAGE_BITS];
+static uint8_t vbeacon_stale[VBEACON_MAX];      // Cached frame must be rebuilt
+static uint32_t vbeacon_due_ms[VBEACON_MAX];    // Next transmission time
+static uint32_t vbeacon_tx_count[VBEACON_MAX];
+static uint8_t vbeacon_next = 0;                // Round-robin cursor
+static uint8_t vbeacon_running = 0;
+
+static void vbeacon_build(uint8_t index) {
+    const vbeacon_identity_t *vb = &vbeacon_table[index];
+    beacon_frame_params_t params;
+
+    params.beacon_id = vb->beacon_id;
+    params.country_code = vb->country_code;
+    params.protocol_code = vb->protocol_code;
+    params.mode = vb->mode;
+
+    if (vb->pos_source == VBEACON_POS_GPS) {
+        frame_params_from_gps(&params);
+    } else {
+        params.lat_e7 = vb->lat_udeg * 10;
+        params.lon_e7 = vb->lon_udeg * 10;
+        params.alt_m = vb->alt_m;
+    }
+
+    build_frame_from_params(&params, vbeacon_frames[index]);
+    vbeacon_stale[index] = 0;
+}
+
+void vbeacon_init(void) {
+    vbeacon_clear();
+}
+
+// Install an identity; the frame is rebuilt before its next transmission
+uint8_t vbeacon_set(uint8_t index, const vbeacon_identity_t *identity) {
+    if (index >= VBEACON_MAX || !identity) return 0;
+    if (identity->beacon_id > 0xFFFFFFUL || identity->country_code > 0x3FF) return 0;
+    if (!protocol_layout_find(identity->protocol_code) || identity->pos_source > VBEACON_POS_FIXED) return 0;
+
+    uint32_t min_interval = VBEACON_MIN_INTERVAL_FOR(PROTOCOL_FRAME_BITS(identity->protocol_code));
+    vbeacon_table[index] = *identity;
+    if (vbeacon_table[index].interval_ms < min_interval) {
+        vbeacon_table[index].interval_ms = min_interval;
+    }
+    vbeacon_stale[index] = 1;
+    vbeacon_due_ms[index] = now_ms();
+    vbeacon_tx_count[index] = 0;
+    return 1;
+}
+
+const vbeacon_identity_t* vbeacon_get(uint8_t index) {
+    if (index >= VBEACON_MAX) return 0;
+    return &vbeacon_table[index];
+}
+
+void vbeacon_remove(uint8_t index) {
+    if (index < VBEACON_MAX) {
+        vbeacon_table[index].enabled = 0;
+    }
+}
+
+void vbeacon_clear(void) {
+    memset(vbeacon_table, 0, sizeof(vbeacon_table));
+    memset(vbeacon_stale, 0, sizeof(vbeacon_stale));
+    vbeacon_next = 0;
+}
+
+// Fill the table with 'count' beacons derived from the stored configuration:
+// consecutive IDs, fixed positions stepped north-east of the TEST position
+uint8_t vbeacon_generate(uint8_t count, uint32_t interval_ms, uint8_t mode) {
+    const beacon_config_t *cfg = config_get();
+    vbeacon_identity_t vb;
+
+    if (count == 0 || count > VBEACON_MAX) return 0;
+    vbeacon_clear();
+
+    for (uint8_t i = 0; i < count; i++) {
+        vb.beacon_id = (cfg->beacon_id + i) & 0xFFFFFFUL;
+        vb.interval_ms = interval_ms;
+        vb.lat_udeg = cfg->test_lat_udeg + (int32_t)i * VBEACON_FIXED_STEP_UDEG;
+        vb.lon_udeg = cfg->test_lon_udeg + (int32_t)i * VBEACON_FIXED_STEP_UDEG;
+        vb.alt_m = cfg->test_alt_m;
+        vb.country_code = cfg->country_code;
+        vb.protocol_code = cfg->protocol_code;
+        vb.pos_source = VBEACON_POS_FIXED;
+        vb.mode = mode;
+        vb.enabled = 1;
+        vbeacon_set(i, &vb);
+    }
+    return count;
+}
+
+// New GPS data: frames that carry the live position are rebuilt lazily
+void vbeacon_gps_updated(void) {
+    for (uint8_t i = 0; i < VBEACON_MAX; i++) {
+        if (vbeacon_table[i].enabled && vbeacon_table[i].pos_source == VBEACON_POS_GPS) {
+            vbeacon_stale[i] = 1;
+        }
+    }
+}
+
+// =============================
+// Scheduler
+// =============================
+void vbeacon_start(void) {
+    uint32_t now = now_ms();
+    for (uint8_t i = 0; i < VBEACON_MAX; i++) {
+        vbeacon_due_ms[i] = now;
+    }
+    vbeacon_next = 0;
+    vbeacon_running = 1;
+}
+
+void vbeacon_stop(void) {
+    vbeacon_running = 0;
+}
+
+uint8_t vbeacon_is_running(void) {
+    return vbeacon_running;
+}
+
+// Main loop hook. Rebuilds at most one stale frame per call, then starts the
+// next due beacon if the channel is free. Returns 1 when a burst was started.
+uint8_t vbeacon_poll(void) {
+    if (!vbeacon_running) return 0;
+
+    for (uint8_t i = 0; i < VBEACON_MAX; i++) {
+        if (vbeacon_table[i].enabled && vbeacon_stale[i]) {
+            vbeacon_build(i);
+            break;
+        }
+    }
+
+    uint8_t phase, last_bits;
+    uint32_t now, last_tx;
+    __builtin_disable_interrupts();
+    phase = tx_phase;
+    last_tx = last_tx_time;
+    last_bits = beacon_frame_bits;
+    __builtin_enable_interrupts();
+    now = now_ms();
+
+    // Gap counted from the end of the previous burst (long or short)
+    if (phase != IDLE_STATE) return 0;
+    if ((now - last_tx) < (FRAME_BURST_DURATION_MS(last_bits) + VBEACON_MIN_GAP_MS)) return 0;
+
+    for (uint8_t n = 0; n < VBEACON_MAX; n++) {
+        uint8_t i = (vbeacon_next + n) % VBEACON_MAX;
+        const vbeacon_identity_t *vb = &vbeacon_table[i];
+
+        if (!vb->enabled || vbeacon_stale[i]) continue;
+        if ((int32_t)(now - vbeacon_due_ms[i]) < 0) continue;
+
+        // Whole table over the duty limit: this one waits, the order is kept
+        if (!tx_sched_can_fire(now, FRAME_BURST_DURATION_MS(FRAME_BITS(vbeacon_frames[i])))) return 0;
+
+        // CRITICAL SECTION: beacon_frame[] is read by the Timer1 ISR
+        __builtin_disable_interrupts();
+        memcpy((void*)beacon_frame, vbeacon_frames[i], MESSAGE_BITS);
+        __builtin_enable_interrupts();
+
+        beacon_mode = vb->mode;
+        rf_set_power_level(vb->mode == BEACON_MODE_TEST ? RF_POWER_LOW : config_get()->exercise_power);
+        transmit_beacon_frame(TX_START_ASAP);
+
+        vbeacon_due_ms[i] = now + vb->interval_ms;
+        vbeacon_tx_count[i]++;
+        vbeacon_next = (i + 1) % VBEACON_MAX;
+        return 1;
+    }
+    return 0;
+}
+
+void vbeacon_print(void) {
+    DEBUG_LOG_FLUSH("Virtual beacons (");
+    DEBUG_LOG_FLUSH(vbeacon_running ? "running" : "stopped");
+    DEBUG_LOG_FLUSH("):\r\n");
+
+    for (uint8_t i = 0; i < VBEACON_MAX; i++) {
+        const vbeacon_identity_t *vb = &vbeacon_table[i];
+        if (!vb->enabled) continue;
+
+        DEBUG_LOG_FLUSH("  ");
+        debug_print_uint16(i);
+        DEBUG_LOG_FLUSH(": ID 0x");
+        debug_print_hex24(vb->beacon_id);
+        DEBUG_LOG_FLUSH(" MID ");
+        debug_print_uint16(vb->country_code);
+        DEBUG_LOG_FLUSH(" ");
+        DEBUG_LOG_FLUSH(protocol_layout_find(vb->protocol_code)->name);
+        if (PROTOCOL_IS_SHORT(vb->protocol_code)) DEBUG_LOG_FLUSH(" short");
+        DEBUG_LOG_FLUSH(vb->mode == BEACON_MODE_TEST ? " TEST " : " EXER ");
+        DEBUG_LOG_FLUSH(vb->pos_source == VBEACON_POS_GPS ? "GPS " : "FIX ");
+        debug_print_uint32(vb->interval_ms);
+        DEBUG_LOG_FLUSH(" ms, sent ");
+        debug_print_uint32(vbeacon_tx_count[i]);
+        DEBUG_LOG_FLUSH("\r\n");
+    }
+}
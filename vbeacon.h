@@ -0,0 +1,52 @@
+// vbeacon.h - Virtual Beacon Table and Round-Robin Frame Scheduler (load testing)
+
+#ifndef VBEACON_H
+#define VBEACON_H
+
+#include <stdint.h>
+
+#define VBEACON_MAX             8       // Virtual beacons (one cached frame each)
+#define VBEACON_MIN_GAP_MS      1000    // Channel idle time between two bursts
+#define VBEACON_FIXED_STEP_UDEG 10000   // VB GEN spacing of fixed positions (0.01 deg)
+
+// Shortest per-beacon period that keeps each one within the duty limit in
+// every window, as the periodic slots (tx_scheduler.h; long message, short
+// messages use their 440 ms burst)
+#define VBEACON_MIN_INTERVAL_MS TX_SCHED_MIN_PERIOD_MS
+#define VBEACON_MIN_INTERVAL_FOR(bits) TX_SCHED_MIN_PERIOD_FOR(FRAME_BURST_DURATION_MS(bits))
+
+typedef enum {
+    VBEACON_POS_GPS = 0,        // Current GPS position, refreshed on each fix
+    VBEACON_POS_FIXED           // lat/lon/alt of the entry
+} vbeacon_pos_source_t;
+
+typedef struct {
+    uint32_t beacon_id;         // 24-bit beacon identification
+    uint32_t interval_ms;       // Repetition period of this beacon
+    int32_t lat_udeg;           // Fixed position (micro-degrees)
+    int32_t lon_udeg;
+    int16_t alt_m;
+    uint16_t country_code;      // 10-bit MID
+    uint8_t protocol_code;      // Protocol code (protocol_layout.h)
+    uint8_t pos_source;         // vbeacon_pos_source_t
+    uint8_t mode;               // BEACON_MODE_TEST / BEACON_MODE_EXERCISE
+    uint8_t enabled;
+} vbeacon_identity_t;
+
+// Function prototypes
+void vbeacon_init(void);
+uint8_t vbeacon_set(uint8_t index, const vbeacon_identity_t *identity);
+const vbeacon_identity_t* vbeacon_get(uint8_t index);
+void vbeacon_remove(uint8_t index);
+void vbeacon_clear(void);
+uint8_t vbeacon_generate(uint8_t count, uint32_t interval_ms, uint8_t mode);
+void vbeacon_gps_updated(void);
+
+// Scheduler (main loop)
+void vbeacon_start(void);
+void vbeacon_stop(void);
+uint8_t vbeacon_is_running(void);
+uint8_t vbeacon_poll(void);
+void vbeacon_print(void);
+
+#endif /* VBEACON_H */